@@ -0,0 +1,346 @@
+#include "app.h"
+#include <cstring>
+#include <cstdio>
+#include "hsm.h"
+#include "auto_repeat.h"
+#include "civil_time.h"
+#include "event_task.h"
+
+// Hold-to-repeat for increment/decrement in SET_TIME: {hold time ms, repeat period ms} per stage
+const RepeatStage EDIT_REPEAT_CURVE[] = {{500, 200}, {2000, 100}, {4000, 40}};
+
+AppState state = IDLE;
+
+// Global variables for time setting
+char editBuffer[TIME_STR_SIZE] = {0};            // Buffer holding the time string for editing (format: "YYYY/MM/DD HH:MM:SS")
+int currentEditPos = 0;                         // Current index position in editBuffer that is being edited
+
+// Held increment/decrement button in SET_TIME; repeats are counted from the press and release timestamps
+AutoRepeat editRepeat(EDIT_REPEAT_CURVE, sizeof(EDIT_REPEAT_CURVE) / sizeof(EDIT_REPEAT_CURVE[0]));
+InputSource editRepeatSource = INPUT_INCREMENT_BUTTON;
+
+InputTrace *appTrace = nullptr;
+uint64_t appTraceMono = 0;     // Time of the input or event being handled, stamped on what it causes
+
+void enterTimeEdit();              // Actions of the application state machine
+void beginTimeEdit();
+void nextEditPosition();
+bool atLastEditPosition();
+void commitTimeEdit();
+void incrementEditedField();
+void decrementEditedField();
+void onAppTransition(int from, int to); // State machine hook: track the leaf state and record it
+void startEditRepeat(InputSource source, uint64_t mono); // Increment/decrement pressed in SET_TIME: start repeating
+void stopEditRepeat(uint64_t mono); // Apply the repeats due up to "mono" and stop
+
+#if defined(__cpp_impl_coroutine)
+EventSignal<InputEvent> editPresses;  // Button presses for the SET_TIME flow while it waits for one
+EventTask timeEditFlow();
+#endif
+
+// Application modes. Entering a state draws its screen, and every button action is a row below.
+// The lookup is resolved at compile time, so a press costs one table index whatever the number of screens.
+constexpr HsmState APP_STATES[APP_STATE_COUNT] = {
+    {APP_TOP, &updateDisplay, nullptr},        // IDLE
+    {APP_TOP, &storeCurrentTime, nullptr},     // LOG_TIME
+    {APP_PAGES, &displayLogs, nullptr},        // DISPLAY_LOG
+    {APP_TOP, &enterTimeEdit, nullptr},        // SET_TIME
+    {APP_PAGES, &displaySyncStats, nullptr},   // SYNC_STATS
+    {HSM_NONE, nullptr, nullptr},              // APP_TOP
+    {APP_TOP, nullptr, nullptr},               // APP_PAGES
+};
+constexpr HsmTransition APP_TRANSITIONS[] = {
+    // from         event                 guard                  to           action
+    {IDLE,          APP_EV_LOG,           nullptr,               LOG_TIME,    nullptr},
+    {IDLE,          APP_EV_REPLAY,        nullptr,               DISPLAY_LOG, nullptr},
+    {IDLE,          APP_EV_SET,           nullptr,               SET_TIME,    nullptr},
+    {IDLE,          APP_EV_DISPLAY_SLEEP, nullptr,               HSM_NONE,    nullptr},
+    {LOG_TIME,      APP_EV_COMPLETE,      nullptr,               IDLE,        nullptr},
+    {DISPLAY_LOG,   APP_EV_REPLAY,        &syncStatsPageEnabled, SYNC_STATS,  nullptr},
+    {APP_PAGES,     APP_EV_REPLAY,        nullptr,               IDLE,        nullptr},
+    {SET_TIME,      APP_EV_INCREMENT,     nullptr,               HSM_NONE,    &incrementEditedField},
+    {SET_TIME,      APP_EV_REPLAY,        nullptr,               HSM_NONE,    &decrementEditedField},
+    {SET_TIME,      APP_EV_SET,           &atLastEditPosition,   IDLE,        &commitTimeEdit},
+    {SET_TIME,      APP_EV_SET,           nullptr,               HSM_NONE,    &nextEditPosition},
+    {SET_TIME,      APP_EV_EDIT_DONE,     nullptr,               IDLE,        nullptr},
+    {SET_TIME,      APP_EV_DISPLAY_SLEEP, nullptr,               HSM_NONE,    nullptr},   // Keep an edit in progress
+    {APP_TOP,       APP_EV_DISPLAY_SLEEP, nullptr,               IDLE,        nullptr},
+};
+constexpr int APP_TRANSITION_COUNT = sizeof(APP_TRANSITIONS) / sizeof(APP_TRANSITIONS[0]);
+constexpr HsmLookup<APP_STATE_COUNT, APP_EVENT_COUNT> APP_LOOKUP = hsmBuildLookup<APP_EVENT_COUNT>(APP_STATES, APP_TRANSITIONS);
+Hsm<APP_STATE_COUNT, APP_EVENT_COUNT, APP_TRANSITION_COUNT> appMachine(APP_STATES, APP_TRANSITIONS, APP_LOOKUP, APP_EV_COMPLETE, &onAppTransition);
+const AppEvent APP_EVENT_FOR_INPUT[INPUT_SOURCE_COUNT] = {APP_EV_LOG, APP_EV_REPLAY, APP_EV_SET, APP_EV_INCREMENT};
+
+void appSetTrace(InputTrace *t) {
+    appTrace = t;
+}
+
+void appStart(uint64_t mono) {
+    appTraceMono = mono;
+    if (editRepeat.active()) {
+        editRepeat.release(mono);
+        cancelEditRepeat();
+    }
+    appMachine.start(IDLE);
+}
+
+void appDispatch(AppEvent event, uint64_t mono) {
+    appTraceMono = mono;
+    if (appTrace) appTrace->record(TRACE_EVENT, mono, (uint8_t)event);
+    appMachine.dispatch(event);
+}
+
+void appHandleInput(const InputEvent &event) {
+    appTraceMono = event.mono;
+    if (appTrace) appTrace->record(TRACE_INPUT, event.mono, event.source, event.edge);
+    // Any other edge ends a repeat at that edge's time; a release of the held button is otherwise ignored
+    if (editRepeat.active() && (event.source == editRepeatSource || event.edge == INPUT_PRESSED)) {
+        stopEditRepeat(event.mono);
+    }
+    if (event.edge != INPUT_PRESSED) return;
+    bool taken = false;
+#if defined(__cpp_impl_coroutine)
+    // While the SET_TIME flow runs it takes the presses; the SET_TIME rows only serve when it could not start
+    taken = state == SET_TIME && editPresses.post(event);
+#endif
+    if (!taken && event.source < INPUT_SOURCE_COUNT) appMachine.dispatch(APP_EVENT_FOR_INPUT[event.source]);
+    if (state == SET_TIME && (event.source == INPUT_INCREMENT_BUTTON || event.source == INPUT_REPLAY_BUTTON)) {
+        startEditRepeat(event.source, event.mono);
+    }
+}
+
+void startEditRepeat(InputSource source, uint64_t mono) {
+    editRepeatSource = source;
+    editRepeat.press(mono);
+    armEditRepeat(editRepeat.nextDue());
+}
+
+void stopEditRepeat(uint64_t mono) {
+    uint32_t steps = editRepeat.release(mono);
+    cancelEditRepeat();
+    if (steps > 0 && state == SET_TIME) {
+        adjustEditedField(editRepeatSource == INPUT_INCREMENT_BUTTON ? 1 : -1, steps);
+    }
+}
+
+// The platform handles queued edges first, so a release that happened before now stops the count
+// at its own time. However late this runs, it applies every step that fell due and no more.
+void appEditRepeatDue(uint64_t mono) {
+    if (!editRepeat.active()) return;
+    appTraceMono = mono;
+    uint32_t steps = editRepeat.poll(mono);
+    if (steps > 0 && state == SET_TIME) {
+        adjustEditedField(editRepeatSource == INPUT_INCREMENT_BUTTON ? 1 : -1, steps);
+    }
+    armEditRepeat(editRepeat.nextDue());
+}
+
+void onAppTransition(int from, int to) {
+    if (appTrace) appTrace->record(TRACE_STATE, appTraceMono, from < 0 ? TRACE_NO_STATE : (uint8_t)from, (uint8_t)to);
+    state = (AppState)to;
+#if defined(__cpp_impl_coroutine)
+    // Leaving SET_TIME other than through the flow's own commit (e.g. on DISPLAY_SLEEP) abandons the edit
+    if (to != SET_TIME) editPresses.cancel();
+#endif
+    appStateChanged(from, to);
+}
+
+// Return the maximum number of days in a given month, with 29 for February in leap years
+int getMaxDay(int month, int year) {
+    switch(month) {
+        case 1: case 3: case 5: case 7: case 8: case 10: case 12:
+            return 31;
+        case 4: case 6: case 9: case 11:
+            return 30;
+        case 2:
+            return isLeapYear(year) ? 29 : 28;
+        default:
+            return 31;
+    }
+}
+
+// Custom string comparison function similar to the standard strcmp.
+// Returns 0 if strings are equal, otherwise returns the difference between the first differing characters.
+int my_strcmp(const char *s1, const char *s2) {
+    while (*s1 && *s2 && (*s1 == *s2)) {
+        s1++;
+        s2++;
+    }
+    return ((unsigned char)*s1 - (unsigned char)*s2);
+}
+
+// Adjusts the appropriate field (Year, Month, Day, Hour, Minute, or Second) in the tm structure based on the current edit position.
+// "delta" indicates how much to change (positive to increase, negative to decrease).
+void adjustField(struct tm *timeinfo, int currentEditPos, int delta) {
+    // Retrieve the field name based on the current edit position.
+    const char* field = getCurrentFieldName(currentEditPos);
+    if (my_strcmp(field, "Year") == 0) {
+        // tm_year stores the number of years since 1900.
+        timeinfo->tm_year += delta;
+    } else if (my_strcmp(field, "Month") == 0) {
+        timeinfo->tm_mon += delta;
+        // Ensure month cycles within the valid range (0-11)
+        if (timeinfo->tm_mon > 11) timeinfo->tm_mon = 0;
+        else if (timeinfo->tm_mon < 0) timeinfo->tm_mon = 11;
+        // Adjust the day field if it exceeds the maximum days for the new month.
+        int max_day = getMaxDay(timeinfo->tm_mon + 1, timeinfo->tm_year + 1900);
+        if (timeinfo->tm_mday > max_day) {
+            timeinfo->tm_mday = max_day;
+        }
+    } else if (my_strcmp(field, "Day") == 0) {
+        int max_day = getMaxDay(timeinfo->tm_mon + 1, timeinfo->tm_year + 1900);
+        timeinfo->tm_mday += delta;
+        // Cycle the day within valid limits.
+        if (timeinfo->tm_mday > max_day) timeinfo->tm_mday = 1;
+        else if (timeinfo->tm_mday < 1) timeinfo->tm_mday = max_day;
+    } else if (my_strcmp(field, "Hour") == 0) {
+        timeinfo->tm_hour += delta;
+        if (timeinfo->tm_hour > 23) timeinfo->tm_hour = 0;
+        else if (timeinfo->tm_hour < 0) timeinfo->tm_hour = 23;
+    } else if (my_strcmp(field, "Minute") == 0) {
+        timeinfo->tm_min += delta;
+        if (timeinfo->tm_min > 59) timeinfo->tm_min = 0;
+        else if (timeinfo->tm_min < 0) timeinfo->tm_min = 59;
+    } else if (my_strcmp(field, "Second") == 0) {
+        timeinfo->tm_sec += delta;
+        if (timeinfo->tm_sec > 59) timeinfo->tm_sec = 0;
+        else if (timeinfo->tm_sec < 0) timeinfo->tm_sec = 59;
+    }
+}
+
+// Checks whether a given position in the time string is editable (i.e., a digit rather than a separator).
+bool isEditablePosition(int pos) {
+    // The valid editable range is from index 0 to TIME_STR_SIZE-2 (since last index is '\0')
+    if (pos < 0 || pos >= TIME_STR_SIZE - 1) return false;
+
+    // Define positions where the character is a fixed separator ('/', space, or ':')
+    int separators[] = {4, 7, 10, 13, 16};
+    for (int i = 0; i < 5; i++) {
+        if (pos == separators[i]) return false;
+    }
+    return true;
+}
+
+// Converts the time string stored in editBuffer to a struct tm.
+// Returns true if the parsing is successful, false otherwise.
+bool parseEditBufferToTm(const char *buffer, struct tm *timeinfo) {
+    memset(timeinfo, 0, sizeof(struct tm)); // Clear the structure
+    int year, mon, day, hour, min, sec;
+    // Expecting the format "YYYY/MM/DD HH:MM:SS"
+    if (sscanf(buffer, "%4d/%2d/%2d %2d:%2d:%2d", &year, &mon, &day, &hour, &min, &sec) != 6) {
+        return false;
+    }
+    // Convert the values to the tm structure (note: tm_year is years since 1900 and tm_mon is 0-based)
+    timeinfo->tm_year = year - 1900;
+    timeinfo->tm_mon = mon - 1;
+    timeinfo->tm_mday = day;
+    timeinfo->tm_hour = hour;
+    timeinfo->tm_min = min;
+    timeinfo->tm_sec = sec;
+    return true;
+}
+
+// Returns the name of the field corresponding to the current edit position.
+// For example, positions 0-3 are for the "Year", 5-6 for the "Month", etc.
+const char* getCurrentFieldName(int pos) {
+    if (pos >= 0 && pos <= 3) return "Year";      // Characters 0-3 correspond to the year
+    if (pos >= 5 && pos <= 6) return "Month";       // Characters 5-6 for month
+    if (pos >= 8 && pos <= 9) return "Day";         // Characters 8-9 for day
+    if (pos >= 11 && pos <= 12) return "Hour";      // Characters 11-12 for hour
+    if (pos >= 14 && pos <= 15) return "Minute";    // Characters 14-15 for minute
+    if (pos >= 17 && pos <= 18) return "Second";    // Characters 17-18 for second
+    return "Unknown";
+}
+
+// SET_TIME entry. On C++20 builds the editor runs as one flow; without it (or if the frame pool is
+// exhausted) the SET_TIME rows of the state machine drive the same steps.
+void enterTimeEdit() {
+#if defined(__cpp_impl_coroutine)
+    timeEditFlow();
+    if (editPresses.waiting()) return;
+#endif
+    beginTimeEdit();
+}
+
+#if defined(__cpp_impl_coroutine)
+// Step the digit under the cursor, move on with SET, and set the clock when SET is pressed on the
+// last digit. The edit only ends there, or when the state machine leaves SET_TIME and cancels it.
+EventTask timeEditFlow() {
+    beginTimeEdit();
+    while (true) {
+        InputEvent press = co_await editPresses;
+        if (press.source == INPUT_INCREMENT_BUTTON) {
+            incrementEditedField();
+        } else if (press.source == INPUT_REPLAY_BUTTON) {
+            decrementEditedField();
+        } else if (press.source == INPUT_SET_TIME_BUTTON) {
+            if (atLastEditPosition()) break;
+            nextEditPosition();
+        }
+    }
+    commitTimeEdit();
+    appMachine.dispatch(APP_EV_EDIT_DONE);
+}
+#endif
+
+// Start editing from the current time
+void beginTimeEdit() {
+    time_t rawtime = currentTime();
+    if (appTrace) appTrace->record(TRACE_CLOCK, appTraceMono, TRACE_CLOCK_READ, 0, (uint32_t)rawtime);
+    struct tm timeinfo;
+    epochToTm(rawtime, &timeinfo);    // Not localtime(), whose shared result is not reentrant
+    // Format the current system time into the editBuffer (ensuring proper format)
+    strftime(editBuffer, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", &timeinfo);
+    currentEditPos = 0;
+    // Find the first editable digit by skipping non-editable separator positions
+    while (currentEditPos < TIME_STR_SIZE - 1 && !isEditablePosition(currentEditPos)) {
+        currentEditPos++;
+    }
+    updateSetTimeDisplay();
+}
+
+// Cycle to the next editable digit (skip over non-editable separator positions)
+void nextEditPosition() {
+    int startPos = currentEditPos;
+    do {
+        currentEditPos = (currentEditPos + 1) % (TIME_STR_SIZE - 1);
+        if (currentEditPos == startPos) break; // Prevent infinite loop if no editable position found
+    } while (!isEditablePosition(currentEditPos));
+    updateSetTimeDisplay();
+}
+
+// The last editable position is the second digit of the seconds
+bool atLastEditPosition() {
+    return currentEditPos == 18;
+}
+
+// Parse the edited time and set the system time
+void commitTimeEdit() {
+    struct tm newTime;
+    if (parseEditBufferToTm(editBuffer, &newTime)) {
+        time_t newTimeT = mktime(&newTime);
+        if (appTrace) appTrace->record(TRACE_CLOCK, appTraceMono, TRACE_CLOCK_SET, 0, (uint32_t)newTimeT);
+        setSystemTime(newTimeT);
+    }
+}
+
+void incrementEditedField() {
+    adjustEditedField(1, 1);
+}
+
+void decrementEditedField() {
+    adjustEditedField(-1, 1);
+}
+
+// Each step wraps the field on its own, and the screen is redrawn once for the whole batch
+void adjustEditedField(int delta, uint32_t steps) {
+    struct tm currentTime;
+    if (parseEditBufferToTm(editBuffer, &currentTime)) {
+        for (uint32_t i = 0; i < steps; i++) {
+            adjustField(&currentTime, currentEditPos, delta);
+        }
+        // Reformat the new time into the editBuffer
+        strftime(editBuffer, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", &currentTime);
+    }
+    updateSetTimeDisplay();
+}
@@ -0,0 +1,73 @@
+#ifndef APP_H
+#define APP_H
+
+#include <cstdint>
+#include <ctime>
+#include "input_events.h"
+#include "input_trace.h"
+
+// Application logic without hardware: the mode state machine, the time editor and hold-to-repeat.
+// It is driven by button edges and platform events and reaches the hardware only through the hooks
+// below. main.cpp implements them for the board, host/host_platform.cpp on the host HAL and
+// host/replay.cpp under simulated time for trace replay.
+// Everything here runs on one thread (the main event queue on the board).
+
+#define TIME_STR_SIZE 20              // Size of time string "YYYY/MM/DD HH:MM:SS" (19 characters + NULL terminator)
+
+// Application state machine to manage different modes
+enum AppState {
+    IDLE,        // Idle state: display current time
+    LOG_TIME,    // Log time state: save current time to EEPROM
+    DISPLAY_LOG, // Display log state: show stored log records on LCD
+    SET_TIME,    // Time-setting state: allow user to adjust the system time
+    SYNC_STATS,  // Sync statistics state: show offset, jitter and Allan deviation on LCD
+    APP_TOP,     // Superstate of all of the above
+    APP_PAGES,   // Superstate of the log and sync statistics pages
+    APP_STATE_COUNT
+};
+// Events driving the state machine; the first four are the buttons, in InputSource order
+enum AppEvent {
+    APP_EV_LOG,
+    APP_EV_REPLAY,
+    APP_EV_SET,
+    APP_EV_INCREMENT,
+    APP_EV_DISPLAY_SLEEP,  // Display timeout (low-power builds)
+    APP_EV_COMPLETE,       // Dispatched once after entering a state that handles it
+    APP_EV_EDIT_DONE,      // The SET_TIME flow has set the clock (C++20 builds)
+    APP_EVENT_COUNT
+};
+
+extern AppState state;                  // Current leaf state of the application state machine
+extern char editBuffer[TIME_STR_SIZE];  // Time string being edited in SET_TIME (format: "YYYY/MM/DD HH:MM:SS")
+extern int currentEditPos;              // Current index position in editBuffer that is being edited
+
+// Driving the application; "mono" is the monotonic time of the cause (the edge time for buttons)
+void appStart(uint64_t mono);                       // Enter IDLE and draw the clock face (drops a repeat in progress)
+void appDispatch(AppEvent event, uint64_t mono);    // Event raised by the platform, such as the display timeout
+void appHandleInput(const InputEvent &event);       // One debounced button edge, in arrival order
+void appEditRepeatDue(uint64_t mono);               // The repeat armed through armEditRepeat fell due
+void appSetTrace(InputTrace *trace);                // Record inputs and transitions to "trace" (nullptr stops)
+
+// Time editor
+bool isEditablePosition(int pos);  // Check if a given index in the time string is editable (i.e., not a separator)
+bool parseEditBufferToTm(const char *buffer, struct tm *timeinfo); // Convert the editBuffer string to a struct tm
+const char* getCurrentFieldName(int pos); // Get the name of the time field (Year, Month, etc.) based on the current edit position
+int getMaxDay(int month, int year);        // Get the maximum number of days in the given month (29 for February in leap years)
+int my_strcmp(const char *s1, const char *s2); // Custom string comparison function, similar to strcmp
+void adjustField(struct tm *timeinfo, int currentEditPos, int delta); // Adjust the corresponding field in tm by delta
+void adjustEditedField(int delta, uint32_t steps); // Step the field under the cursor on the SET_TIME screen by "delta", "steps" times
+
+// Platform hooks
+void updateDisplay();              // Update the LCD with the current system time and date
+void updateSetTimeDisplay();       // Update the LCD with the time-setting interface
+void displayLogs();                // Request the stored log records and show them when they arrive
+void displaySyncStats();           // Show the sync-quality estimators on the LCD
+void storeCurrentTime();           // Save the current system time to EEPROM
+bool syncStatsPageEnabled();       // The log page leads on to the sync statistics page
+time_t currentTime();              // Current wall-clock time in seconds since the epoch
+void setSystemTime(time_t t);      // Step the wall clock (and the RTC) to a new time
+void appStateChanged(int from, int to);  // Leaf state changed ("from" is -1 at start)
+void armEditRepeat(uint64_t due);  // Call appEditRepeatDue once "due" has passed, replacing any pending call
+void cancelEditRepeat();
+
+#endif // APP_H
@@ -0,0 +1,59 @@
+#include "auto_repeat.h"
+
+AutoRepeat::AutoRepeat(const RepeatStage *stages, int count)
+    : stages(stages), count(count), held(false), pressedAt(0), delivered(0) {}
+
+void AutoRepeat::press(uint64_t mono) {
+    held = true;
+    pressedAt = mono;
+    delivered = 0;
+}
+
+uint32_t AutoRepeat::poll(uint64_t mono) {
+    if (!held || mono < pressedAt) return 0;
+    uint32_t due = repeatsAfter(mono - pressedAt);
+    uint32_t fresh = due > delivered ? due - delivered : 0;
+    delivered += fresh;
+    return fresh;
+}
+
+uint32_t AutoRepeat::release(uint64_t mono) {
+    uint32_t fresh = poll(mono);
+    held = false;
+    return fresh;
+}
+
+// Repeats in stage i fall at afterMs, afterMs + periodMs, ... up to (not including) the next stage's start
+uint32_t AutoRepeat::repeatsAfter(uint64_t heldUs) const {
+    uint32_t total = 0;
+    for (int i = 0; i < count; i++) {
+        uint64_t start = (uint64_t)stages[i].afterMs * 1000;
+        if (heldUs < start) break;
+        uint64_t last = heldUs;
+        if (i + 1 < count) {
+            uint64_t end = (uint64_t)stages[i + 1].afterMs * 1000;
+            if (last >= end) last = end - 1;
+        }
+        total += (uint32_t)((last - start) / ((uint64_t)stages[i].periodMs * 1000)) + 1;
+    }
+    return total;
+}
+
+// The next repeat is the one with index "delivered", counting across all stages
+uint64_t AutoRepeat::nextDue() const {
+    uint32_t before = 0;    // Repeats in the stages already passed
+    for (int i = 0; i < count; i++) {
+        uint64_t start = (uint64_t)stages[i].afterMs * 1000;
+        uint64_t period = (uint64_t)stages[i].periodMs * 1000;
+        if (i + 1 < count) {
+            uint64_t end = (uint64_t)stages[i + 1].afterMs * 1000;
+            uint32_t inStage = (uint32_t)((end - start + period - 1) / period);
+            if (delivered >= before + inStage) {
+                before += inStage;
+                continue;
+            }
+        }
+        return pressedAt + start + (uint64_t)(delivered - before) * period;
+    }
+    return UINT64_MAX;
+}
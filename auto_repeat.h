@@ -0,0 +1,44 @@
+#ifndef AUTO_REPEAT_H
+#define AUTO_REPEAT_H
+
+#include <cstdint>
+
+// Hold-to-repeat with an acceleration curve.
+// The curve is a table of stages: from "afterMs" of holding onwards the button repeats every
+// "periodMs", until the next stage takes over. Repeats are counted from the press timestamp, not
+// from when the owner happened to look, so a late poll returns every step that fell due since the
+// last one. The release timestamp ends the count exactly, so a slow main thread neither drops
+// steps nor adds any. The press itself is not a repeat; the owner handles it as a normal press.
+
+struct RepeatStage {
+    uint32_t afterMs;        // Hold time at which this stage starts (ascending, first one is the initial delay)
+    uint32_t periodMs;       // Time between repeats in this stage (non-zero)
+};
+
+class AutoRepeat {
+public:
+    AutoRepeat(const RepeatStage *stages, int count);
+
+    // Start counting repeats for a button pressed at "mono"
+    void press(uint64_t mono);
+    // Repeats that fell due since the last poll, up to and including "mono"
+    uint32_t poll(uint64_t mono);
+    // Stop at the release time; returns the repeats due up to then that were not yet polled
+    uint32_t release(uint64_t mono);
+
+    bool active() const { return held; }
+    // Monotonic time of the next repeat (only meaningful while active)
+    uint64_t nextDue() const;
+
+    // Total repeats due after holding for "heldUs"
+    uint32_t repeatsAfter(uint64_t heldUs) const;
+
+private:
+    const RepeatStage *stages;
+    int count;
+    bool held;
+    uint64_t pressedAt;
+    uint32_t delivered;      // Repeats already returned for this press
+};
+
+#endif // AUTO_REPEAT_H
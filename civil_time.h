@@ -0,0 +1,61 @@
+#ifndef CIVIL_TIME_H
+#define CIVIL_TIME_H
+
+#include <cstdint>
+#include <ctime>
+
+// Calendar arithmetic shared by the time sources. Unlike mktime() these do not depend on the
+// C library time zone and are safe to call from any context.
+
+// Days since 1970-01-01 for a proleptic Gregorian date (month 1-12).
+// Howard Hinnant's days_from_civil: shift the year to start in March so February is last.
+inline int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Inverse of daysFromCivil (Hinnant's civil_from_days).
+inline void civilFromDays(int64_t days, int *year, int *month, int *day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yoe + era * 400 + (*month <= 2));
+}
+
+// Seconds since the Unix epoch for a UTC date and time.
+inline int64_t civilToEpoch(int year, int month, int day, int hour, int minute, int second) {
+    return daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+// Broken-down UTC for seconds since the Unix epoch; the reentrant replacement for gmtime()/localtime()
+// on this UTC-only clock.
+inline void epochToTm(int64_t epoch, struct tm *t) {
+    int64_t days = (epoch >= 0 ? epoch : epoch - 86399) / 86400;
+    int64_t secOfDay = epoch - days * 86400;
+    int year, month, day;
+    civilFromDays(days, &year, &month, &day);
+    t->tm_year = year - 1900;
+    t->tm_mon = month - 1;
+    t->tm_mday = day;
+    t->tm_hour = (int)(secOfDay / 3600);
+    t->tm_min = (int)(secOfDay / 60 % 60);
+    t->tm_sec = (int)(secOfDay % 60);
+    t->tm_wday = (int)((days % 7 + 11) % 7);            // 1970-01-01 was a Thursday
+    t->tm_yday = (int)(days - daysFromCivil(year, 1, 1));
+    t->tm_isdst = 0;
+}
+
+inline bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+#endif // CIVIL_TIME_H
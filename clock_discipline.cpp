@@ -0,0 +1,45 @@
+#include "clock_discipline.h"
+
+ClockDiscipline::ClockDiscipline(WallClock &clock, uint32_t averaging, uint32_t stepoutSec)
+    : clock(clock), averaging(averaging), stepoutSec(stepoutSec), haveLast(false), lastMono(0),
+      spikeSince(0), freqPpb(0), spikeCount(0), stepCount(0) {
+}
+
+void ClockDiscipline::update(int64_t offsetUs, uint64_t mono) {
+    bool large = offsetUs > WALLCLOCK_STEP_THRESHOLD_US || offsetUs < -WALLCLOCK_STEP_THRESHOLD_US;
+    if (large && clock.isSet() && haveLast) {
+        // Hold off until the disagreement has lasted a full stepout interval
+        if (spikeSince == 0) spikeSince = mono;
+        if (mono - spikeSince < (uint64_t)stepoutSec * USEC_PER_SEC) {
+            spikeCount++;
+            return;
+        }
+    }
+    spikeSince = 0;
+
+    if (large || !clock.isSet()) {
+        // Stepping invalidates the frequency history measured against the old phase
+        clock.correct(offsetUs, mono);
+        stepCount++;
+        haveLast = true;
+        lastMono = mono;
+        return;
+    }
+
+    // Whatever the previous correction has not slewed in yet is already accounted for; the rest of the
+    // offset built up since the last update and measures the remaining frequency error
+    int64_t residual = offsetUs - clock.pendingSlewUs(mono);
+    clock.correct(offsetUs, mono);
+    if (haveLast && mono > lastMono) {
+        // Frequency term: move 1/averaging of the way towards residual / dt (us per s = ppm, x1000 = ppb)
+        int64_t dtUs = (int64_t)(mono - lastMono);
+        int64_t step = residual * 1000 * USEC_PER_SEC / dtUs / averaging;
+        int64_t freq = freqPpb + step;
+        if (freq > DISCIPLINE_MAX_FREQ_PPB) freq = DISCIPLINE_MAX_FREQ_PPB;
+        if (freq < -DISCIPLINE_MAX_FREQ_PPB) freq = -DISCIPLINE_MAX_FREQ_PPB;
+        freqPpb = (int32_t)freq;
+        clock.setFrequencyPpb(freqPpb, mono);
+    }
+    haveLast = true;
+    lastMono = mono;
+}
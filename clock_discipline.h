@@ -0,0 +1,42 @@
+#ifndef CLOCK_DISCIPLINE_H
+#define CLOCK_DISCIPLINE_H
+
+#include <cstdint>
+#include "wallclock.h"
+
+constexpr int32_t DISCIPLINE_MAX_FREQ_PPB = 500000;     // Frequency correction limit (500 ppm)
+
+// Phase/frequency loop that steers a WallClock from a stream of offset estimates.
+// Phase errors are slewed (so the time shown never jumps). Because each update slews the whole offset
+// out, the offset that has built up by the next update measures the rate error, and the frequency term
+// moves 1/"averaging" of the way towards it. Offsets above the step threshold are treated
+// as spikes and ignored until they persist for "stepoutSec", then stepped. One bad sample, or a brief
+// disagreement while the selected source changes, therefore never moves the clock by more than the
+// slew limit.
+class ClockDiscipline {
+public:
+    ClockDiscipline(WallClock &clock, uint32_t averaging = 8, uint32_t stepoutSec = 30);
+
+    // Apply one combined offset estimate (reference minus local) taken at monotonic instant "mono".
+    void update(int64_t offsetUs, uint64_t mono);
+
+    int32_t frequencyPpb() const { return freqPpb; }
+    // Continue from a frequency applied by someone else (holdover) instead of the last locked value
+    void seedFrequency(int32_t ppb) { freqPpb = ppb; }
+    uint32_t spikes() const { return spikeCount; }
+    uint32_t steps() const { return stepCount; }
+    bool locked() const { return haveLast; }
+
+private:
+    WallClock &clock;
+    uint32_t averaging;
+    uint32_t stepoutSec;
+    bool haveLast;
+    uint64_t lastMono;
+    uint64_t spikeSince;    // Monotonic time the current run of over-threshold offsets started (0 = none)
+    int32_t freqPpb;
+    uint32_t spikeCount;
+    uint32_t stepCount;
+};
+
+#endif // CLOCK_DISCIPLINE_H
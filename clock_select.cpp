@@ -0,0 +1,120 @@
+#include "clock_select.h"
+
+// Error budgets per source. Bus error grows with each hop through extraErrorUs; DCF77 receiver
+// modules add tens of milliseconds of filter delay, which dominates its bound.
+static const ClockSourceSpec sourceSpecs[CLOCK_SOURCE_COUNT] = {
+    {"bus",      100,    50, 10000},
+    {"gps",      20,     50, 10000},
+    {"timecode", 30000,  50, 180000},
+    {"manual",   500000, 50, 0},
+};
+
+const ClockSourceSpec &ClockSelector::spec(ClockSourceId id) {
+    return sourceSpecs[id];
+}
+
+ClockSelector::ClockSelector(const WallClock &clock) : clock(clock), sources(), best(CLOCK_SOURCE_MANUAL), fresh(false) {
+}
+
+void ClockSelector::addSample(ClockSourceId id, int64_t refEpochUs, uint64_t refMono, uint32_t extraErrorUs) {
+    ClockSourceState &s = sources[id];
+    s.valid = true;
+    s.refEpochUs = refEpochUs;
+    s.refMono = refMono;
+    s.extraErrorUs = extraErrorUs;
+    s.samples++;
+    fresh = true;
+}
+
+bool ClockSelector::select(uint64_t mono, ClockEstimate *out) {
+    struct Endpoint {
+        int64_t value;
+        int type;           // +1 opens an interval, -1 closes it
+    };
+    int64_t offset[CLOCK_SOURCE_COUNT];
+    int64_t error[CLOCK_SOURCE_COUNT];
+    Endpoint ends[2 * CLOCK_SOURCE_COUNT];
+    int n = 0, endCount = 0;
+    int precise = -1;
+    int64_t localNow = clock.now(mono);
+    fresh = false;
+
+    for (int i = 0; i < CLOCK_SOURCE_COUNT; i++) {
+        ClockSourceState &s = sources[i];
+        s.truechimer = false;
+        if (!s.valid) continue;
+        uint64_t age = mono > s.refMono ? mono - s.refMono : 0;
+        if (sourceSpecs[i].maxAgeMs != 0 && age > (uint64_t)sourceSpecs[i].maxAgeMs * 1000) {
+            s.valid = false;
+            continue;
+        }
+        // Carry the reference point forward on the monotonic timebase, widening the bound as it ages
+        offset[i] = s.refEpochUs + (int64_t)age - localNow;
+        error[i] = (int64_t)sourceSpecs[i].baseErrorUs + s.extraErrorUs + (int64_t)(age * sourceSpecs[i].wanderPpm / 1000000);
+        ends[endCount++] = {offset[i] - error[i], +1};
+        ends[endCount++] = {offset[i] + error[i], -1};
+        if (precise < 0 || error[i] < error[precise]) precise = i;
+        n++;
+    }
+    // Manual entry is only a wide sanity interval for the other sources. The SET_TIME step already put
+    // the clock there, so on its own it must not steer the clock back towards the raw timebase.
+    if (n == 0 || (n == 1 && sources[CLOCK_SOURCE_MANUAL].valid)) return false;
+
+    // Insertion sort (at most eight endpoints); on ties openings come first so touching intervals intersect
+    for (int i = 1; i < endCount; i++) {
+        Endpoint e = ends[i];
+        int j = i - 1;
+        while (j >= 0 && (ends[j].value > e.value || (ends[j].value == e.value && ends[j].type < e.type))) {
+            ends[j + 1] = ends[j];
+            j--;
+        }
+        ends[j + 1] = e;
+    }
+
+    // Marzullo: the deepest overlap runs from the opening that reached it to the next endpoint
+    int depth = 0, bestDepth = 0;
+    int64_t lo = 0, hi = 0;
+    for (int i = 0; i < endCount; i++) {
+        depth += ends[i].type;
+        if (ends[i].type > 0 && depth > bestDepth && i + 1 < endCount) {
+            bestDepth = depth;
+            lo = ends[i].value;
+            hi = ends[i + 1].value;
+        }
+    }
+    bool majority = bestDepth * 2 > n;
+    if (!majority) {
+        lo = offset[precise] - error[precise];
+        hi = offset[precise] + error[precise];
+    }
+
+    // Truechimers overlap the chosen region; combine them weighted by precision
+    double weightSum = 0, weighted = 0;
+    int truechimers = 0;
+    int bestIndex = -1;
+    for (int i = 0; i < CLOCK_SOURCE_COUNT; i++) {
+        ClockSourceState &s = sources[i];
+        if (!s.valid) continue;
+        if (offset[i] - error[i] > hi || offset[i] + error[i] < lo) {
+            s.falseticks++;
+            continue;
+        }
+        s.truechimer = true;
+        truechimers++;
+        double w = 1.0 / ((double)error[i] * (double)error[i] + 1.0);
+        weightSum += w;
+        weighted += w * (double)offset[i];
+        if (bestIndex < 0 || error[i] < error[bestIndex]) bestIndex = i;
+    }
+    best = (ClockSourceId)bestIndex;
+    int64_t combined = (int64_t)(weighted / weightSum);
+    if (combined < lo) combined = lo;
+    if (combined > hi) combined = hi;
+
+    out->offsetUs = combined;
+    out->errorUs = (uint32_t)((hi - lo) / 2);
+    out->candidates = n;
+    out->truechimers = truechimers;
+    out->majority = majority;
+    return true;
+}
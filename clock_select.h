@@ -0,0 +1,73 @@
+#ifndef CLOCK_SELECT_H
+#define CLOCK_SELECT_H
+
+#include <cstdint>
+#include "wallclock.h"
+
+// Automatic choice between the available time sources.
+// Every source reports reference points ("true time was R at monotonic instant M") with an error
+// bound. At selection time each point is carried forward to the present, its error widened by the
+// source's wander rate, and the resulting confidence intervals are intersected with Marzullo's algorithm.
+// Sources whose interval misses the best intersection are falsetickers and are excluded. The remaining
+// truechimers are averaged with 1/error^2 weights into one estimate for the ClockDiscipline loop.
+
+enum ClockSourceId {
+    CLOCK_SOURCE_BUS,        // RS-485 time distribution (follower)
+    CLOCK_SOURCE_GPS,        // NMEA + 1PPS
+    CLOCK_SOURCE_TIMECODE,   // DCF77 or IRIG-B
+    CLOCK_SOURCE_MANUAL,     // Time entered on the SET_TIME screen
+    CLOCK_SOURCE_COUNT
+};
+
+struct ClockSourceSpec {
+    const char *name;
+    uint32_t baseErrorUs;    // Error bound of a fresh sample
+    uint32_t wanderPpm;      // Error growth with sample age (local oscillator plus source wander)
+    uint32_t maxAgeMs;       // Samples older than this no longer take part (0 = never expire)
+};
+
+struct ClockSourceState {
+    bool valid;              // Has a sample that is not too old
+    bool truechimer;         // Took part in the last combined estimate
+    int64_t refEpochUs;
+    uint64_t refMono;
+    uint32_t extraErrorUs;   // Sample-specific error on top of the base error (for example hop count)
+    uint32_t samples;
+    uint32_t falseticks;     // Selections that rejected this source
+};
+
+struct ClockEstimate {
+    int64_t offsetUs;        // Combined reference minus local wall clock
+    uint32_t errorUs;        // Half-width of the intersection the estimate came from
+    int candidates;          // Sources with a valid sample
+    int truechimers;         // Sources inside the intersection
+    bool majority;           // Truechimers were a strict majority of the candidates
+};
+
+class ClockSelector {
+public:
+    explicit ClockSelector(const WallClock &clock);
+
+    // Record a reference point from a source.
+    void addSample(ClockSourceId id, int64_t refEpochUs, uint64_t refMono, uint32_t extraErrorUs = 0);
+
+    // Run the intersection at monotonic instant "mono". Returns false if no source other than manual entry is usable.
+    // Without a strict majority the clique that contains the most precise source wins, so two
+    // disagreeing sources (for example GPS and a mistyped manual entry) resolve towards precision.
+    bool select(uint64_t mono, ClockEstimate *out);
+
+    // True if any source has reported since the last select()
+    bool hasNewSamples() const { return fresh; }
+
+    const ClockSourceState &source(ClockSourceId id) const { return sources[id]; }
+    static const ClockSourceSpec &spec(ClockSourceId id);
+    ClockSourceId preferred() const { return best; }
+
+private:
+    const WallClock &clock;
+    ClockSourceState sources[CLOCK_SOURCE_COUNT];
+    ClockSourceId best;
+    bool fresh;
+};
+
+#endif // CLOCK_SELECT_H
@@ -0,0 +1,51 @@
+#include "console.h"
+#include <cstdio>
+#include <cstring>
+
+Console::Console(const ConsoleCommand *commands, int count) : commands(commands), count(count), length(0) {
+    line[0] = '\0';
+}
+
+void Console::feed(char c) {
+    if (c == '\r' || c == '\n') {
+        if (length == 0) return;
+        line[length] = '\0';
+        length = 0;
+        execute(line);
+        return;
+    }
+    if (c == '\b' || c == 0x7F) {
+        if (length > 0) length--;
+        return;
+    }
+    // Overlong lines are truncated rather than split into two commands
+    if (length < CONSOLE_LINE_SIZE - 1) {
+        line[length++] = c;
+    }
+}
+
+void Console::execute(const char *text) {
+    while (*text == ' ') text++;
+    size_t nameLength = strcspn(text, " ");
+    if (nameLength == 0) return;
+    const char *args = text + nameLength;
+    while (*args == ' ') args++;
+
+    if (nameLength == 4 && strncmp(text, "help", 4) == 0) {
+        printHelp();
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        if (strlen(commands[i].name) == nameLength && strncmp(text, commands[i].name, nameLength) == 0) {
+            commands[i].handler(args);
+            return;
+        }
+    }
+    printf("unknown command '%.*s' (try help)\n", (int)nameLength, text);
+}
+
+void Console::printHelp() const {
+    for (int i = 0; i < count; i++) {
+        printf("%-10s %s\n", commands[i].name, commands[i].help);
+    }
+}
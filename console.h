@@ -0,0 +1,38 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <cstddef>
+
+// Line-oriented command console on the debug serial port.
+// Commands are a static table of name/help/handler; the handler gets the rest of the line
+// (leading spaces removed, possibly empty) and prints its own output with printf.
+typedef void (*ConsoleHandler)(const char *args);
+
+struct ConsoleCommand {
+    const char *name;
+    const char *help;
+    ConsoleHandler handler;
+};
+
+constexpr size_t CONSOLE_LINE_SIZE = 64;
+
+class Console {
+public:
+    Console(const ConsoleCommand *commands, int count);
+
+    // Feed one received character; a CR or LF runs the buffered line.
+    void feed(char c);
+
+    // Run one complete command line.
+    void execute(const char *line);
+
+private:
+    void printHelp() const;
+
+    const ConsoleCommand *commands;
+    int count;
+    char line[CONSOLE_LINE_SIZE];
+    size_t length;
+};
+
+#endif // CONSOLE_H
@@ -0,0 +1,60 @@
+#ifndef DEBOUNCER_H
+#define DEBOUNCER_H
+
+#include <cstdint>
+
+// Sampled debouncer for up to 32 inputs.
+// The owner samples every input once per SAMPLE_US and passes the raw levels in as a bitmask (bit i
+// set = input i active). Each input has a shift register holding its last STABLE_US / SAMPLE_US
+// samples. The debounced state only changes when the whole window agrees on the new level. A bounce
+// anywhere in the window resets the count, so contact chatter never reaches the application, and
+// an input may toggle again as soon as the window has filled. Cost is one shift and one compare per
+// input per sample, and it does not depend on how often the inputs change.
+template <int N, uint32_t SAMPLE_US, uint32_t STABLE_US>
+class Debouncer {
+    static_assert(N >= 1 && N <= 32, "Debouncer handles 1 to 32 inputs");
+    static_assert(STABLE_US >= SAMPLE_US && STABLE_US / SAMPLE_US <= 32, "Stable window must be 1 to 32 samples");
+
+public:
+    static constexpr uint32_t STABLE_SAMPLES = STABLE_US / SAMPLE_US;
+    static constexpr uint32_t WINDOW = STABLE_SAMPLES == 32 ? 0xFFFFFFFFu : (1u << STABLE_SAMPLES) - 1;
+
+    Debouncer() : debounced(0) {
+        for (int i = 0; i < N; i++) history[i] = 0;
+    }
+
+    // Shift in one sample of every input. Returns the inputs whose debounced state changed;
+    // state() then holds their new levels.
+    uint32_t sample(uint32_t raw) {
+        uint32_t changed = 0;
+        for (int i = 0; i < N; i++) {
+            history[i] = (history[i] << 1) | ((raw >> i) & 1u);
+            uint32_t window = history[i] & WINDOW;
+            bool active = (debounced >> i) & 1u;
+            if ((window == WINDOW && !active) || (window == 0 && active)) changed |= 1u << i;
+        }
+        debounced ^= changed;
+        return changed;
+    }
+
+    // Debounced levels, bit i = input i active
+    uint32_t state() const { return debounced; }
+
+    // True when every input's window agrees with its debounced state, so further samples cannot
+    // change anything until an input moves again. The owner may stop sampling until the next edge.
+    bool settled() const {
+        for (int i = 0; i < N; i++) {
+            uint32_t window = history[i] & WINDOW;
+            if (window != (((debounced >> i) & 1u) ? WINDOW : 0)) return false;
+        }
+        return true;
+    }
+
+    static constexpr uint32_t samplePeriodUs() { return SAMPLE_US; }
+
+private:
+    uint32_t history[N];
+    uint32_t debounced;
+};
+
+#endif // DEBOUNCER_H
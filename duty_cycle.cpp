@@ -0,0 +1,34 @@
+#include "duty_cycle.h"
+
+DutyCycleMeter::DutyCycleMeter() {
+    CpuCounters zero = {0, 0, 0, 0};
+    reset(zero);
+}
+
+void DutyCycleMeter::reset(const CpuCounters &now) {
+    for (int i = 0; i < MAX_STATES; i++) {
+        states[i] = DutyCycle{0, 0, 0, 0, 0};
+    }
+    last = now;
+}
+
+void DutyCycleMeter::transition(int leaving, int entering, const CpuCounters &now) {
+    if (leaving >= 0 && leaving < MAX_STATES) {
+        DutyCycle &s = states[leaving];
+        uint64_t total = now.uptimeUs - last.uptimeUs;
+        uint64_t idle = now.idleUs - last.idleUs;
+        s.totalUs += total;
+        s.activeUs += total > idle ? total - idle : 0;
+        s.sleepUs += now.sleepUs - last.sleepUs;
+        s.deepSleepUs += now.deepSleepUs - last.deepSleepUs;
+    }
+    if (entering != leaving && entering >= 0 && entering < MAX_STATES) {
+        states[entering].entries++;
+    }
+    last = now;
+}
+
+double DutyCycleMeter::activePercent(int s) const {
+    if (states[s].totalUs == 0) return 0;
+    return 100.0 * (double)states[s].activeUs / (double)states[s].totalUs;
+}
@@ -0,0 +1,47 @@
+#ifndef DUTY_CYCLE_H
+#define DUTY_CYCLE_H
+
+#include <cstdint>
+
+// Per-state CPU duty cycle, for sizing battery-backed deployments.
+// The platform keeps cumulative counters of uptime, idle time (no thread runnable), and the part of
+// the idle time spent in sleep and in deep sleep (STOP). At every state change the owner passes in
+// the current counters, and the difference since the previous call is charged to the state being
+// left. Active time is uptime minus idle time.
+
+struct CpuCounters {
+    uint64_t uptimeUs;
+    uint64_t idleUs;
+    uint64_t sleepUs;
+    uint64_t deepSleepUs;
+};
+
+struct DutyCycle {
+    uint64_t totalUs;        // Time spent in the state
+    uint64_t activeUs;       // ... with the CPU running
+    uint64_t sleepUs;        // ... in sleep (clocks running, waiting for an interrupt)
+    uint64_t deepSleepUs;    // ... in STOP mode
+    uint32_t entries;
+};
+
+class DutyCycleMeter {
+public:
+    static constexpr int MAX_STATES = 8;
+
+    DutyCycleMeter();
+
+    // Charge the time since the last call to "leaving" and start timing "entering".
+    // Passing the same state for both just brings the figures up to date.
+    void transition(int leaving, int entering, const CpuCounters &now);
+
+    const DutyCycle &state(int s) const { return states[s]; }
+    // Active time as a percentage of the time spent in "s" (0 if the state was never entered)
+    double activePercent(int s) const;
+    void reset(const CpuCounters &now);
+
+private:
+    DutyCycle states[MAX_STATES];
+    CpuCounters last;
+};
+
+#endif // DUTY_CYCLE_H
@@ -0,0 +1,111 @@
+#include "edf_scheduler.h"
+#include "wallclock.h"
+
+constexpr uint64_t EDF_NEVER = UINT64_MAX;
+
+EdfScheduler::EdfScheduler(EventQueue &queue)
+    : queue(queue), count(0), dispatchQueued(false), timerEvent(0), timerDue(EDF_NEVER) {}
+
+int EdfScheduler::addTask(const char *name, EdfJob job, uint32_t periodUs, uint32_t deadlineUs) {
+    if (count == EDF_MAX_TASKS) return -1;
+    Task &t = tasks[count];
+    t.name = name;
+    t.job = job;
+    t.periodUs = periodUs;
+    t.deadlineUs = deadlineUs;
+    t.nextRelease = EDF_NEVER;
+    t.ready = false;
+    t.deadline = 0;
+    t.stats = EdfTaskStats{0, 0, 0, INT32_MIN, 0};
+    return count++;
+}
+
+void EdfScheduler::start() {
+    uint64_t now = monotonicMicros();
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].periodUs != 0 && tasks[i].nextRelease == EDF_NEVER) tasks[i].nextRelease = now + tasks[i].periodUs;
+    }
+    arm();
+}
+
+void EdfScheduler::releaseAt(int task, uint64_t mono) {
+    if (task < 0 || task >= count) return;
+    tasks[task].nextRelease = mono;
+    arm();
+}
+
+void EdfScheduler::resetStats() {
+    for (int i = 0; i < count; i++) tasks[i].stats = EdfTaskStats{0, 0, 0, INT32_MIN, 0};
+}
+
+// Periodic releases stay on their original grid; releases missed while the task was still
+// waiting, or while the thread was held up, are counted rather than run late in a burst
+void EdfScheduler::releaseDue(uint64_t now) {
+    for (int i = 0; i < count; i++) {
+        Task &t = tasks[i];
+        if (t.nextRelease > now) continue;
+        if (t.ready) {
+            t.stats.skipped++;
+        } else {
+            t.ready = true;
+            t.deadline = t.nextRelease + t.deadlineUs;
+        }
+        if (t.periodUs == 0) {
+            t.nextRelease = EDF_NEVER;
+            continue;
+        }
+        t.nextRelease += t.periodUs;
+        while (t.nextRelease <= now) {
+            t.nextRelease += t.periodUs;
+            t.stats.skipped++;
+        }
+    }
+}
+
+// Run the ready job with the earliest deadline, then queue another dispatch if more are ready
+void EdfScheduler::dispatch() {
+    dispatchQueued = false;
+    releaseDue(monotonicMicros());
+    int next = -1;
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].ready && (next < 0 || tasks[i].deadline < tasks[next].deadline)) next = i;
+    }
+    if (next >= 0) {
+        Task &t = tasks[next];
+        t.ready = false;
+        uint64_t started = monotonicMicros();
+        t.job();
+        uint64_t finished = monotonicMicros();
+        int64_t lateness = (int64_t)(finished - t.deadline);
+        t.stats.runs++;
+        if (lateness > 0) t.stats.misses++;
+        if (lateness > t.stats.maxLatenessUs) t.stats.maxLatenessUs = lateness > INT32_MAX ? INT32_MAX : (int32_t)lateness;
+        if (finished - started > t.stats.maxRunUs) t.stats.maxRunUs = (uint32_t)(finished - started);
+    }
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].ready && !dispatchQueued) {
+            dispatchQueued = queue.call(callback(this, &EdfScheduler::dispatch)) != 0;
+        }
+    }
+    arm();
+}
+
+void EdfScheduler::onTimer() {
+    timerEvent = 0;
+    timerDue = EDF_NEVER;
+    dispatch();
+}
+
+// Keep one timer event, for the earliest future release
+void EdfScheduler::arm() {
+    uint64_t earliest = EDF_NEVER;
+    for (int i = 0; i < count; i++) {
+        if (tasks[i].nextRelease < earliest) earliest = tasks[i].nextRelease;
+    }
+    if (earliest == EDF_NEVER || (timerEvent != 0 && timerDue <= earliest)) return;
+    if (timerEvent != 0) queue.cancel(timerEvent);
+    uint64_t now = monotonicMicros();
+    uint64_t waitMs = earliest > now ? (earliest - now + 999) / 1000 : 0;
+    timerDue = earliest;
+    timerEvent = queue.call_in(std::chrono::milliseconds(waitMs), callback(this, &EdfScheduler::onTimer));
+}
@@ -0,0 +1,71 @@
+#ifndef EDF_SCHEDULER_H
+#define EDF_SCHEDULER_H
+
+#include "mbed.h"
+
+// Earliest-deadline-first scheduling of the periodic work on the main EventQueue.
+// Each task has a relative deadline and either a period or releases set by its owner (releaseAt).
+// At most one queue event waits for the next release. When jobs are released, the one with the
+// earliest absolute deadline runs first. Each job is its own queue event, so button and console
+// events can still run between jobs. Jobs run to completion (cooperative), so a long job delays
+// the others but never interrupts them. The scheduler records the lateness of each job
+// (finish - deadline) and counts misses, plus releases skipped because the previous job of the
+// same task had not run yet.
+
+typedef void (*EdfJob)();
+
+constexpr int EDF_MAX_TASKS = 8;
+
+struct EdfTaskStats {
+    uint32_t runs;
+    uint32_t misses;          // Jobs that finished after their deadline
+    uint32_t skipped;         // Releases dropped because the task was already waiting to run
+    int32_t maxLatenessUs;    // Worst finish - deadline (negative = always early)
+    uint32_t maxRunUs;        // Longest job
+};
+
+class EdfScheduler {
+public:
+    explicit EdfScheduler(EventQueue &queue);
+
+    // periodUs == 0: released only by releaseAt. The first periodic release is one period after start().
+    // Returns the task id, or -1 if the table is full.
+    int addTask(const char *name, EdfJob job, uint32_t periodUs, uint32_t deadlineUs);
+
+    void start();
+
+    // Release "task" at monotonic time "mono" (replaces any release not yet made)
+    void releaseAt(int task, uint64_t mono);
+
+    int taskCount() const { return count; }
+    const char *name(int task) const { return tasks[task].name; }
+    uint32_t deadlineUs(int task) const { return tasks[task].deadlineUs; }
+    const EdfTaskStats &stats(int task) const { return tasks[task].stats; }
+    void resetStats();
+
+private:
+    struct Task {
+        const char *name;
+        EdfJob job;
+        uint32_t periodUs;
+        uint32_t deadlineUs;
+        uint64_t nextRelease;     // EDF_NEVER if none
+        bool ready;
+        uint64_t deadline;        // Absolute deadline of the ready job
+        EdfTaskStats stats;
+    };
+
+    void releaseDue(uint64_t now);
+    void dispatch();
+    void onTimer();
+    void arm();
+
+    EventQueue &queue;
+    Task tasks[EDF_MAX_TASKS];
+    int count;
+    bool dispatchQueued;
+    int timerEvent;               // Pending onTimer event, 0 if none
+    uint64_t timerDue;
+};
+
+#endif // EDF_SCHEDULER_H
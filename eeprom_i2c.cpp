@@ -0,0 +1,36 @@
+#include "eeprom_i2c.h"
+#include <cstring>
+#include "profiler.h"
+
+constexpr int EEPROM_WRITE_CYCLE_MS = 6;    // Page write time of the 24-series EEPROM
+
+I2cEeprom::I2cEeprom(I2cBus &bus, int deviceAddress, const char *clientName)
+    : bus(bus), busClient(-1), deviceAddress(deviceAddress), clientName(clientName) {}
+
+void I2cEeprom::start() {
+    busClient = bus.addClient(clientName);
+}
+
+// Combines the 2-byte internal EEPROM address with the data and writes the whole buffer,
+// then waits out the EEPROM's internal write cycle
+bool I2cEeprom::write(unsigned int address, const char *data, int size) {
+    ProfileProbe probe(PROFILE_EEPROM_WRITE);
+    if (size > HAL_EEPROM_PAGE_SIZE) return false;
+    char i2cBuffer[HAL_EEPROM_PAGE_SIZE + 2];
+    i2cBuffer[0] = (unsigned char)(address >> 8);     // Most significant byte of internal address
+    i2cBuffer[1] = (unsigned char)(address & 0xFF);   // Least significant byte
+    memcpy(&i2cBuffer[2], data, size);
+    int result = bus.transfer(busClient, deviceAddress, i2cBuffer, size + 2, nullptr, 0, I2C_PRIORITY_BULK);
+    // The write cycle runs inside the EEPROM, so the bus is free for other clients meanwhile
+    thread_sleep_for(EEPROM_WRITE_CYCLE_MS);
+    return result == 0;
+}
+
+// Writes the 2-byte internal address, then reads from that location
+bool I2cEeprom::read(unsigned int address, char *data, int size) {
+    ProfileProbe probe(PROFILE_EEPROM_READ);
+    char i2cBuffer[2];
+    i2cBuffer[0] = (unsigned char)(address >> 8);
+    i2cBuffer[1] = (unsigned char)(address & 0xFF);
+    return bus.transfer(busClient, deviceAddress, i2cBuffer, 2, data, size, I2C_PRIORITY_CRITICAL) == 0;
+}
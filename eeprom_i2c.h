@@ -0,0 +1,28 @@
+#ifndef EEPROM_I2C_H
+#define EEPROM_I2C_H
+
+#include "hal.h"
+#include "i2c_bus.h"
+
+// HalEeprom on a 24-series I2C EEPROM, as a client of the shared bus.
+// Reads are submitted as critical transactions and page writes as bulk ones. After a write, the
+// calling thread waits out the part's internal write cycle; the bus is free for other clients
+// meanwhile.
+class I2cEeprom : public HalEeprom {
+public:
+    I2cEeprom(I2cBus &bus, int deviceAddress, const char *clientName = "eeprom");
+
+    // Register with the bus (once, before the first transfer)
+    void start();
+
+    bool read(unsigned int address, char *data, int size) override;
+    bool write(unsigned int address, const char *data, int size) override;
+
+private:
+    I2cBus &bus;
+    int busClient;
+    int deviceAddress;
+    const char *clientName;
+};
+
+#endif // EEPROM_I2C_H
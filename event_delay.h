@@ -0,0 +1,28 @@
+#ifndef EVENT_DELAY_H
+#define EVENT_DELAY_H
+
+#include "mbed.h"
+#include "event_task.h"
+
+#if defined(__cpp_impl_coroutine)
+
+// co_await EventDelay(queue, 500ms): resume from "queue" after the delay. If the queue is full the
+// coroutine carries on at once rather than being lost.
+class EventDelay {
+public:
+    EventDelay(EventQueue &queue, std::chrono::milliseconds delay) : queue(queue), delay(delay) {}
+    bool await_ready() const { return delay.count() <= 0; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+        return queue.call_in(delay, &EventDelay::resume, handle.address()) != 0;
+    }
+    void await_resume() {}
+
+private:
+    static void resume(void *address) { std::coroutine_handle<>::from_address(address).resume(); }
+    EventQueue &queue;
+    std::chrono::milliseconds delay;
+};
+
+#endif // __cpp_impl_coroutine
+
+#endif // EVENT_DELAY_H
@@ -0,0 +1,53 @@
+#include "event_task.h"
+
+#if defined(__cpp_impl_coroutine)
+
+static_assert(EVENT_TASK_FRAMES <= 32, "Frame pool is tracked in one 32-bit mask");
+
+alignas(8) static uint8_t frames[EVENT_TASK_FRAMES][EVENT_TASK_FRAME_SIZE];
+static uint32_t used = 0;       // Bit i set = frames[i] holds a coroutine
+static int peak = 0;
+static uint32_t failed = 0;
+static size_t largest = 0;
+
+void *EventTaskPool::allocate(size_t size) {
+    if (size > largest) largest = size;
+    if (size <= EVENT_TASK_FRAME_SIZE) {
+        for (int i = 0; i < EVENT_TASK_FRAMES; i++) {
+            if (!(used & (1u << i))) {
+                used |= 1u << i;
+                if (inUse() > peak) peak = inUse();
+                return frames[i];
+            }
+        }
+    }
+    failed++;
+    return nullptr;
+}
+
+void EventTaskPool::release(void *frame) {
+    int i = (int)(((uint8_t *)frame - &frames[0][0]) / EVENT_TASK_FRAME_SIZE);
+    if (i >= 0 && i < EVENT_TASK_FRAMES) used &= ~(1u << i);
+}
+
+int EventTaskPool::inUse() {
+    int count = 0;
+    for (int i = 0; i < EVENT_TASK_FRAMES; i++) {
+        if (used & (1u << i)) count++;
+    }
+    return count;
+}
+
+int EventTaskPool::highWater() {
+    return peak;
+}
+
+uint32_t EventTaskPool::failures() {
+    return failed;
+}
+
+size_t EventTaskPool::largestFrame() {
+    return largest;
+}
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,84 @@
+#ifndef EVENT_TASK_H
+#define EVENT_TASK_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Coroutines on the main EventQueue (C++20 builds, see cxx20.json).
+// An EventTask starts running when it is called and runs until its first co_await. It is then
+// resumed by an event on the queue when the awaited thing completes, so a multi-step flow reads
+// top to bottom without blocking the thread or being split into callbacks. The frame is destroyed
+// when the coroutine returns. Frames come from a fixed pool, not the heap. If the pool is empty,
+// or the frame is bigger than a pool block, the coroutine does not run and a failure is counted.
+// Tasks are started and resumed on the main thread only.
+// Nothing here depends on mbed, so app.cpp can run its flows on the host too; the awaitables for
+// the board's queue and storage are in event_delay.h and log_storage.h.
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+
+// With 64-bit g++ 12 the frames are 216 bytes (logging the time), 160 (log page) and 64 (SET_TIME)
+// at -O0, -Os and -O2; 32-bit pointers only make them smaller. `tasks` reports the largest on the board.
+constexpr size_t EVENT_TASK_FRAME_SIZE = 256;
+constexpr int EVENT_TASK_FRAMES = 4;
+
+class EventTaskPool {
+public:
+    static void *allocate(size_t size);
+    static void release(void *frame);
+    static int inUse();
+    static int highWater();
+    static uint32_t failures();    // Coroutines that could not start
+    static size_t largestFrame();  // Largest frame asked for, whether or not it fitted
+};
+
+struct EventTask {
+    struct promise_type {
+        static void *operator new(size_t size) noexcept { return EventTaskPool::allocate(size); }
+        static void operator delete(void *frame) { EventTaskPool::release(frame); }
+        static EventTask get_return_object_on_allocation_failure() { return EventTask(); }
+        EventTask get_return_object() { return EventTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {}
+    };
+};
+
+// co_await signal: suspend until post() hands over the next value, such as a button press.
+// One coroutine waits at a time. post() resumes it at once, on the caller's thread, and returns
+// false if none was waiting so the caller can deal with the value itself. cancel() destroys a
+// waiting coroutine, returning its frame to the pool, when the flow it runs is abandoned.
+template <typename T>
+class EventSignal {
+public:
+    bool waiting() const { return (bool)handle; }
+
+    bool post(const T &next) {
+        if (!handle) return false;
+        value = next;
+        std::coroutine_handle<> resumed = handle;
+        handle = nullptr;
+        resumed.resume();
+        return true;
+    }
+
+    void cancel() {
+        if (!handle) return;
+        std::coroutine_handle<> abandoned = handle;
+        handle = nullptr;
+        abandoned.destroy();
+    }
+
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<> waiter) { handle = waiter; }
+    T await_resume() { return value; }
+
+private:
+    std::coroutine_handle<> handle;
+    T value;
+};
+
+#endif // __cpp_impl_coroutine
+
+#endif // EVENT_TASK_H
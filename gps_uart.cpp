@@ -0,0 +1,57 @@
+#include "gps_uart.h"
+#include "mbed.h"
+
+uint8_t gpsDmaBuffer[GPS_DMA_BUFFER_SIZE];
+
+static UART_HandleTypeDef gpsUart;
+static DMA_HandleTypeDef gpsDmaRx;
+
+void gpsUartStart() {
+    __HAL_RCC_GPIOD_CLK_ENABLE();
+    __HAL_RCC_USART2_CLK_ENABLE();
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    // PD_5 = USART2_TX, PD_6 = USART2_RX (alternate function 7)
+    GPIO_InitTypeDef gpio = {0};
+    gpio.Pin = GPIO_PIN_5 | GPIO_PIN_6;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_PULLUP;
+    gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+    gpio.Alternate = GPIO_AF7_USART2;
+    HAL_GPIO_Init(GPIOD, &gpio);
+
+    // USART2_RX is DMA1 Stream5 Channel4; circular mode wraps forever without CPU help
+    gpsDmaRx.Instance = DMA1_Stream5;
+    gpsDmaRx.Init.Channel = DMA_CHANNEL_4;
+    gpsDmaRx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    gpsDmaRx.Init.PeriphInc = DMA_PINC_DISABLE;
+    gpsDmaRx.Init.MemInc = DMA_MINC_ENABLE;
+    gpsDmaRx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    gpsDmaRx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    gpsDmaRx.Init.Mode = DMA_CIRCULAR;
+    gpsDmaRx.Init.Priority = DMA_PRIORITY_LOW;
+    gpsDmaRx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&gpsDmaRx);
+    __HAL_LINKDMA(&gpsUart, hdmarx, gpsDmaRx);
+
+    gpsUart.Instance = USART2;
+    gpsUart.Init.BaudRate = GPS_BAUD;
+    gpsUart.Init.WordLength = UART_WORDLENGTH_8B;
+    gpsUart.Init.StopBits = UART_STOPBITS_1;
+    gpsUart.Init.Parity = UART_PARITY_NONE;
+    gpsUart.Init.Mode = UART_MODE_TX_RX;
+    gpsUart.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+    gpsUart.Init.OverSampling = UART_OVERSAMPLING_16;
+    HAL_UART_Init(&gpsUart);
+
+    HAL_UART_Receive_DMA(&gpsUart, gpsDmaBuffer, GPS_DMA_BUFFER_SIZE);
+    // The transfer never completes, so the half/full-transfer interrupts are not needed
+    __HAL_DMA_DISABLE_IT(&gpsDmaRx, DMA_IT_HT | DMA_IT_TC);
+    // The UART is driven through the HAL, so nothing in mbed knows it must stay clocked; STOP mode would halt reception
+    sleep_manager_lock_deep_sleep();
+}
+
+size_t gpsDmaWriteIndex() {
+    // NDTR counts down the bytes left before the DMA wraps
+    return GPS_DMA_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(&gpsDmaRx);
+}
@@ -0,0 +1,21 @@
+#ifndef GPS_UART_H
+#define GPS_UART_H
+
+#include <cstdint>
+#include <cstddef>
+
+// GPS receiver UART (USART2 on PD_5/PD_6) received by DMA1 Stream5 in circular mode.
+// The DMA engine writes into gpsDmaBuffer continuously; the CPU never touches individual bytes
+// until the NMEA parser walks them in place.
+constexpr size_t GPS_DMA_BUFFER_SIZE = 512;   // Power of two, holds several seconds of NMEA at 9600 baud
+constexpr int GPS_BAUD = 9600;
+
+extern uint8_t gpsDmaBuffer[GPS_DMA_BUFFER_SIZE];
+
+// Configure the UART and start the circular DMA transfer.
+void gpsUartStart();
+
+// Index in gpsDmaBuffer the DMA engine will write next.
+size_t gpsDmaWriteIndex();
+
+#endif // GPS_UART_H
@@ -0,0 +1,39 @@
+#ifndef HAL_H
+#define HAL_H
+
+// The hardware the screens and the time log need, as interfaces.
+// The board implements them over the DISCO LCD driver (lcd_disco.h) and the shared I2C bus
+// (eeprom_i2c.h). host/host_hal.h implements them for Linux with a framebuffer and a file, so the
+// same application code runs as a host executable.
+
+enum HalFont {
+    HAL_FONT_16,             // 11 x 16 pixel cells
+    HAL_FONT_20              // 14 x 20 pixel cells
+};
+
+constexpr int HAL_LCD_WIDTH = 240;
+constexpr int HAL_LCD_HEIGHT = 320;
+
+class HalLcd {
+public:
+    virtual ~HalLcd() {}
+    virtual void clear() = 0;                            // White screen; text is drawn in black
+    virtual void setFont(HalFont font) = 0;
+    virtual void drawCentered(int y, const char *text) = 0;
+    virtual int line(int n) const = 0;                   // Top of text line "n" in the current font
+    virtual void displayOn() = 0;
+    virtual void displayOff() = 0;
+};
+
+constexpr int HAL_EEPROM_PAGE_SIZE = 32;    // Smallest page of the 24-series parts in use
+
+class HalEeprom {
+public:
+    virtual ~HalEeprom() {}
+    // Both return false if the device did not acknowledge. A write must stay within one page and
+    // returns once the part's internal write cycle is over.
+    virtual bool read(unsigned int address, char *data, int size) = 0;
+    virtual bool write(unsigned int address, const char *data, int size) = 0;
+};
+
+#endif // HAL_H
@@ -0,0 +1,103 @@
+#include "holdover.h"
+#include <cmath>
+
+constexpr double MODEL_CENTER_C = 25.0;
+constexpr uint32_t MODEL_MIN_SAMPLES = 60;
+constexpr double MODEL_EXTRAPOLATION_C = 5.0;  // Predictions are clamped to the seen range plus this margin
+
+TempFrequencyModel::TempFrequencyModel(double memorySamples) : lambda(1.0 - 1.0 / memorySamples) {
+    reset();
+}
+
+void TempFrequencyModel::reset() {
+    for (int i = 0; i < 5; i++) s[i] = 0;
+    for (int i = 0; i < 3; i++) y[i] = 0;
+    count = 0;
+    minTemp = 1e9;
+    maxTemp = -1e9;
+}
+
+void TempFrequencyModel::addSample(double tempC, double freqPpb) {
+    double t = tempC - MODEL_CENTER_C;
+    double p = 1;
+    for (int i = 0; i < 5; i++) {
+        s[i] = lambda * s[i] + p;
+        if (i < 3) y[i] = lambda * y[i] + freqPpb * p;
+        p *= t;
+    }
+    count++;
+    if (tempC < minTemp) minTemp = tempC;
+    if (tempC > maxTemp) maxTemp = tempC;
+}
+
+int TempFrequencyModel::order() const {
+    if (count < MODEL_MIN_SAMPLES) return -1;
+    // A curve can only be fitted across a temperature spread; otherwise fall back to a constant or a line
+    double mean = s[1] / s[0];
+    double variance = s[2] / s[0] - mean * mean;
+    if (variance < 0.25) return 0;
+    if (variance < 4.0) return 1;
+    return 2;
+}
+
+static double det3(double a, double b, double c, double d, double e, double f, double g, double h, double i) {
+    return a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+}
+
+bool TempFrequencyModel::predict(double tempC, double *freqPpb) const {
+    int n = order();
+    if (n < 0) return false;
+    if (tempC < minTemp - MODEL_EXTRAPOLATION_C) tempC = minTemp - MODEL_EXTRAPOLATION_C;
+    if (tempC > maxTemp + MODEL_EXTRAPOLATION_C) tempC = maxTemp + MODEL_EXTRAPOLATION_C;
+    double t = tempC - MODEL_CENTER_C;
+
+    if (n == 2) {
+        // Normal equations for f = c0 + c1 t + c2 t^2, solved by Cramer's rule
+        double d = det3(s[0], s[1], s[2], s[1], s[2], s[3], s[2], s[3], s[4]);
+        if (std::fabs(d) > 1e-9) {
+            double c0 = det3(y[0], s[1], s[2], y[1], s[2], s[3], y[2], s[3], s[4]) / d;
+            double c1 = det3(s[0], y[0], s[2], s[1], y[1], s[3], s[2], y[2], s[4]) / d;
+            double c2 = det3(s[0], s[1], y[0], s[1], s[2], y[1], s[2], s[3], y[2]) / d;
+            *freqPpb = c0 + c1 * t + c2 * t * t;
+            return true;
+        }
+        n = 1;
+    }
+    if (n == 1) {
+        double d = s[0] * s[2] - s[1] * s[1];
+        if (std::fabs(d) > 1e-9) {
+            double c1 = (s[0] * y[1] - s[1] * y[0]) / d;
+            double c0 = (y[0] - c1 * s[1]) / s[0];
+            *freqPpb = c0 + c1 * t;
+            return true;
+        }
+    }
+    *freqPpb = y[0] / s[0];
+    return true;
+}
+
+HoldoverController::HoldoverController(WallClock &clock, TempFrequencyModel &model)
+    : clock(clock), model(model), inHoldover(false), everLocked(false), startMono(0), lastLockedPpb(0),
+      applied(0), entryCount(0) {
+}
+
+bool HoldoverController::update(bool haveReference, double tempC, int32_t lockedFreqPpb, uint64_t mono) {
+    if (haveReference) {
+        model.addSample(tempC, lockedFreqPpb);
+        everLocked = true;
+        lastLockedPpb = lockedFreqPpb;
+        inHoldover = false;
+        return false;
+    }
+    // Nothing to hold over from until the loop has locked at least once
+    if (!everLocked) return false;
+    if (!inHoldover) {
+        inHoldover = true;
+        startMono = mono;
+        entryCount++;
+    }
+    double predicted;
+    applied = model.predict(tempC, &predicted) ? (int32_t)predicted : lastLockedPpb;
+    clock.setFrequencyPpb(applied, mono);
+    return true;
+}
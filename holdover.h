@@ -0,0 +1,63 @@
+#ifndef HOLDOVER_H
+#define HOLDOVER_H
+
+#include <cstdint>
+#include "wallclock.h"
+
+// Holdover: keep the clock on time after every reference has been lost.
+// While a reference is present the discipline loop's frequency correction is the oscillator's rate
+// error at the current die temperature. TempFrequencyModel learns that relationship as a quadratic
+// (the shape of both AT-cut and tuning-fork crystals near room temperature) by exponentially weighted
+// least squares. Memory is constant and each sample costs O(1). In holdover the model's prediction for
+// the present temperature is applied to the clock continuously.
+
+class TempFrequencyModel {
+public:
+    // "memorySamples" is the effective number of samples remembered by the exponential forgetting
+    explicit TempFrequencyModel(double memorySamples = 86400);
+
+    void addSample(double tempC, double freqPpb);
+    // Predicted rate error at "tempC". Returns false until enough samples have been seen.
+    bool predict(double tempC, double *freqPpb) const;
+    void reset();
+
+    uint32_t samples() const { return count; }
+    int order() const;                      // Polynomial order the data currently supports (0-2)
+    double minTempC() const { return minTemp; }
+    double maxTempC() const { return maxTemp; }
+
+private:
+    double lambda;
+    double s[5];        // Weighted sums of t^0..t^4, t = temperature - 25 C
+    double y[3];        // Weighted sums of f * t^0..t^2
+    uint32_t count;
+    double minTemp;
+    double maxTemp;
+};
+
+class HoldoverController {
+public:
+    HoldoverController(WallClock &clock, TempFrequencyModel &model);
+
+    // Call once per selection period. "haveReference" says whether the discipline loop was fed this period;
+    // "lockedFreqPpb" is its frequency correction (only used when a reference is present).
+    // Returns true while in holdover.
+    bool update(bool haveReference, double tempC, int32_t lockedFreqPpb, uint64_t mono);
+
+    bool active() const { return inHoldover; }
+    uint64_t holdoverStartMono() const { return startMono; }
+    int32_t appliedPpb() const { return applied; }
+    uint32_t entries() const { return entryCount; }
+
+private:
+    WallClock &clock;
+    TempFrequencyModel &model;
+    bool inHoldover;
+    bool everLocked;
+    uint64_t startMono;
+    int32_t lastLockedPpb;
+    int32_t applied;
+    uint32_t entryCount;
+};
+
+#endif // HOLDOVER_H
@@ -0,0 +1,190 @@
+// Microbenchmarks of the application's hot paths on the host HAL (host/host_platform.cpp).
+// Each case runs in rounds of a fixed number of calls. The host CPU time per call is measured with
+// steady_clock, and the median, minimum and maximum over the rounds are reported, so one
+// preempted round does not skew the result. The EEPROM's bus and write-cycle time is simulated
+// (host/host_hal.h) and reported per call beside it, as is the number of pixels drawn. The results
+// go to stdout (or -o) as JSON for tracking across commits; a table goes to stderr.
+//
+//   g++ -std=c++17 -O2 -I. -Ihost host/bench.cpp host/host_platform.cpp host/host_hal.cpp app.cpp
+//       screens.cpp auto_repeat.cpp input_trace.cpp wallclock.cpp leap_seconds.cpp
+//       time_snapshot.cpp sync_stats.cpp profiler.cpp event_task.cpp -o bench
+//   ./bench [-n calls] [-r rounds] [-o results.json] [name...]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "host_platform.h"
+#include "app.h"
+
+struct BenchCase {
+    const char *name;
+    void (*setup)();
+    void (*run)();
+};
+
+struct BenchResult {
+    double medianNs;
+    double minNs;
+    double maxNs;
+    double simUs;            // Simulated EEPROM time per call
+    double eepromReads;      // Transfers per call
+    double eepromWrites;
+    double pixels;           // Pixels written per call
+};
+
+volatile int sink;           // Keeps results of pure functions alive
+struct tm benchTm;
+int benchPos;
+
+void setupClockFace() {
+    state = IDLE;
+}
+
+void setupLogs() {
+    state = DISPLAY_LOG;
+    hostLoadLogs();
+}
+
+void setupEditor() {
+    state = SET_TIME;
+    strcpy(editBuffer, "2025/06/15 12:34:56");
+    currentEditPos = 8;
+    benchPos = 0;
+}
+
+void runUpdateDisplay() {
+    updateDisplay();
+}
+
+void runStoreCurrentTime() {
+    storeCurrentTime();
+}
+
+void runDisplayLogs() {
+    displayLogs();
+}
+
+void runLoadLogs() {
+    hostLoadLogs();
+}
+
+void runUpdateSetTimeDisplay() {
+    updateSetTimeDisplay();
+}
+
+void runParseEditBuffer() {
+    sink = parseEditBufferToTm(editBuffer, &benchTm);
+}
+
+// Every editable position in turn, so each field's branch is taken
+void runAdjustField() {
+    static const int POSITIONS[] = {0, 5, 8, 11, 14, 17};
+    adjustField(&benchTm, POSITIONS[benchPos], 1);
+    benchPos = (benchPos + 1) % 6;
+    sink = benchTm.tm_sec;
+}
+
+const BenchCase CASES[] = {
+    {"updateDisplay", setupClockFace, runUpdateDisplay},
+    {"storeCurrentTime", setupClockFace, runStoreCurrentTime},
+    {"displayLogs", setupLogs, runDisplayLogs},
+    {"loadLogs", setupLogs, runLoadLogs},           // The storage worker's start-up read
+    {"updateSetTimeDisplay", setupEditor, runUpdateSetTimeDisplay},
+    {"parseEditBufferToTm", setupEditor, runParseEditBuffer},
+    {"adjustField", setupEditor, runAdjustField},
+};
+constexpr int CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+BenchResult measure(const BenchCase &c, int calls, int rounds) {
+    c.setup();
+    if (c.run == runAdjustField) parseEditBufferToTm(editBuffer, &benchTm);
+    for (int i = 0; i < calls / 10 + 1; i++) c.run();   // Warm up caches and branch predictors
+
+    uint64_t busy0 = hostEeprom.busyMicros();
+    uint32_t reads0 = hostEeprom.reads(), writes0 = hostEeprom.writes();
+    uint64_t pixels0 = hostLcd.pixelsWritten();
+    std::vector<double> perCall;
+    for (int r = 0; r < rounds; r++) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; i++) c.run();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        perCall.push_back(ns / calls);
+    }
+    std::sort(perCall.begin(), perCall.end());
+
+    double total = (double)calls * rounds;
+    BenchResult result;
+    result.medianNs = perCall[perCall.size() / 2];
+    result.minNs = perCall.front();
+    result.maxNs = perCall.back();
+    result.simUs = (hostEeprom.busyMicros() - busy0) / total;
+    result.eepromReads = (hostEeprom.reads() - reads0) / total;
+    result.eepromWrites = (hostEeprom.writes() - writes0) / total;
+    result.pixels = (hostLcd.pixelsWritten() - pixels0) / total;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int calls = 1000;
+    int rounds = 15;
+    const char *outPath = nullptr;
+    std::vector<const char *> only;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            calls = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: bench [-n calls] [-r rounds] [-o results.json] [name...]\n");
+            return 2;
+        } else {
+            only.push_back(argv[i]);
+        }
+    }
+    if (calls < 1) calls = 1;
+    if (rounds < 1) rounds = 1;
+
+    // Same start as clock_host: UTC, log records in an in-memory EEPROM, the clock at 2025-01-01
+    setenv("TZ", "UTC", 1);
+    tzset();
+    wallClock.setLeapTable(&leapTable);
+    tm t{};
+    t.tm_year = 125;
+    t.tm_mday = 1;
+    setSystemTime(mktime(&t));
+    storeCurrentTime();
+    storeCurrentTime();
+
+    FILE *out = stdout;
+    if (outPath != nullptr && (out = fopen(outPath, "w")) == nullptr) {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        return 2;
+    }
+    fprintf(out, "{\n  \"suite\": \"clock_hot_paths\",\n  \"compiler\": \"%s\",\n", __VERSION__);
+    fprintf(out, "  \"unix_time\": %lld,\n  \"calls_per_round\": %d,\n  \"rounds\": %d,\n  \"results\": [",
+            (long long)time(nullptr), calls, rounds);
+    fprintf(stderr, "%-22s %12s %12s %12s %12s %10s\n", "case", "median ns", "min ns", "max ns", "sim us", "pixels");
+    bool first = true;
+    for (int i = 0; i < CASE_COUNT; i++) {
+        const BenchCase &c = CASES[i];
+        bool wanted = only.empty();
+        for (const char *name : only) wanted = wanted || strcmp(name, c.name) == 0;
+        if (!wanted) continue;
+
+        BenchResult r = measure(c, calls, rounds);
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"cpu_ns_median\": %.1f, \"cpu_ns_min\": %.1f, \"cpu_ns_max\": %.1f, "
+                "\"sim_i2c_us\": %.1f, \"eeprom_reads\": %.2f, \"eeprom_writes\": %.2f, \"lcd_pixels\": %.0f}",
+                first ? "" : ",", c.name, r.medianNs, r.minNs, r.maxNs, r.simUs, r.eepromReads, r.eepromWrites, r.pixels);
+        fprintf(stderr, "%-22s %12.1f %12.1f %12.1f %12.1f %10.0f\n", c.name, r.medianNs, r.minNs, r.maxNs, r.simUs, r.pixels);
+        first = false;
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) fclose(out);
+    return 0;
+}
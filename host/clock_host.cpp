@@ -0,0 +1,156 @@
+// The clock's application logic as a Linux program, on the host HAL (host/host_hal.h).
+// Buttons come from a script and time is simulated, so a run is repeatable and finishes as fast as
+// the host allows (or at --speed times real time). The EEPROM image persists in a file between runs.
+//
+//   g++ -std=c++17 -O2 -I. -Ihost host/clock_host.cpp host/host_platform.cpp host/host_hal.cpp
+//       app.cpp screens.cpp auto_repeat.cpp input_trace.cpp wallclock.cpp leap_seconds.cpp
+//       time_snapshot.cpp sync_stats.cpp profiler.cpp event_task.cpp -o clock_host
+//   ./clock_host [--script buttons.txt] [--eeprom eeprom.bin] [--until s] [--speed x] [--ppm screen.ppm] [-p] [-s] [-v]
+//
+// -s runs a SHOW_SYNC_STATS_PAGE build and -v prints every input with the screen after it. At the
+// end the screen's text, the log records and the EEPROM traffic are printed, and with -p the
+// profiling table (host CPU time per page drawn, as "prof" shows it on the board).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "host_platform.h"
+#include "app.h"
+#include "profiler.h"
+
+const char *const STATE_NAMES[] = {"IDLE", "LOG_TIME", "DISPLAY_LOG", "SET_TIME", "SYNC_STATS"};
+const char *const SOURCE_NAMES[INPUT_SOURCE_COUNT] = {"log", "replay", "set", "inc"};
+
+// A record as text; an erased slot reads as 0xFF bytes
+const char *printable(const char *record, char *out) {
+    for (int i = 0; i < LOG_RECORD_SIZE; i++) {
+        out[i] = record[i] == '\0' || (record[i] >= ' ' && record[i] <= '~') ? record[i] : '.';
+    }
+    out[LOG_RECORD_SIZE - 1] = '\0';
+    return out;
+}
+
+void usage() {
+    fprintf(stderr, "usage: clock_host [--script file] [--eeprom file] [--until s] [--speed x] [--ppm file] [-p] [-s] [-v]\n");
+}
+
+int main(int argc, char **argv) {
+    const char *scriptPath = nullptr;
+    const char *eepromPath = nullptr;
+    const char *ppmPath = nullptr;
+    double untilSec = -1;
+    bool verbose = false;
+    bool profile = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--script") == 0 && hasValue) {
+            scriptPath = argv[++i];
+        } else if (strcmp(argv[i], "--eeprom") == 0 && hasValue) {
+            eepromPath = argv[++i];
+        } else if (strcmp(argv[i], "--ppm") == 0 && hasValue) {
+            ppmPath = argv[++i];
+        } else if (strcmp(argv[i], "--until") == 0 && hasValue) {
+            untilSec = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--speed") == 0 && hasValue) {
+            hostClock.setSpeed(atof(argv[++i]));
+        } else if (strcmp(argv[i], "-s") == 0) {
+            hostSyncStatsPage = true;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    ButtonScript script;
+    if (scriptPath != nullptr && !script.load(scriptPath)) return 2;
+    if (eepromPath != nullptr && !hostEeprom.open(eepromPath)) {
+        fprintf(stderr, "cannot open %s\n", eepromPath);
+        return 2;
+    }
+    // Run until a second after the last edge unless told otherwise
+    uint64_t until = untilSec >= 0 ? (uint64_t)(untilSec * 1e6)
+                                   : (script.count() > 0 ? script.edge(script.count() - 1).mono : 0) + 1000000;
+
+    // The board shows UTC; mktime in the application must do the same here
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    // Same start-up as the board: the storage worker loads the log, the clock starts at 2025-01-01
+    profilerStart(0);
+    hostLoadLogs();
+    wallClock.setLeapTable(&leapTable);
+    tm t{};
+    t.tm_year = 125;
+    t.tm_mday = 1;
+    setSystemTime(mktime(&t));
+    hostLcd.clear();
+    hostLcd.setFont(HAL_FONT_20);
+    appStart(monotonicMicros());
+
+    // Whichever of the next edge, the edit repeat and the second tick is due first runs next.
+    // Work that takes simulated time (EEPROM writes) can make the next one start late, as on the board.
+    int nextEdge = 0;
+    uint64_t tick = nextSecondTick();
+    while (true) {
+        uint64_t due = until;
+        int kind = 0;   // 0 end, 1 edge, 2 repeat, 3 tick
+        if (nextEdge < script.count() && script.edge(nextEdge).mono <= due) {
+            due = script.edge(nextEdge).mono;
+            kind = 1;
+        }
+        if (hostRepeatArmed && hostRepeatDue < due) {
+            due = hostRepeatDue;
+            kind = 2;
+        }
+        if (tick < due) {
+            due = tick;
+            kind = 3;
+        }
+        if (kind == 0) break;
+        hostClock.advanceTo(due);
+
+        AppState before = state;
+        if (kind == 1) {
+            const InputEvent &event = script.edge(nextEdge++);
+            appHandleInput(event);
+            if (verbose) {
+                printf("%10.3f s  %s %s -> %s\n", event.mono / 1e6, SOURCE_NAMES[event.source],
+                       event.edge == INPUT_PRESSED ? "press" : "release", STATE_NAMES[state]);
+                if (state != before || event.edge == INPUT_PRESSED) hostLcd.printText(stdout);
+            }
+        } else if (kind == 2) {
+            hostRepeatArmed = false;
+            appEditRepeatDue(due);
+            if (verbose) printf("%10.3f s  repeat: %s\n", due / 1e6, editBuffer);
+        } else {
+            onSecondTick();
+        }
+        tick = nextSecondTick();
+    }
+    hostClock.advanceTo(until);
+
+    const StorageLogs &logs = hostLogs();
+    printf("after %.3f s in %s:\n", hostClock.now() / 1e6, STATE_NAMES[state]);
+    hostLcd.printText(stdout);
+    char latest[LOG_RECORD_SIZE], previous[LOG_RECORD_SIZE];
+    printf("log latest \"%s\", previous \"%s\"\n", printable(logs.latest, latest), printable(logs.previous, previous));
+    printf("eeprom: %lu reads, %lu writes, %.1f ms busy; lcd: %lu frames\n", (unsigned long)hostEeprom.reads(),
+           (unsigned long)hostEeprom.writes(), hostEeprom.busyMicros() / 1000.0, (unsigned long)hostLcd.frames());
+    if (profile) {
+        char line[96];
+        printf("%s\n", PROFILE_TABLE_HEADER);
+        for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+            profileFormat(i, line, sizeof(line));
+            printf("%s\n", line);
+        }
+    }
+    if (ppmPath != nullptr && !hostLcd.writePpm(ppmPath)) {
+        fprintf(stderr, "cannot write %s\n", ppmPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Holdover under a synthetic temperature profile, through the code the clock runs (holdover.h).
+// A simulated crystal, whose rate error depends on temperature, drives the monotonic counter and a
+// WallClock runs on it. While training, a reference with a few microseconds of noise feeds
+// ClockDiscipline once per second and HoldoverController learns from the locked loop, in the same
+// order as selectClock() in main.cpp. A 10 minute outage every 6 hours makes the controller enter
+// holdover and hand its frequency back to the loop. Then the reference is lost for good and the
+// controller steers the clock from its model. That clock's error against true time is compared with
+// two copies of the clock taken when the reference was lost: one keeping the last locked frequency,
+// one with no frequency correction at all.
+//
+//   g++ -std=c++17 -O2 -I. host/holdover_sim.cpp holdover.cpp clock_discipline.cpp wallclock.cpp leap_seconds.cpp -o holdover_sim
+//   ./holdover_sim [-t training hours] [-h holdover hours] [-r seed] [-v]
+//
+// With less than a minute of training the model has too few samples and the controller falls back
+// to the last locked frequency, so the model and frozen columns match. -v prints every hour.
+// After at least a full day of training (one whole temperature cycle) the model clock's error must
+// stay within HOLDOVER_FLOOR_US plus HOLDOVER_BOUND_PPB of the time spent in holdover, at every
+// second; the exit status is 0 only if it did.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "holdover.h"
+#include "clock_discipline.h"
+
+constexpr int64_t START_EPOCH_US = 1735689600LL * USEC_PER_SEC;    // 2025-01-01
+constexpr uint32_t OUTAGE_EVERY_SEC = 6 * 3600;
+constexpr uint32_t OUTAGE_SEC = 600;
+constexpr double REFERENCE_NOISE_US = 4.0;      // Peak to peak
+constexpr double SENSOR_NOISE_C = 2.0;          // Peak to peak
+constexpr double TWO_PI = 6.283185307179586;
+constexpr double HOLDOVER_BOUND_PPB = 50;       // Average rate error the model may leave (the cubic residue)
+constexpr int64_t HOLDOVER_FLOOR_US = 200;      // Sensor noise turned into rate noise by the model, integrated
+
+uint64_t simNow = 0;
+
+uint64_t monotonicMicros() {
+    return simNow;
+}
+
+// Rate correction the simulated crystal needs: 4 ppm at 25 C, a small linear term, the usual
+// -34 ppb/C^2 tuning-fork parabola and a cubic residue the quadratic model cannot follow
+double oscillatorPpb(double tempC) {
+    double t = tempC - 25.0;
+    return 4000.0 + 60.0 * t - 34.0 * t * t + 0.3 * t * t * t;
+}
+
+// Crystal temperature: daily swing plus a faster HVAC-like cycle
+double temperature(double hours) {
+    return 27.0 + 8.0 * std::sin(TWO_PI * hours / 24.0) + 2.5 * std::sin(TWO_PI * hours / 5.0);
+}
+
+double uniform(uint32_t *state, double span) {
+    *state = *state * 1664525u + 1013904223u;
+    return ((double)(*state >> 8) / 16777216.0 - 0.5) * span;
+}
+
+struct ErrorTrack {
+    double maxMs;
+    double finalMs;
+
+    void add(int64_t errorUs) {
+        finalMs = errorUs / 1000.0;
+        if (std::fabs(finalMs) > maxMs) maxMs = std::fabs(finalMs);
+    }
+};
+
+int main(int argc, char **argv) {
+    double trainHours = 24;
+    double holdoverHours = 24;
+    uint32_t seed = 1;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            trainHours = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-h") == 0 && i + 1 < argc) {
+            holdoverHours = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "usage: holdover_sim [-t training hours] [-h holdover hours] [-r seed] [-v]\n");
+            return 2;
+        }
+    }
+    uint32_t trainSec = (uint32_t)(trainHours * 3600);
+    uint32_t holdoverSec = (uint32_t)(holdoverHours * 3600);
+    if (trainSec < 2 || holdoverSec < 1) {
+        fprintf(stderr, "train for at least 2 s and hold over for at least 1 s\n");
+        return 2;
+    }
+
+    WallClock clock;
+    clock.step(START_EPOCH_US, 0);
+    ClockDiscipline discipline(clock);
+    TempFrequencyModel model;
+    HoldoverController holdover(clock, model);
+    WallClock frozen, raw;
+    ErrorTrack outageError = {}, modelError = {}, frozenError = {}, rawError = {};
+    uint32_t state = seed;
+    double mono = 0;
+    double tempMin = 1e9, tempMax = -1e9;
+    int32_t lockedPpb = 0;
+    uint32_t outsideBound = 0;
+
+    if (verbose) printf("%6s %7s %9s %9s %10s %10s %10s\n", "hour", "temp C", "need ppb", "applied", "model ms",
+                        "frozen ms", "raw ms");
+    for (uint32_t s = 1; s <= trainSec + holdoverSec; s++) {
+        double temp = temperature(s / 3600.0);
+        // The counter runs slow by the correction the crystal needs at this temperature
+        mono += 1e6 * (1.0 - oscillatorPpb(temp) * 1e-9);
+        simNow = (uint64_t)mono;
+        int64_t trueUs = START_EPOCH_US + (int64_t)s * USEC_PER_SEC;
+        bool training = s <= trainSec;
+        bool outage = training && s % OUTAGE_EVERY_SEC >= OUTAGE_EVERY_SEC - OUTAGE_SEC;
+        bool haveReference = training && !outage;
+
+        if (haveReference) {
+            int64_t offset = trueUs + (int64_t)uniform(&state, REFERENCE_NOISE_US) - clock.now(simNow);
+            if (holdover.active()) discipline.seedFrequency(holdover.appliedPpb());
+            discipline.update(offset, simNow);
+            lockedPpb = discipline.frequencyPpb();
+        }
+        holdover.update(haveReference && discipline.locked(), temp + uniform(&state, SENSOR_NOISE_C),
+                        discipline.frequencyPpb(), simNow);
+        clock.rebase(simNow);
+
+        if (s == trainSec) {
+            frozen = clock;
+            raw = clock;
+            raw.setFrequencyPpb(0, simNow);
+        }
+        if (outage) outageError.add(clock.now(simNow) - trueUs);
+        if (s > trainSec) {
+            frozen.rebase(simNow);
+            raw.rebase(simNow);
+            int64_t error = clock.now(simNow) - trueUs;
+            modelError.add(error);
+            int64_t boundUs = HOLDOVER_FLOOR_US + (int64_t)(HOLDOVER_BOUND_PPB * (s - trainSec) / 1000);
+            if (error > boundUs || error < -boundUs) outsideBound++;
+            frozenError.add(frozen.now(simNow) - trueUs);
+            rawError.add(raw.now(simNow) - trueUs);
+            if (temp < tempMin) tempMin = temp;
+            if (temp > tempMax) tempMax = temp;
+        }
+        if (verbose && s % 3600 == 0) {
+            printf("%6u %7.1f %9.0f %9ld %10.2f %10.2f %10.2f%s\n", s / 3600, temp, oscillatorPpb(temp),
+                   (long)(holdover.active() ? holdover.appliedPpb() : discipline.frequencyPpb()),
+                   s > trainSec ? modelError.finalMs : 0.0, s > trainSec ? frozenError.finalMs : 0.0,
+                   s > trainSec ? rawError.finalMs : 0.0, holdover.active() ? "  holdover" : "");
+        }
+    }
+
+    printf("%g h training (%u outages, worst %.3f ms), %g h holdover at %.1f..%.1f C\n", trainHours,
+           (unsigned)(trainSec / OUTAGE_EVERY_SEC), outageError.maxMs, holdoverHours, tempMin, tempMax);
+    printf("model: %lu samples, order %d; holdover entered %lu times, locked at %ld ppb, last applied %ld ppb\n",
+           (unsigned long)model.samples(), model.order(), (unsigned long)holdover.entries(), (long)lockedPpb,
+           (long)holdover.appliedPpb());
+    printf("%-22s %12s %12s\n", "", "max ms", "final ms");
+    printf("%-22s %12.2f %12.2f\n", "temperature model", modelError.maxMs, modelError.finalMs);
+    printf("%-22s %12.2f %12.2f\n", "last locked frequency", frozenError.maxMs, frozenError.finalMs);
+    printf("%-22s %12.2f %12.2f\n", "no correction", rawError.maxMs, rawError.finalMs);
+    if (trainSec < 24 * 3600) return 0;
+    if (outsideBound > 0) {
+        printf("model clock outside %.0f ppb + %ld us for %lu s  FAIL\n", HOLDOVER_BOUND_PPB, (long)HOLDOVER_FLOOR_US,
+               (unsigned long)outsideBound);
+        return 1;
+    }
+    printf("model clock within %.0f ppb + %ld us throughout\n", HOLDOVER_BOUND_PPB, (long)HOLDOVER_FLOOR_US);
+    return 0;
+}
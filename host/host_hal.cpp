@@ -0,0 +1,213 @@
+#include "host_hal.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+constexpr uint32_t LCD_WHITE = 0x00FFFFFF;
+constexpr uint32_t LCD_BLACK = 0x00000000;
+
+void SimClock::advanceTo(uint64_t to) {
+    if (to <= mono) return;
+    if (speedFactor > 0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::micro>((to - mono) / speedFactor));
+    }
+    mono = to;
+}
+
+FramebufferLcd::FramebufferLcd() : rowCount(0), cellWidth(14), cellHeight(20), on(true), clears(0), written(0) {
+    clear();
+    clears = 0;
+    written = 0;
+}
+
+void FramebufferLcd::fill(int x, int y, int w, int h, uint32_t color) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > HAL_LCD_WIDTH) w = HAL_LCD_WIDTH - x;
+    if (y + h > HAL_LCD_HEIGHT) h = HAL_LCD_HEIGHT - y;
+    if (w <= 0 || h <= 0) return;
+    for (int row = y; row < y + h; row++) {
+        uint32_t *p = &pixels[row * HAL_LCD_WIDTH + x];
+        for (int i = 0; i < w; i++) p[i] = color;
+    }
+    written += (uint64_t)w * h;
+}
+
+void FramebufferLcd::clear() {
+    fill(0, 0, HAL_LCD_WIDTH, HAL_LCD_HEIGHT, LCD_WHITE);
+    rowCount = 0;
+    clears++;
+}
+
+void FramebufferLcd::setFont(HalFont font) {
+    cellWidth = font == HAL_FONT_20 ? 14 : 11;
+    cellHeight = font == HAL_FONT_20 ? 20 : 16;
+}
+
+// Centred as the driver's CENTER_MODE does it; text running past the right edge is cut off
+void FramebufferLcd::drawCentered(int y, const char *text) {
+    int length = (int)strlen(text);
+    int x = (HAL_LCD_WIDTH - length * cellWidth) / 2;
+    if (x < 0) x = 0;
+    for (int i = 0; i < length && x + cellWidth <= HAL_LCD_WIDTH; i++, x += cellWidth) {
+        fill(x, y, cellWidth, cellHeight, LCD_WHITE);
+        if (text[i] != ' ') fill(x + 1, y + 2, cellWidth - 2, cellHeight - 4, LCD_BLACK);
+    }
+
+    // A string drawn over another on the same line replaces it
+    int row = 0;
+    while (row < rowCount && rows[row].y != y) row++;
+    if (row == rowCount) {
+        if (rowCount == HOST_LCD_TEXT_ROWS) return;
+        rowCount++;
+        while (row > 0 && rows[row - 1].y > y) {
+            rows[row] = rows[row - 1];
+            row--;
+        }
+        rows[row].y = y;
+    }
+    snprintf(rows[row].text, sizeof(rows[row].text), "%s", text);
+}
+
+void FramebufferLcd::printText(FILE *out) const {
+    if (!on) {
+        fprintf(out, "  (display off)\n");
+        return;
+    }
+    for (int i = 0; i < rowCount; i++) {
+        fprintf(out, "  %3d | %s\n", rows[i].y, rows[i].text);
+    }
+}
+
+bool FramebufferLcd::writePpm(const char *path) const {
+    FILE *out = fopen(path, "wb");
+    if (out == nullptr) return false;
+    fprintf(out, "P6\n%d %d\n255\n", HAL_LCD_WIDTH, HAL_LCD_HEIGHT);
+    for (int i = 0; i < HAL_LCD_WIDTH * HAL_LCD_HEIGHT; i++) {
+        uint32_t c = on ? pixels[i] : LCD_BLACK;
+        uint8_t rgb[3] = {(uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c};
+        fwrite(rgb, 1, 3, out);
+    }
+    return fclose(out) == 0;
+}
+
+FileEeprom::FileEeprom(SimClock &clock)
+    : clock(clock), file(nullptr), present(true), readCount(0), writeCount(0), busyUs(0) {
+    memset(image, 0xFF, sizeof(image));
+}
+
+FileEeprom::~FileEeprom() {
+    if (file != nullptr) fclose(file);
+}
+
+bool FileEeprom::open(const char *path) {
+    if (file != nullptr) fclose(file);
+    memset(image, 0xFF, sizeof(image));
+    file = fopen(path, "r+b");
+    if (file != nullptr) {
+        size_t got = fread(image, 1, sizeof(image), file);
+        if (got < sizeof(image)) {
+            // A short file is an image that was never written that far
+            fseek(file, 0, SEEK_SET);
+            fwrite(image, 1, sizeof(image), file);
+            fflush(file);
+        }
+        return true;
+    }
+    file = fopen(path, "w+b");
+    if (file == nullptr) return false;
+    fwrite(image, 1, sizeof(image), file);
+    fflush(file);
+    return true;
+}
+
+// Device address, then "bytes" more, each 8 bits and an acknowledge, plus start and stop
+void FileEeprom::charge(int bytes, uint32_t extraUs) {
+    uint64_t us = ((uint64_t)(1 + bytes) * 9 + 2) * 1000000 / HOST_I2C_HZ + extraUs;
+    busyUs += us;
+    clock.advance(us);
+}
+
+// Address write, repeated start with the device address again, then the data
+bool FileEeprom::read(unsigned int address, char *data, int size) {
+    if (!present) {
+        charge(0, 0);
+        return false;
+    }
+    charge(2 + 1 + size, 0);
+    for (int i = 0; i < size; i++) {
+        data[i] = (char)image[(address + i) % HOST_EEPROM_SIZE];
+    }
+    readCount++;
+    return true;
+}
+
+bool FileEeprom::write(unsigned int address, const char *data, int size) {
+    if (!present || size > HAL_EEPROM_PAGE_SIZE) {
+        charge(0, 0);
+        return false;
+    }
+    charge(2 + size, HOST_EEPROM_WRITE_CYCLE_US);
+    // The part's address counter wraps within the page
+    unsigned int page = address % HOST_EEPROM_SIZE / HAL_EEPROM_PAGE_SIZE * HAL_EEPROM_PAGE_SIZE;
+    for (int i = 0; i < size; i++) {
+        image[page + (address + i) % HAL_EEPROM_PAGE_SIZE] = (uint8_t)data[i];
+    }
+    if (file != nullptr) {
+        fseek(file, page, SEEK_SET);
+        fwrite(&image[page], 1, HAL_EEPROM_PAGE_SIZE, file);
+        fflush(file);
+    }
+    writeCount++;
+    return true;
+}
+
+bool ButtonScript::load(const char *path) {
+    FILE *in = fopen(path, "r");
+    if (in == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    char line[128];
+    bool ok = true;
+    for (int n = 1; ok && fgets(line, sizeof(line), in); n++) {
+        ok = parseLine(line, n);
+    }
+    fclose(in);
+    return ok;
+}
+
+bool ButtonScript::parseLine(const char *line, int lineNumber) {
+    static const char *const NAMES[INPUT_SOURCE_COUNT] = {"log", "replay", "set", "inc"};
+    char text[128];
+    snprintf(text, sizeof(text), "%s", line);
+    char *comment = strchr(text, '#');
+    if (comment != nullptr) *comment = '\0';
+
+    unsigned long ms, holdMs = 100;
+    char button[16], action[16];
+    int fields = sscanf(text, "%lu %15s %15s %lu", &ms, button, action, &holdMs);
+    if (fields <= 0) return true;   // Blank or comment
+    int source = 0;
+    while (source < INPUT_SOURCE_COUNT && strcmp(button, NAMES[source]) != 0) source++;
+    bool tap = fields >= 3 && strcmp(action, "tap") == 0;
+    bool press = fields >= 3 && strcmp(action, "press") == 0;
+    bool release = fields >= 3 && strcmp(action, "release") == 0;
+    if (source == INPUT_SOURCE_COUNT || !(tap || press || release) || (fields == 4 && !tap)) {
+        fprintf(stderr, "script line %d: expected \"<ms> <log|replay|set|inc> <press|release|tap> [hold_ms]\"\n", lineNumber);
+        return false;
+    }
+
+    // Each edge goes after those at the same time, so equal times keep the script's order
+    auto insert = [this](uint64_t mono, InputSource src, InputEdge edge) {
+        InputEvent event = {mono, src, edge};
+        auto at = std::upper_bound(edges.begin(), edges.end(), event,
+                                   [](const InputEvent &a, const InputEvent &b) { return a.mono < b.mono; });
+        edges.insert(at, event);
+    };
+    uint64_t mono = (uint64_t)ms * 1000;
+    insert(mono, (InputSource)source, release ? INPUT_RELEASED : INPUT_PRESSED);
+    if (tap) insert(mono + (uint64_t)holdMs * 1000, (InputSource)source, INPUT_RELEASED);
+    return true;
+}
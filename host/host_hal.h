@@ -0,0 +1,126 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "hal.h"
+#include "input_events.h"
+
+// The HAL (hal.h) on Linux, for running the application logic off the board.
+// Time is simulated: nothing advances it but the caller, so a run does not depend on the host's
+// speed. The LCD draws into a framebuffer and the EEPROM is a file. Both charge the time the real
+// parts would take to the simulated clock.
+
+// Simulated monotonic clock in microseconds.
+// With a speed of 0 it jumps straight to each time it is advanced to. A speed > 0 also sleeps
+// in real time, "speed" simulated seconds per real second, so the run can be watched.
+class SimClock {
+public:
+    explicit SimClock(double speed = 0) : mono(0), speedFactor(speed) {}
+
+    uint64_t now() const { return mono; }
+    void advanceTo(uint64_t to);     // Never moves backwards
+    void advance(uint64_t us) { advanceTo(mono + us); }
+    void setSpeed(double speed) { speedFactor = speed; }
+
+private:
+    uint64_t mono;
+    double speedFactor;
+};
+
+// LCD framebuffer with the panel's size and one 0x00RRGGBB word per pixel.
+// Glyphs are solid blocks of the font's cell size, so the pixel work is close to the driver's but
+// the text stays readable only through the text rows kept beside the pixels.
+constexpr int HOST_LCD_TEXT_ROWS = 24;
+constexpr int HOST_LCD_TEXT_SIZE = 32;
+
+class FramebufferLcd : public HalLcd {
+public:
+    FramebufferLcd();
+
+    void clear() override;
+    void setFont(HalFont font) override;
+    void drawCentered(int y, const char *text) override;
+    int line(int n) const override { return n * cellHeight; }
+    void displayOn() override { on = true; }
+    void displayOff() override { on = false; }
+
+    bool isOn() const { return on; }
+    uint32_t pixel(int x, int y) const { return pixels[y * HAL_LCD_WIDTH + x]; }
+    void printText(FILE *out) const;            // The strings on screen, top to bottom
+    bool writePpm(const char *path) const;      // The framebuffer as a binary PPM image
+    uint32_t frames() const { return clears; }  // Screens drawn (each starts with a clear)
+    uint64_t pixelsWritten() const { return written; }
+
+private:
+    struct TextRow {
+        int y;
+        char text[HOST_LCD_TEXT_SIZE];
+    };
+    void fill(int x, int y, int w, int h, uint32_t color);
+
+    uint32_t pixels[HAL_LCD_WIDTH * HAL_LCD_HEIGHT];
+    TextRow rows[HOST_LCD_TEXT_ROWS];
+    int rowCount;
+    int cellWidth;
+    int cellHeight;
+    bool on;
+    uint32_t clears;
+    uint64_t written;
+};
+
+// 24-series EEPROM behind a 100 kHz I2C bus, kept in a file (or only in memory without one).
+// Writes wrap within their page as on the part. Every transfer charges its bus time (9 bit times
+// per byte plus start and stop) to the clock, and a write also charges the internal write cycle.
+constexpr unsigned int HOST_EEPROM_SIZE = 32768;        // 24LC256
+constexpr uint32_t HOST_I2C_HZ = 100000;
+constexpr uint32_t HOST_EEPROM_WRITE_CYCLE_US = 5000;   // Typical; the board driver allows 6 ms
+
+class FileEeprom : public HalEeprom {
+public:
+    explicit FileEeprom(SimClock &clock);
+    ~FileEeprom();
+
+    // Load the image from "path" (erased if the file does not exist) and write changes back to it.
+    // Returns false if the file cannot be created.
+    bool open(const char *path);
+
+    bool read(unsigned int address, char *data, int size) override;
+    bool write(unsigned int address, const char *data, int size) override;
+
+    void setPresent(bool present) { this->present = present; }   // An absent part never acknowledges
+    uint32_t reads() const { return readCount; }
+    uint32_t writes() const { return writeCount; }
+    uint64_t busyMicros() const { return busyUs; }     // Simulated bus and write-cycle time so far
+
+private:
+    void charge(int bytes, uint32_t extraUs);
+
+    SimClock &clock;
+    uint8_t image[HOST_EEPROM_SIZE];
+    FILE *file;
+    bool present;
+    uint32_t readCount;
+    uint32_t writeCount;
+    uint64_t busyUs;
+};
+
+// Button presses from a text file, one per line:
+//   <ms> <log|replay|set|inc> <press|release|tap> [hold_ms]
+// "tap" is a press and a release "hold_ms" later (100 ms if omitted). Times are from the start of
+// the run; '#' starts a comment. The edges come out sorted, as the debouncer would deliver them.
+class ButtonScript {
+public:
+    // Returns false, naming the line on stderr, if the file cannot be read or a line is malformed
+    bool load(const char *path);
+    bool parseLine(const char *line, int lineNumber);
+
+    int count() const { return (int)edges.size(); }
+    const InputEvent &edge(int i) const { return edges[i]; }
+
+private:
+    std::vector<InputEvent> edges;
+};
+
+#endif // HOST_HAL_H
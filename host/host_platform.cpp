@@ -0,0 +1,114 @@
+#include "host_platform.h"
+#include <cstring>
+#include "app.h"
+#include "screens.h"
+
+SimClock hostClock;
+FramebufferLcd hostLcd;
+FileEeprom hostEeprom(hostClock);
+LeapTable leapTable;
+WallClock wallClock;
+TimeSnapshotLatch timeSnapshot;
+SyncStats syncStats;
+bool hostSyncStatsPage = false;
+bool hostRepeatArmed = false;
+uint64_t hostRepeatDue = 0;
+
+StorageLogs logCache;
+
+uint64_t monotonicMicros() {
+    return hostClock.now();
+}
+
+bool hostLoadLogs() {
+    logCache.ok = hostEeprom.read(LOG_LATEST_ADDR, logCache.latest, LOG_RECORD_SIZE) &&
+                  hostEeprom.read(LOG_PREVIOUS_ADDR, logCache.previous, LOG_RECORD_SIZE);
+    logCache.latest[LOG_RECORD_SIZE - 1] = '\0';
+    logCache.previous[LOG_RECORD_SIZE - 1] = '\0';
+    return logCache.ok;
+}
+
+const StorageLogs &hostLogs() {
+    return logCache;
+}
+
+void publishTimeSnapshot() {
+    uint64_t mono = monotonicMicros();
+    timeSnapshot.publish(mono, wallClock.utc(mono));
+}
+
+uint64_t nextSecondTick() {
+    uint64_t mono = monotonicMicros();
+    int64_t intoSecond = wallClock.utc(mono) % USEC_PER_SEC;
+    return mono + (USEC_PER_SEC - intoSecond) + 1000;
+}
+
+void onSecondTick() {
+    publishTimeSnapshot();
+    if (!hostLcd.isOn()) return;
+    if (state == IDLE) {
+        updateDisplay();
+    } else if (state == SYNC_STATS) {
+        displaySyncStats();
+    }
+}
+
+void updateDisplay() {
+    TimeSnapshot now;
+    if (!timeSnapshot.read(&now)) return;
+    drawClockFace(hostLcd, now.fields, nullptr);
+}
+
+void updateSetTimeDisplay() {
+    drawSetTime(hostLcd, editBuffer, currentEditPos);
+}
+
+// Answered from RAM as on the board, so only the drawing costs anything
+void displayLogs() {
+    if (state != DISPLAY_LOG) return;
+    drawLogs(hostLcd, logCache.latest, logCache.previous);
+}
+
+void displaySyncStats() {
+    drawSyncStats(hostLcd, syncStats);
+}
+
+// Same rule as the storage worker: an empty latest slot has nothing to move down
+void storeCurrentTime() {
+    TimeSnapshot now;
+    if (!timeSnapshot.read(&now)) return;
+    char record[LOG_RECORD_SIZE];
+    formatLogRecord(now.fields, record);
+    bool ok = true;
+    if (logCache.latest[0] != '\0') {
+        memcpy(logCache.previous, logCache.latest, LOG_RECORD_SIZE);
+        ok = hostEeprom.write(LOG_PREVIOUS_ADDR, logCache.previous, LOG_RECORD_SIZE) && ok;
+    }
+    memcpy(logCache.latest, record, LOG_RECORD_SIZE);
+    ok = hostEeprom.write(LOG_LATEST_ADDR, logCache.latest, LOG_RECORD_SIZE) && ok;
+    logCache.ok = ok;
+}
+
+bool syncStatsPageEnabled() {
+    return hostSyncStatsPage;
+}
+
+time_t currentTime() {
+    return (time_t)(wallClock.utc() / USEC_PER_SEC);
+}
+
+void setSystemTime(time_t t) {
+    wallClock.step(leapTable.toContinuous((int64_t)t * USEC_PER_SEC), monotonicMicros());
+    publishTimeSnapshot();
+}
+
+void appStateChanged(int, int) {}
+
+void armEditRepeat(uint64_t due) {
+    hostRepeatArmed = true;
+    hostRepeatDue = due;
+}
+
+void cancelEditRepeat() {
+    hostRepeatArmed = false;
+}
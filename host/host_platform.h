@@ -0,0 +1,36 @@
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#include "host_hal.h"
+#include "log_records.h"
+#include "wallclock.h"
+#include "leap_seconds.h"
+#include "time_snapshot.h"
+#include "sync_stats.h"
+
+// The application's platform hooks (app.h) on the host HAL, implemented as main.cpp does on the
+// board: the clock face is drawn from the time snapshot published every second, and the log is
+// two records on the EEPROM, kept in RAM once loaded.
+// Unlike the storage thread, every append writes through at once, so a log press costs its
+// EEPROM time on the spot.
+
+extern SimClock hostClock;
+extern FramebufferLcd hostLcd;
+extern FileEeprom hostEeprom;
+extern LeapTable leapTable;
+extern WallClock wallClock;
+extern TimeSnapshotLatch timeSnapshot;
+extern SyncStats syncStats;
+extern bool hostSyncStatsPage;      // Build with the sync statistics page (SHOW_SYNC_STATS_PAGE)
+extern bool hostRepeatArmed;        // Edit repeat requested through armEditRepeat
+extern uint64_t hostRepeatDue;
+
+// Read both records into RAM (the storage worker does this when it starts)
+bool hostLoadLogs();
+const StorageLogs &hostLogs();
+
+void publishTimeSnapshot();         // Publish the wall-clock time as of now
+uint64_t nextSecondTick();          // Monotonic time of the next tick, 1 ms after the next UTC second
+void onSecondTick();                // Publish the new second and redraw the page that shows it
+
+#endif // HOST_PLATFORM_H
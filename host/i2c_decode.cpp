@@ -0,0 +1,181 @@
+// Decodes an I2C trace dump (console command "i2c trace") into latency breakdowns.
+// Phases are put back together into transactions: a write, and the read that followed it if the
+// transaction asked for data. For each client the decoder reports the queue wait, write, read
+// and total time (median, p99 and max), the bus time per byte and the failures, then lists
+// every phase that was not acknowledged.
+//
+//   g++ -std=c++17 -O2 -I. host/i2c_decode.cpp i2c_trace.cpp -o i2c_decode
+//   ./i2c_decode [-v] dump.txt
+//
+// -v also prints every transaction.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "i2c_trace.h"
+
+constexpr int MAX_CLIENTS = 16;
+
+struct Transaction {
+    const I2cTraceEntry *write;     // Either may be missing
+    const I2cTraceEntry *read;
+};
+
+typedef std::vector<uint32_t> Samples;
+
+struct ClientReport {
+    Samples wait;
+    Samples writeUs;
+    Samples readUs;
+    Samples totalUs;
+    Samples nsPerByte;
+    uint32_t transactions;
+    uint32_t failures;
+    uint64_t bytes;
+    uint64_t busUs;
+};
+
+char clientNames[MAX_CLIENTS][24];
+
+const char *clientName(int client) {
+    if (client < MAX_CLIENTS && clientNames[client][0] != '\0') return clientNames[client];
+    static char unnamed[16];
+    snprintf(unnamed, sizeof(unnamed), "client%d", client);
+    return unnamed;
+}
+
+// Nearest-rank percentile of sorted samples
+uint32_t percentile(const Samples &sorted, double p) {
+    size_t rank = (size_t)(p / 100.0 * sorted.size() + 0.5);
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+void printRow(const char *label, Samples &h) {
+    if (h.empty()) return;
+    std::sort(h.begin(), h.end());
+    printf("  %-12s %8zu %10lu %10lu %10lu\n", label, h.size(), (unsigned long)percentile(h, 50),
+           (unsigned long)percentile(h, 99), (unsigned long)h.back());
+}
+
+int main(int argc, char **argv) {
+    bool verbose = false;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    FILE *in = path ? fopen(path, "r") : stdin;
+    if (in == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+
+    // Lines around the dump (prompts, other output) are skipped; a later dump replaces an earlier one
+    std::vector<I2cTraceEntry> phases;
+    unsigned long lost = 0;
+    bool inDump = false;
+    char line[128];
+    while (fgets(line, sizeof(line), in)) {
+        int count, client;
+        char name[24];
+        I2cTraceEntry e;
+        if (sscanf(line, "i2ctrace begin %d %lu", &count, &lost) == 2) {
+            phases.clear();
+            inDump = true;
+        } else if (strncmp(line, "i2ctrace end", 12) == 0) {
+            inDump = false;
+        } else if (inDump && sscanf(line, "client %d %23s", &client, name) == 2) {
+            if (client >= 0 && client < MAX_CLIENTS) snprintf(clientNames[client], sizeof(clientNames[client]), "%s", name);
+        } else if (inDump && I2cTrace::parse(line, &e)) {
+            phases.push_back(e);
+        }
+    }
+    if (in != stdin) fclose(in);
+    if (phases.empty()) {
+        fprintf(stderr, "no i2c trace found\n");
+        return 2;
+    }
+
+    // A read right after a write by the same client to the same device, without a wait of its own,
+    // is the second phase of that write's transaction
+    std::vector<Transaction> transactions;
+    for (size_t i = 0; i < phases.size(); i++) {
+        const I2cTraceEntry &p = phases[i];
+        if (p.direction == 'R' && p.waitUs == 0 && !transactions.empty()) {
+            Transaction &last = transactions.back();
+            if (last.write != nullptr && last.read == nullptr && last.write->client == p.client &&
+                last.write->address == p.address) {
+                last.read = &p;
+                continue;
+            }
+        }
+        Transaction t = {p.direction == 'W' ? &p : nullptr, p.direction == 'R' ? &p : nullptr};
+        transactions.push_back(t);
+    }
+
+    static ClientReport reports[MAX_CLIENTS];
+    int failures = 0;
+    uint64_t busUs = 0;
+    for (const Transaction &t : transactions) {
+        const I2cTraceEntry *first = t.write ? t.write : t.read;
+        const I2cTraceEntry *last = t.read ? t.read : t.write;
+        if (first->client >= MAX_CLIENTS) continue;
+        ClientReport &r = reports[first->client];
+        r.transactions++;
+        r.wait.push_back(first->waitUs);
+        uint32_t total = first->waitUs + (uint32_t)(last->start + last->durationUs - first->start);
+        r.totalUs.push_back(total);
+        bool failed = false;
+        for (const I2cTraceEntry *p : {t.write, t.read}) {
+            if (p == nullptr) continue;
+            (p->direction == 'W' ? r.writeUs : r.readUs).push_back(p->durationUs);
+            r.bytes += p->length;
+            r.busUs += p->durationUs;
+            busUs += p->durationUs;
+            // The address byte goes on the bus as well
+            r.nsPerByte.push_back((uint32_t)((uint64_t)p->durationUs * 1000 / (p->length + 1u)));
+            failed = failed || p->result != 0;
+        }
+        if (failed) r.failures++;
+        if (verbose) {
+            printf("%12llu %-8s %02x wait %6lu", (unsigned long long)first->start, clientName(first->client),
+                   (unsigned)first->address, (unsigned long)first->waitUs);
+            if (t.write) printf("  W%-3u %6lu us", (unsigned)t.write->length, (unsigned long)t.write->durationUs);
+            if (t.read) printf("  R%-3u %6lu us", (unsigned)t.read->length, (unsigned long)t.read->durationUs);
+            printf("  total %6lu us%s\n", (unsigned long)total, failed ? "  NACK" : "");
+        }
+    }
+
+    const I2cTraceEntry &oldest = phases.front();
+    const I2cTraceEntry &newest = phases.back();
+    uint64_t span = newest.start + newest.durationUs - oldest.start;
+    printf("%zu phases in %zu transactions over %.3f s, bus busy %.2f%%%s\n", phases.size(), transactions.size(),
+           span / 1e6, span ? 100.0 * busUs / span : 0.0, lost ? " (older phases were overwritten)" : "");
+    for (int c = 0; c < MAX_CLIENTS; c++) {
+        ClientReport &r = reports[c];
+        if (r.transactions == 0) continue;
+        printf("\n%s: %lu transactions, %lu failed, %llu bytes, %.1f ms on the bus\n", clientName(c),
+               (unsigned long)r.transactions, (unsigned long)r.failures, (unsigned long long)r.bytes, r.busUs / 1000.0);
+        printf("  %-12s %8s %10s %10s %10s\n", "us", "count", "median", "p99", "max");
+        printRow("queue wait", r.wait);
+        printRow("write", r.writeUs);
+        printRow("read", r.readUs);
+        printRow("total", r.totalUs);
+        std::sort(r.nsPerByte.begin(), r.nsPerByte.end());
+        uint32_t perByte = percentile(r.nsPerByte, 50);
+        if (perByte > 0) printf("  median %.1f us per byte (%.0f kHz at 9 bit times per byte)\n", perByte / 1000.0, 9e6 / perByte);
+    }
+
+    for (const I2cTraceEntry &p : phases) {
+        if (p.result == 0) continue;
+        if (failures++ == 0) printf("\nnot acknowledged:\n");
+        printf("  %12llu %-8s %02x %c%-3u result %d after %lu us\n", (unsigned long long)p.start, clientName(p.client),
+               (unsigned)p.address, p.direction, (unsigned)p.length, (int)p.result, (unsigned long)p.durationUs);
+    }
+    return 0;
+}
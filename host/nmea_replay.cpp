@@ -0,0 +1,414 @@
+// Replays an NMEA recording through a pseudo-terminal into the zero-copy parser (nmea.h).
+// The recording is written to the pty master and read back from the raw-mode slave into a ring the
+// size of the GPS DMA buffer, as the DMA engine would fill it, and the parser walks the ring in
+// place. Every line is also checked on its own by a plain checksum check, and the parser's
+// accepted, checksum-error and overlong counts must match it. Each RMC and ZDA sentence the check
+// accepts is also decoded on its own with timegm, and the parser must report the same sentences, in
+// order, with the same start position and epoch second. The parser's own time is measured around
+// poll() and reported as sentences and megabytes per second.
+//
+// A second run feeds a minute of generated output into the ring at 9600 baud on a simulated clock,
+// with a PPS edge at the start of every second, and pairs the sentences with PpsPairing as
+// pollTimeSources() in main.cpp does. One edge comes after its second's sentences (late), one is
+// missing, and one is missing after a second the receiver sent nothing. Every other second must pair
+// exactly once with its own edge and epoch; the impaired ones must not pair at all.
+//
+//   g++ -std=c++17 -O2 -I. host/nmea_replay.cpp nmea.cpp -o nmea_replay
+//   ./nmea_replay [-n passes] [-e every] [recording.nmea]
+//
+// Without a recording, an hour of a typical receiver's output is generated (GGA, GSA, three GSV,
+// RMC and ZDA each second). -e corrupts one byte in every "every"-th sentence (default 50, 0 for
+// none), so rejected checksums are exercised too. -n replays the stream that many times for timing.
+// The exit status is 0 only if the counts and times matched on every pass and the pairing run passed.
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <ctime>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+#include "nmea.h"
+
+constexpr size_t RING_SIZE = 512;        // GPS_DMA_BUFFER_SIZE
+constexpr size_t READ_CHUNK = 128;       // At most this much arrives between two polls
+constexpr int64_t GENERATED_EPOCH = 1749988800;    // 2025-06-15 12:00:00, the first generated second
+constexpr uint32_t BYTE_US = 10 * 1000000 / 9600;  // GPS_BAUD, as main.cpp sets up PpsPairing
+constexpr uint64_t POLL_US = 100000;               // pollTimeSources() period
+constexpr uint64_t OUTPUT_DELAY_US = 20000;        // The receiver starts a second's sentences this long after its pulse
+constexpr uint64_t LATE_EDGE_US = 900000;          // The late pulse comes after all its second's sentences
+constexpr int PPS_SECONDS = 60;
+constexpr int LATE_SECOND = 20;
+constexpr int MISSING_SECOND = 35;
+constexpr int SILENT_SECOND = 49;                  // No sentences, and the next pulse is missing
+
+struct Counts {
+    uint32_t sentences;
+    uint32_t checksumErrors;
+    uint32_t overlong;
+};
+
+// One sentence with its checksum and CR LF
+std::string sentence(const char *body) {
+    uint8_t sum = 0;
+    for (const char *p = body; *p; p++) sum ^= (uint8_t)*p;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+    return std::string("$") + body + tail;
+}
+
+// What a typical receiver sends for second "s" after 12:00:00
+std::string secondOutput(int s) {
+    std::string out;
+    char body[96];
+    int hh = 12 + s / 3600, mm = s / 60 % 60, ss = s % 60;
+    snprintf(body, sizeof(body), "GPGGA,%02d%02d%02d.00,4807.03812,N,01131.00022,E,1,09,0.92,545.4,M,46.9,M,,", hh, mm, ss);
+    out += sentence(body);
+    out += sentence("GPGSA,A,3,04,05,09,12,24,25,29,31,,,,,1.72,0.92,1.46");
+    out += sentence("GPGSV,3,1,11,04,40,287,44,05,24,045,39,09,61,117,47,12,34,303,41");
+    out += sentence("GPGSV,3,2,11,24,12,132,33,25,68,231,48,29,22,181,36,31,15,076,30");
+    out += sentence("GPGSV,3,3,11,02,03,338,,14,05,212,,32,01,009,");
+    snprintf(body, sizeof(body), "GPRMC,%02d%02d%02d.00,A,4807.03812,N,01131.00022,E,0.021,,150625,,,A", hh, mm, ss);
+    out += sentence(body);
+    snprintf(body, sizeof(body), "GPZDA,%02d%02d%02d.00,15,06,2025,00,00", hh, mm, ss);
+    out += sentence(body);
+    return out;
+}
+
+std::string generateRecording(int seconds) {
+    std::string out;
+    for (int s = 0; s < seconds; s++) out += secondOutput(s);
+    return out;
+}
+
+// Flips the lowest bit of one field byte in every "every"-th sentence
+void corrupt(std::string &stream, int every) {
+    int n = 0;
+    for (size_t i = 0; i < stream.size(); i++) {
+        if (stream[i] != '$' || every <= 0 || ++n % every != 0) continue;
+        size_t comma = stream.find(',', i);
+        if (comma != std::string::npos && comma + 1 < stream.size() && stream[comma + 1] != ',' &&
+            stream[comma + 1] != '*') {
+            stream[comma + 1] ^= 0x01;
+        }
+    }
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// Reads "count" decimal digits of "field" from "offset"
+bool digits(const std::string &field, size_t offset, size_t count, int *value) {
+    if (field.size() < offset + count) return false;
+    for (size_t i = offset; i < offset + count; i++) {
+        if (field[i] < '0' || field[i] > '9') return false;
+    }
+    *value = atoi(field.substr(offset, count).c_str());
+    return true;
+}
+
+// The time an accepted sentence (from '$' to '*') should decode to, worked out apart from the parser.
+// Returns false for other sentences and for time sentences the parser must not report.
+bool referenceTime(const std::string &stream, size_t pos, size_t star, NmeaTime *out) {
+    std::vector<std::string> f;
+    size_t start = pos + 1;
+    while (true) {
+        size_t comma = stream.find(',', start);
+        if (comma == std::string::npos || comma > star) comma = star;
+        f.push_back(stream.substr(start, comma - start));
+        if (comma == star) break;
+        start = comma + 1;
+    }
+    if (f[0].size() != 5 || f.size() < 2) return false;
+    struct tm t = {};
+    std::string name = f[0].substr(2);
+    if (!digits(f[1], 0, 2, &t.tm_hour) || !digits(f[1], 2, 2, &t.tm_min) || !digits(f[1], 4, 2, &t.tm_sec)) {
+        return false;
+    }
+    if (t.tm_hour > 23 || t.tm_min > 59 || t.tm_sec > 60) return false;
+    int year;
+    if (name == "RMC" && f.size() >= 10) {
+        if (!digits(f[9], 0, 2, &t.tm_mday) || !digits(f[9], 2, 2, &t.tm_mon) || !digits(f[9], 4, 2, &year)) return false;
+        year += 2000;
+        out->type = NMEA_RMC;
+        out->valid = f[2] == "A";
+    } else if (name == "ZDA" && f.size() >= 5) {
+        if (!digits(f[2], 0, 2, &t.tm_mday) || !digits(f[3], 0, 2, &t.tm_mon) || !digits(f[4], 0, 4, &year)) return false;
+        out->type = NMEA_ZDA;
+        out->valid = true;
+    } else {
+        return false;
+    }
+    if (t.tm_mon < 1 || t.tm_mon > 12 || t.tm_mday < 1 || t.tm_mday > 31) return false;
+    t.tm_mon -= 1;
+    t.tm_year = year - 1900;
+    out->epochSec = (int64_t)timegm(&t);
+    out->startPos = pos;
+    return true;
+}
+
+// What the parser should count, worked out line by line: a sentence runs from '$' to the byte
+// after the two checksum digits and may be at most NMEA_MAX_SENTENCE bytes long. The times of the
+// accepted RMC and ZDA sentences go to "times".
+Counts expectedCounts(const std::string &stream, std::vector<NmeaTime> *times) {
+    Counts c = {0, 0, 0};
+    size_t pos = 0;
+    while ((pos = stream.find('$', pos)) != std::string::npos) {
+        size_t end = stream.find_first_of("$\r\n", pos + 1);
+        if (end == std::string::npos) break;                // Cut off at the end of the recording
+        if (stream[end] == '$') {                             // Restarted before it ended
+            pos = end;
+            continue;
+        }
+        size_t star = stream.find('*', pos);
+        bool hasSum = star != std::string::npos && star < end;
+        size_t last = end;
+        if (hasSum) {
+            // The checksum ends at the first byte that is not one of its two hex digits
+            size_t digits = 0;
+            while (star + 1 + digits < end && digits < 2 && hexDigit(stream[star + 1 + digits]) >= 0) digits++;
+            last = star + 1 + digits;
+        }
+        if (last - pos >= NMEA_MAX_SENTENCE) {
+            c.overlong++;
+        } else if (!hasSum || last - star != 3) {
+            c.checksumErrors++;
+        } else {
+            uint8_t sum = 0;
+            for (size_t i = pos + 1; i < star; i++) sum ^= (uint8_t)stream[i];
+            int received = hexDigit(stream[star + 1]) * 16 + hexDigit(stream[star + 2]);
+            if (received == sum) {
+                c.sentences++;
+                NmeaTime time;
+                if (referenceTime(stream, pos, star, &time)) times->push_back(time);
+            } else {
+                c.checksumErrors++;
+            }
+        }
+        pos = end;
+    }
+    return c;
+}
+
+bool readFile(const char *path, std::string *out) {
+    FILE *in = fopen(path, "rb");
+    if (in == nullptr) return false;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) out->append(buffer, n);
+    fclose(in);
+    return true;
+}
+
+struct PassResult {
+    Counts counts;
+    uint32_t times;          // RMC and ZDA sentences decoded
+    uint32_t wrongTimes;     // Decoded times that differ from the reference, or are missing or extra
+    double parseNs;
+    double wallNs;
+};
+
+bool replayPass(const std::string &stream, const std::vector<NmeaTime> &want, int master, int slave,
+                PassResult *result) {
+    static uint8_t ring[RING_SIZE];
+    NmeaParser parser(ring, RING_SIZE);
+    size_t written = 0, received = 0;
+    uint32_t times = 0, wrong = 0;
+    double parseNs = 0;
+    auto begin = std::chrono::steady_clock::now();
+    while (received < stream.size()) {
+        if (written < stream.size()) {
+            ssize_t n = write(master, stream.data() + written, stream.size() - written);
+            if (n > 0) written += n;
+        }
+        // Read into the ring where the DMA engine would be writing, without wrapping in one call
+        size_t at = received % RING_SIZE;
+        size_t room = RING_SIZE - at < READ_CHUNK ? RING_SIZE - at : READ_CHUNK;
+        ssize_t n = read(slave, ring + at, room);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            perror("read");
+            return false;
+        }
+        if (n <= 0) continue;
+        received += n;
+
+        auto parseBegin = std::chrono::steady_clock::now();
+        NmeaTime time;
+        size_t first = times;
+        NmeaTime decoded[READ_CHUNK];
+        while (parser.poll(received % RING_SIZE, &time)) decoded[times++ - first] = time;
+        parseNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - parseBegin).count();
+        // Checked outside the timed part
+        for (size_t i = first; i < times; i++) {
+            const NmeaTime &got = decoded[i - first];
+            if (i >= want.size() || got.type != want[i].type || got.epochSec != want[i].epochSec ||
+                got.valid != want[i].valid || got.startPos != want[i].startPos) {
+                wrong++;
+            }
+        }
+    }
+    if (times < want.size()) wrong += (uint32_t)(want.size() - times);
+    result->wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    result->parseNs = parseNs;
+    result->times = times;
+    result->wrongTimes = wrong;
+    result->counts.sentences = parser.sentences();
+    result->counts.checksumErrors = parser.checksumErrors();
+    result->counts.overlong = parser.overlongErrors();
+    return true;
+}
+
+// Feeds PPS_SECONDS of generated output into the ring on a simulated clock, with one PPS edge per
+// second, and pairs it as pollTimeSources() does. Returns the number of failed checks.
+int ppsRun() {
+    static uint8_t ring[RING_SIZE];
+    NmeaParser parser(ring, RING_SIZE);
+    PpsPairing pairing(BYTE_US, RING_SIZE);
+    std::string stream;
+    std::vector<uint64_t> byteMono;     // When each byte has been received in full
+    std::vector<uint64_t> edgeMono(PPS_SECONDS, 0);
+    for (int s = 0; s < PPS_SECONDS; s++) {
+        uint64_t pulse = (uint64_t)(s + 1) * 1000000;
+        edgeMono[s] = s == LATE_SECOND ? pulse + LATE_EDGE_US : pulse;
+        if (s == MISSING_SECOND || s == SILENT_SECOND + 1) edgeMono[s] = 0;
+        if (s == SILENT_SECOND) continue;
+        std::string output = secondOutput(s);
+        for (size_t i = 0; i < output.size(); i++) byteMono.push_back(pulse + OUTPUT_DELAY_US + (i + 1) * BYTE_US);
+        stream += output;
+    }
+
+    std::vector<int> pairs(PPS_SECONDS, 0);
+    int failures = 0;
+    size_t next = 0;
+    int nextEdge = 0;
+    uint64_t end = (uint64_t)(PPS_SECONDS + 1) * 1000000;
+    for (uint64_t now = POLL_US; now <= end; now += POLL_US) {
+        // Bytes land in the ring and edges latch the write index in the order they happen
+        while (true) {
+            while (nextEdge < PPS_SECONDS && edgeMono[nextEdge] == 0) nextEdge++;
+            bool byteDue = next < stream.size() && byteMono[next] <= now;
+            bool edgeDue = nextEdge < PPS_SECONDS && edgeMono[nextEdge] <= now;
+            if (edgeDue && (!byteDue || edgeMono[nextEdge] <= byteMono[next])) {
+                pairing.onPps(edgeMono[nextEdge++], next % RING_SIZE);
+            } else if (byteDue) {
+                ring[next % RING_SIZE] = (uint8_t)stream[next];
+                next++;
+            } else {
+                break;
+            }
+        }
+        size_t writeIndex = next % RING_SIZE;
+        pairing.locate(parser.streamPosition(writeIndex), now);
+        NmeaTime time;
+        while (parser.poll(writeIndex, &time)) {
+            int64_t refEpochUs;
+            uint64_t refMono;
+            if (!pairing.pair(time, &refEpochUs, &refMono)) continue;
+            int s = (int)(time.epochSec - GENERATED_EPOCH);
+            if (s < 0 || s >= PPS_SECONDS || refMono != edgeMono[s] || refEpochUs != time.epochSec * 1000000) {
+                printf("pps: second %d paired with edge at %.6f s  FAIL\n", s, refMono / 1e6);
+                failures++;
+                continue;
+            }
+            pairs[s]++;
+        }
+    }
+
+    int paired = 0;
+    for (int s = 0; s < PPS_SECONDS; s++) {
+        bool impaired = s == LATE_SECOND || s == MISSING_SECOND || s == SILENT_SECOND || s == SILENT_SECOND + 1;
+        if (pairs[s] != (impaired ? 0 : 1)) {
+            printf("pps: second %d paired %d times, expected %d  FAIL\n", s, pairs[s], impaired ? 0 : 1);
+            failures++;
+        }
+        paired += pairs[s];
+    }
+    if (pairing.unplacedEdges() != 0) failures++;
+    printf("pps: %d s, %d paired; late edge, missing edge and missing edge after a silent second unpaired; "
+           "%lu unplaced edges%s\n", PPS_SECONDS, paired, (unsigned long)pairing.unplacedEdges(),
+           failures ? "  FAIL" : "");
+    return failures;
+}
+
+// A pty pair with the slave in raw mode, so bytes come through without line-discipline changes
+bool openPty(int *master, int *slave) {
+    *master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (*master < 0 || grantpt(*master) != 0 || unlockpt(*master) != 0) return false;
+    *slave = open(ptsname(*master), O_RDWR | O_NOCTTY);
+    if (*slave < 0) return false;
+    struct termios tio;
+    tcgetattr(*slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(*slave, TCSANOW, &tio);
+    fcntl(*master, F_SETFL, fcntl(*master, F_GETFL) | O_NONBLOCK);
+    fcntl(*slave, F_SETFL, fcntl(*slave, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int passes = 5;
+    int corruptEvery = 50;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            passes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            corruptEvery = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: nmea_replay [-n passes] [-e every] [recording.nmea]\n");
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (passes < 1) passes = 1;
+
+    std::string stream;
+    if (path != nullptr) {
+        if (!readFile(path, &stream)) {
+            fprintf(stderr, "cannot open %s\n", path);
+            return 2;
+        }
+    } else {
+        stream = generateRecording(3600);
+    }
+    corrupt(stream, corruptEvery);
+    std::vector<NmeaTime> wantTimes;
+    Counts want = expectedCounts(stream, &wantTimes);
+
+    int master, slave;
+    if (!openPty(&master, &slave)) {
+        perror("pty");
+        return 2;
+    }
+
+    printf("%zu bytes: %lu sentences, %lu checksum errors, %lu overlong, %zu times expected\n", stream.size(),
+           (unsigned long)want.sentences, (unsigned long)want.checksumErrors, (unsigned long)want.overlong,
+           wantTimes.size());
+    int mismatches = 0;
+    for (int p = 0; p < passes; p++) {
+        PassResult r;
+        if (!replayPass(stream, wantTimes, master, slave, &r)) return 2;
+        bool match = r.counts.sentences == want.sentences && r.counts.checksumErrors == want.checksumErrors &&
+                     r.counts.overlong == want.overlong && r.wrongTimes == 0;
+        if (!match) mismatches++;
+        printf("pass %d: %lu sentences, %lu checksum errors, %lu overlong, %lu times (%lu wrong); parser %.0f "
+               "sentences/s, %.1f MB/s, %.1f ns/byte; through the pty %.0f sentences/s%s\n", p + 1,
+               (unsigned long)r.counts.sentences, (unsigned long)r.counts.checksumErrors, (unsigned long)r.counts.overlong,
+               (unsigned long)r.times, (unsigned long)r.wrongTimes, r.counts.sentences * 1e9 / r.parseNs,
+               stream.size() * 1e3 / r.parseNs,
+               r.parseNs / stream.size(), r.counts.sentences * 1e9 / r.wallNs, match ? "" : "  MISMATCH");
+    }
+    close(slave);
+    close(master);
+    mismatches += ppsRun();
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,295 @@
+// Host replay of an input trace recorded on the clock (console command "trace").
+// The application logic (app.cpp) runs unchanged against the hooks below, under simulated time:
+// clock reads by the application return the recorded values, other reads count on from the trace's
+// anchors, and the hold-to-repeat timer fires exactly when due.
+// Every input and platform event is fed in at its recorded time, and the state transitions and
+// entered times this produces are compared with the recorded ones. Nothing depends on the host's
+// clock or speed, so a trace replays identically every time and doubles as a benchmark.
+//
+//   g++ -std=c++17 -O2 -I. host/replay.cpp app.cpp input_trace.cpp auto_repeat.cpp event_task.cpp -o replay
+//   ./replay [-s] [-n runs] [-v] trace.txt
+//
+// -s replays a SHOW_SYNC_STATS_PAGE build, -n repeats the replay for timing, -v prints every
+// transition. The exit status is 0 only if every run matched the recording.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "app.h"
+#include "input_trace.h"
+#include "civil_time.h"
+
+// Simulated platform
+uint64_t simMono = 0;
+uint64_t anchorMono = 0;        // Start of the UTC second "anchorSec"
+uint32_t anchorSec = 0;
+std::vector<uint32_t> clockReads;   // Recorded reads for the input being handled, in order
+size_t nextClockRead = 0;
+bool repeatArmed = false;
+uint64_t repeatDue = 0;
+bool syncStatsPage = false;
+char logLatest[TIME_STR_SIZE];
+char logPrevious[TIME_STR_SIZE];
+uint32_t clockFaceDraws = 0;
+uint32_t editDraws = 0;
+uint32_t logsStored = 0;
+
+void updateDisplay() {
+    clockFaceDraws++;
+}
+
+void updateSetTimeDisplay() {
+    editDraws++;
+}
+
+void displayLogs() {}
+
+void displaySyncStats() {}
+
+// Same record as the board writes; the latest one moves down to previous
+void storeCurrentTime() {
+    struct tm fields;
+    epochToTm(currentTime(), &fields);
+    memcpy(logPrevious, logLatest, TIME_STR_SIZE);
+    strftime(logLatest, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", &fields);
+    logsStored++;
+}
+
+bool syncStatsPageEnabled() {
+    return syncStatsPage;
+}
+
+time_t currentTime() {
+    if (nextClockRead < clockReads.size()) return (time_t)clockReads[nextClockRead++];
+    uint64_t since = simMono > anchorMono ? simMono - anchorMono : 0;
+    return (time_t)anchorSec + (time_t)(since / 1000000);
+}
+
+void setSystemTime(time_t t) {
+    anchorSec = (uint32_t)t;
+    anchorMono = simMono;
+}
+
+void appStateChanged(int, int) {}
+
+void armEditRepeat(uint64_t due) {
+    repeatArmed = true;
+    repeatDue = due;
+}
+
+void cancelEditRepeat() {
+    repeatArmed = false;
+}
+
+const char *const STATE_NAMES[] = {"IDLE", "LOG_TIME", "DISPLAY_LOG", "SET_TIME", "SYNC_STATS"};
+
+const char *stateName(uint8_t s) {
+    return s < sizeof(STATE_NAMES) / sizeof(STATE_NAMES[0]) ? STATE_NAMES[s] : "-";
+}
+
+// What the replay checks: transitions and times entered on the SET_TIME screen
+bool isOutput(const TraceEntry &e) {
+    return e.kind == TRACE_STATE || (e.kind == TRACE_CLOCK && e.a == TRACE_CLOCK_SET);
+}
+
+bool sameEntry(const TraceEntry &x, const TraceEntry &y) {
+    return x.kind == y.kind && x.mono == y.mono && x.value == y.value && x.a == y.a && x.b == y.b;
+}
+
+void printEntry(const char *label, const TraceEntry &e) {
+    if (e.kind == TRACE_STATE) {
+        printf("%s %llu us: %s -> %s\n", label, (unsigned long long)e.mono, stateName(e.a), stateName(e.b));
+    } else {
+        char line[TRACE_LINE_SIZE];
+        InputTrace::format(e, line, sizeof(line));
+        printf("%s %s\n", label, line);
+    }
+}
+
+// Fire the repeats that fell due up to "mono", each at its own time
+void runRepeatsUntil(uint64_t mono) {
+    while (repeatArmed && repeatDue <= mono) {
+        repeatArmed = false;
+        simMono = repeatDue;
+        appEditRepeatDue(repeatDue);
+    }
+}
+
+struct ReplayResult {
+    int mismatches;
+    int compared;
+    uint64_t digest;         // Outputs, final edit buffer and logs, to check that runs agree
+};
+
+uint64_t fnv1a(uint64_t h, const void *data, size_t size) {
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Replays "recorded" from its first state entry (the boot or the "trace clear" marker)
+ReplayResult replay(const std::vector<TraceEntry> &recorded, int start, InputTrace &produced, bool report, bool verbose) {
+    produced.clear();
+    repeatArmed = false;
+    memset(logLatest, 0, sizeof(logLatest));
+    memset(logPrevious, 0, sizeof(logPrevious));
+    clockFaceDraws = editDraws = logsStored = 0;
+    for (int i = 0; i < start; i++) {
+        if (recorded[i].kind == TRACE_CLOCK && recorded[i].a == TRACE_CLOCK_ANCHOR) {
+            anchorSec = recorded[i].value;
+            anchorMono = recorded[i].mono;
+        }
+    }
+
+    simMono = recorded[start].mono;
+    appSetTrace(&produced);
+    appStart(simMono);
+    for (size_t i = start + 1; i < recorded.size(); i++) {
+        const TraceEntry &e = recorded[i];
+        runRepeatsUntil(e.mono);
+        simMono = e.mono;
+        if (e.kind == TRACE_INPUT || e.kind == TRACE_EVENT) {
+            clockReads.clear();
+            nextClockRead = 0;
+            for (size_t j = i + 1; j < recorded.size() && recorded[j].kind != TRACE_INPUT && recorded[j].kind != TRACE_EVENT; j++) {
+                if (recorded[j].kind == TRACE_CLOCK && recorded[j].a == TRACE_CLOCK_READ) clockReads.push_back(recorded[j].value);
+            }
+        }
+        if (e.kind == TRACE_INPUT) {
+            InputEvent event = {e.mono, (InputSource)e.a, (InputEdge)e.b};
+            appHandleInput(event);
+        } else if (e.kind == TRACE_EVENT) {
+            appDispatch((AppEvent)e.a, e.mono);
+        } else if (e.kind == TRACE_CLOCK && e.a == TRACE_CLOCK_ANCHOR) {
+            anchorSec = e.value;
+            anchorMono = e.mono;
+        }
+    }
+    appSetTrace(nullptr);
+    clockReads.clear();
+
+    // Both start with the initial state entry, which differs between a boot and a cleared trace
+    std::vector<TraceEntry> want, got;
+    for (size_t i = start + 1; i < recorded.size(); i++) {
+        if (isOutput(recorded[i])) want.push_back(recorded[i]);
+    }
+    for (int i = 1; i < produced.count(); i++) {
+        if (isOutput(produced.entry(i))) got.push_back(produced.entry(i));
+    }
+
+    ReplayResult result = {0, 0, 14695981039346656037ull};
+    size_t n = want.size() > got.size() ? want.size() : got.size();
+    for (size_t i = 0; i < n; i++) {
+        bool haveWant = i < want.size(), haveGot = i < got.size();
+        if (haveGot) result.digest = fnv1a(result.digest, &got[i], sizeof(TraceEntry));
+        if (haveWant && haveGot && sameEntry(want[i], got[i])) {
+            if (verbose) printEntry("  ok      ", got[i]);
+        } else {
+            if ((result.mismatches++ == 0 && report) || verbose) {
+                if (haveWant) printEntry("  expected", want[i]);
+                if (haveGot) printEntry("  replayed", got[i]);
+            }
+        }
+        result.compared++;
+    }
+    result.digest = fnv1a(result.digest, editBuffer, sizeof(editBuffer));
+    result.digest = fnv1a(result.digest, logLatest, sizeof(logLatest));
+    result.digest = fnv1a(result.digest, logPrevious, sizeof(logPrevious));
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int runs = 1;
+    bool verbose = false;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0) {
+            syncStatsPage = true;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+            if (runs < 1) runs = 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    FILE *in = path ? fopen(path, "r") : stdin;
+    if (in == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 2;
+    }
+
+    // The board shows UTC; mktime in the application must do the same here
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    // Lines around the dump (prompts, other output) are skipped
+    std::vector<TraceEntry> recorded;
+    unsigned long overwritten = 0;
+    char line[128];
+    while (fgets(line, sizeof(line), in)) {
+        int count;
+        TraceEntry e;
+        if (sscanf(line, "trace begin %d %lu", &count, &overwritten) == 2) {
+            recorded.clear();
+        } else if (InputTrace::parse(line, &e)) {
+            recorded.push_back(e);
+        }
+    }
+    if (in != stdin) fclose(in);
+
+    if (overwritten > 0) {
+        fprintf(stderr, "the trace lost its first %lu entries; run 'trace clear' on the clock face and record again\n", overwritten);
+        return 2;
+    }
+    int start = -1;
+    for (size_t i = 0; i < recorded.size() && start < 0; i++) {
+        if (recorded[i].kind == TRACE_STATE) start = (int)i;
+    }
+    if (start < 0) {
+        fprintf(stderr, "no trace found\n");
+        return 2;
+    }
+    const TraceEntry &first = recorded[start];
+    if (first.a != TRACE_NO_STATE && !(first.a == IDLE && first.b == IDLE)) {
+        fprintf(stderr, "the trace starts in %s; run 'trace clear' on the clock face\n", stateName(first.b));
+        return 2;
+    }
+
+    InputTrace produced;
+    int inputs = 0;
+    for (size_t i = start; i < recorded.size(); i++) {
+        if (recorded[i].kind == TRACE_INPUT || recorded[i].kind == TRACE_EVENT) inputs++;
+    }
+    ReplayResult firstRun = {0, 0, 0};
+    bool deterministic = true;
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < runs; r++) {
+        ReplayResult result = replay(recorded, start, produced, r == 0, verbose && r == 0);
+        if (r == 0) {
+            firstRun = result;
+        } else if (result.digest != firstRun.digest || result.mismatches != firstRun.mismatches) {
+            deterministic = false;
+        }
+    }
+    double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    if (produced.overwritten() > 0) {
+        fprintf(stderr, "replay output overflowed the trace buffer\n");
+        return 2;
+    }
+
+    printf("%d inputs, %d transitions and entered times compared, %d mismatches\n", inputs, firstRun.compared,
+           firstRun.mismatches);
+    printf("final state %s, edit buffer \"%s\", %lu logs stored (latest \"%s\")\n", stateName((uint8_t)state), editBuffer,
+           (unsigned long)logsStored, logLatest);
+    printf("clock face draws %lu, edit screen draws %lu\n", (unsigned long)clockFaceDraws, (unsigned long)editDraws);
+    printf("%d runs, %.0f ns per run, %.1f ns per input%s\n", runs, elapsedNs / runs,
+           inputs ? elapsedNs / runs / inputs : 0.0, deterministic ? "" : ", RUNS DIFFER");
+    return firstRun.mismatches == 0 && deterministic ? 0 : 1;
+}
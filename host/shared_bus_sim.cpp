@@ -0,0 +1,25 @@
+#include "shared_bus_sim.h"
+
+SharedBusSim::SharedBusSim(const TimeSyncConfig &config, uint64_t *now)
+    : config(config), now(now), nodeCount(0), frames(0), bytes(0) {
+}
+
+bool SharedBusSim::attach(TimeSyncFollower *node) {
+    if (nodeCount >= MAX_NODES) return false;
+    nodes[nodeCount++] = node;
+    return true;
+}
+
+void SharedBusSim::send(const uint8_t *data, size_t size) {
+    uint64_t start = *now;
+    frames++;
+    bytes += size;
+    for (size_t i = 0; i < size; i++) {
+        uint64_t wireUs = (uint64_t)(i + 1) * TIMESYNC_BITS_PER_BYTE * 1000000 / config.baud;
+        uint64_t arrival = start + wireUs + config.fixedLatencyUs;
+        if (arrival > *now) *now = arrival;
+        for (int n = 0; n < nodeCount; n++) {
+            nodes[n]->onRxByte(data[i], arrival);
+        }
+    }
+}
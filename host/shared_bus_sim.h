@@ -0,0 +1,32 @@
+#ifndef SHARED_BUS_SIM_H
+#define SHARED_BUS_SIM_H
+
+#include <cstdint>
+#include <cstddef>
+#include "timesync.h"
+
+// In-process model of a shared bus segment so several nodes can be exercised in one host process
+// (host/sync_sim.cpp). "now" points at the simulated time in microseconds. A frame starts going out
+// at *now and every byte is delivered to every attached follower when it would arrive on a real wire,
+// with *now moved on to that instant, so a repeater's re-broadcast starts where the frame ended.
+// The sender makes one send() per frame however many followers are attached.
+class SharedBusSim : public SyncTransport {
+public:
+    static constexpr int MAX_NODES = 64;
+
+    SharedBusSim(const TimeSyncConfig &config, uint64_t *now);
+    bool attach(TimeSyncFollower *node);
+    void send(const uint8_t *data, size_t size) override;
+    uint32_t framesSent() const { return frames; }
+    uint64_t bytesSent() const { return bytes; }
+
+private:
+    TimeSyncConfig config;
+    uint64_t *now;
+    TimeSyncFollower *nodes[MAX_NODES];
+    int nodeCount;
+    uint32_t frames;
+    uint64_t bytes;
+};
+
+#endif // SHARED_BUS_SIM_H
@@ -0,0 +1,185 @@
+// Master/follower time distribution with many nodes in one process (timesync.h).
+// One TimeSyncMaster broadcasts on a SharedBusSim segment. The followers are spread over three
+// segments joined by repeating followers, so they sit 0, 1 or 2 hops from the master. Each
+// follower's oscillator has its own frequency error (up to +-100 ppm), modelled as a frequency
+// offset its clock starts with, and its clock starts up to 200 ms off, so some start by stepping
+// and the others slew in at 500 ppm. The true error of every follower is sampled every 100 ms of
+// simulated time. A follower has converged once its error stays within 2 us of rounding, which it
+// only can once it has learned its frequency error; by the end the rate left over must be within
+// FREQ_BOUND_PPB.
+//
+//   g++ -std=c++17 -O2 -I. -Ihost host/sync_sim.cpp host/shared_bus_sim.cpp timesync.cpp
+//       clock_discipline.cpp wallclock.cpp leap_seconds.cpp -o sync_sim
+//   ./sync_sim [-n followers] [-t seconds] [-v]
+//
+// Without -n the run is repeated for 1 to 190 followers to show that the master's cost per
+// broadcast (one frame of 21 bytes) does not change with the number of followers. -v prints every
+// follower. The exit status is 0 only if every follower converged and stayed within its bound for
+// the last 60 s.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "shared_bus_sim.h"
+
+constexpr int SEGMENTS = 3;
+constexpr int MAX_FOLLOWERS = SEGMENTS * SharedBusSim::MAX_NODES;
+constexpr int64_t START_EPOCH_US = 1735689600LL * USEC_PER_SEC;    // 2025-01-01
+constexpr uint64_t SAMPLE_US = 100000;
+constexpr int64_t ROUNDING_US = 2;
+constexpr int32_t FREQ_BOUND_PPB = 10;               // Rate error the follower may leave uncorrected
+constexpr uint64_t SETTLED_US = 60 * 1000000ULL;     // Must hold the bound for this long at the end
+
+uint64_t simNow = 0;
+
+uint64_t monotonicMicros() {
+    return simNow;
+}
+
+struct SimNode {
+    WallClock clock;
+    TimeSyncFollower follower;
+    int hops;
+    int32_t skewPpb;            // Oscillator frequency error
+    int64_t startOffsetUs;
+    int64_t boundUs;
+    uint64_t lastOutside;       // Last sample with the error over the bound; converged one sample later
+    int64_t worstSettledUs;     // Largest error in the last SETTLED_US
+
+    SimNode(SharedBusSim *repeatBus) : clock(), follower(clock, TIMESYNC_DEFAULT_CONFIG, repeatBus) {}
+};
+
+struct RunResult {
+    uint32_t frames;            // Sent by the master
+    uint64_t bytes;
+    double hostNsPerFrame;      // Host time to deliver one frame to every follower
+    int64_t worstSettledUs;
+    uint64_t slowestConverge;
+    int failures;
+};
+
+int64_t absUs(int64_t v) {
+    return v < 0 ? -v : v;
+}
+
+RunResult runSim(int followers, uint64_t durationUs, bool verbose) {
+    const TimeSyncConfig &config = TIMESYNC_DEFAULT_CONFIG;
+    simNow = 0;
+    SharedBusSim segment0(config, &simNow), segment1(config, &simNow), segment2(config, &simNow);
+    SharedBusSim *segments[SEGMENTS] = {&segment0, &segment1, &segment2};
+    WallClock masterClock;
+    masterClock.step(START_EPOCH_US, 0);
+    TimeSyncMaster master(masterClock, segment0, config);
+
+    // Follower 0 repeats segment 0 onto segment 1 and follower 1 segment 1 onto segment 2
+    std::vector<std::unique_ptr<SimNode>> nodes;
+    for (int i = 0; i < followers; i++) {
+        int segment = followers >= SEGMENTS ? i % SEGMENTS : 0;
+        SharedBusSim *repeatBus = i < SEGMENTS - 1 && followers >= SEGMENTS ? segments[i + 1] : nullptr;
+        SimNode *node = new SimNode(repeatBus);
+        nodes.emplace_back(node);
+        node->hops = segment;
+        node->skewPpb = ((i * 37) % 201 - 100) * 1000;
+        node->startOffsetUs = ((i * 7919) % 401 - 200) * 1000;
+        node->boundUs = ROUNDING_US;
+        node->lastOutside = 0;
+        node->worstSettledUs = 0;
+        node->clock.setFrequencyPpb(node->skewPpb, 0);
+        node->clock.step(START_EPOCH_US + node->startOffsetUs, 0);
+        segments[segment]->attach(&node->follower);
+    }
+
+    RunResult result = {};
+    double hostNs = 0;
+    for (uint64_t t = 0; t <= durationUs; t += SAMPLE_US) {
+        simNow = t;
+        for (auto &node : nodes) {
+            int64_t error = absUs(node->clock.now(t) - masterClock.now(t));
+            if (error > node->boundUs) node->lastOutside = t;
+            if (t + SETTLED_US > durationUs && error > node->worstSettledUs) node->worstSettledUs = error;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        master.poll(t);
+        hostNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    result.frames = segment0.framesSent();
+    result.bytes = segment0.bytesSent();
+    result.hostNsPerFrame = result.frames ? hostNs / result.frames : 0;
+    for (int i = 0; i < followers; i++) {
+        SimNode &node = *nodes[i];
+        // The clock started at the oscillator's error, so what the loop leaves on it is the rate still wrong
+        int32_t rateErrorPpb = node.clock.frequencyPpb();
+        bool ok = node.lastOutside + SETTLED_US <= durationUs && node.follower.framesApplied() > 0 &&
+                  rateErrorPpb <= FREQ_BOUND_PPB && rateErrorPpb >= -FREQ_BOUND_PPB;
+        if (!ok) result.failures++;
+        if (node.worstSettledUs > result.worstSettledUs) result.worstSettledUs = node.worstSettledUs;
+        uint64_t converged = node.lastOutside + SAMPLE_US;
+        if (converged > result.slowestConverge) result.slowestConverge = converged;
+        if (verbose || !ok) {
+            printf("  follower %3d: %d hops, %+4ld ppm, start %+4ld ms, converged %6.1f s, worst %3ld us (bound %3ld us), "
+                   "rate %+ld ppb, %lu frames%s\n", i, node.hops, (long)(node.skewPpb / 1000),
+                   (long)(node.startOffsetUs / 1000), converged / 1e6, (long)node.worstSettledUs, (long)node.boundUs,
+                   (long)rateErrorPpb,
+                   (unsigned long)node.follower.framesApplied(), ok ? "" : "  FAIL");
+        }
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int only = 0;
+    double seconds = 600;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            only = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "usage: sync_sim [-n followers] [-t seconds] [-v]\n");
+            return 2;
+        }
+    }
+    if (only < 0 || only > MAX_FOLLOWERS) {
+        fprintf(stderr, "1 to %d followers\n", MAX_FOLLOWERS);
+        return 2;
+    }
+    if (seconds * 1e6 < 2 * SETTLED_US) {
+        fprintf(stderr, "run for at least %llu s\n", (unsigned long long)(2 * SETTLED_US / 1000000));
+        return 2;
+    }
+
+    static const int SWEEP[] = {1, 3, 12, 48, 190};
+    std::vector<int> counts;
+    if (only > 0) {
+        counts.push_back(only);
+    } else {
+        counts.assign(SWEEP, SWEEP + sizeof(SWEEP) / sizeof(SWEEP[0]));
+    }
+
+    printf("%9s %8s %12s %14s %18s %12s %12s\n", "followers", "frames", "bytes/frame", "host ns/frame",
+           "ns/frame/follower", "worst us", "converged s");
+    int failures = 0;
+    double bytesPerFrame = -1;
+    for (int n : counts) {
+        RunResult r = runSim(n, (uint64_t)(seconds * 1e6), verbose);
+        double perFrame = r.frames ? (double)r.bytes / r.frames : 0;
+        printf("%9d %8lu %12.1f %14.0f %18.0f %12ld %12.1f%s\n", n, (unsigned long)r.frames, perFrame,
+               r.hostNsPerFrame, r.hostNsPerFrame / n, (long)r.worstSettledUs, r.slowestConverge / 1e6,
+               r.failures ? "  FAIL" : "");
+        failures += r.failures;
+        // The master's work per broadcast must not depend on how many followers listen
+        if (bytesPerFrame >= 0 && perFrame != bytesPerFrame) {
+            printf("master sent %.1f bytes per frame, %.1f before\n", perFrame, bytesPerFrame);
+            failures++;
+        }
+        bytesPerFrame = perFrame;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+#include "timecode_gen.h"
+#include "civil_time.h"
+
+TimeCodeGenerator::TimeCodeGenerator(TimeCodeFormat format, const TimeCodeNoise &noise, uint32_t seed)
+    : format(format), noise(noise), state(seed ? seed : 1), leapSec(0) {
+}
+
+// xorshift32: deterministic for a given seed, so a noisy run can be reproduced exactly
+uint32_t TimeCodeGenerator::random() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+int64_t TimeCodeGenerator::jitter() {
+    if (noise.jitterUs == 0) return 0;
+    return (int64_t)(random() % (2 * noise.jitterUs + 1)) - noise.jitterUs;
+}
+
+// Emits one pulse (rising then falling edge) and possibly a glitch before "gapEnd"
+void TimeCodeGenerator::pulse(uint64_t start, uint64_t width, uint64_t gapEnd, TimeCodeEdge *out, int max, int *count) {
+    if (random() % 1000 < noise.dropPerMille) return;
+    uint64_t rise = start + jitter();
+    uint64_t fall = start + width + jitter();
+    if (*count + 2 > max) return;
+    out[(*count)++] = {rise, true};
+    out[(*count)++] = {fall, false};
+
+    if (noise.glitchMaxUs > 0 && random() % 1000 < noise.glitchPerMille) {
+        uint64_t room = gapEnd - fall;
+        uint64_t length = 1 + random() % noise.glitchMaxUs;
+        if (length * 2 < room && *count + 2 <= max) {
+            uint64_t at = fall + length / 2 + random() % (room - 2 * length);
+            out[(*count)++] = {at, true};
+            out[(*count)++] = {at + length, false};
+        }
+    }
+}
+
+static void setBcd(uint64_t *bits, int first, int value, const int *weights, int count) {
+    // Greedy from the largest weight gives the BCD encoding for these weight tables
+    for (int i = count - 1; i >= 0; i--) {
+        if (value >= weights[i]) {
+            bits[(first + i) / 64] |= 1ULL << ((first + i) % 64);
+            value -= weights[i];
+        }
+    }
+}
+
+static int parityOf(const uint64_t *bits, int first, int last) {
+    int ones = 0;
+    for (int i = first; i <= last; i++) {
+        ones += (bits[i / 64] >> (i % 64)) & 1;
+    }
+    return ones & 1;
+}
+
+int TimeCodeGenerator::frame(int64_t epochSec, uint64_t startMono, TimeCodeEdge *out, int max) {
+    static const int unitWeights[] = {1, 2, 4, 8, 10, 20, 40, 80};
+    int count = 0;
+    uint64_t bits[2] = {0, 0};
+    struct tm t;
+
+    if (format == TIMECODE_DCF77) {
+        // Bits sent during this minute describe the next one, in CET (no summer time)
+        epochToTm(epochSec + 60 + 3600, &t);
+        bits[0] |= 1ULL << 18;      // CET
+        if (leapSec != 0 && epochSec >= leapSec - 3600 && epochSec < leapSec) bits[0] |= 1ULL << 19;   // A2
+        bits[0] |= 1ULL << 20;      // Start of time information
+        setBcd(bits, 21, t.tm_min, unitWeights, 7);
+        setBcd(bits, 29, t.tm_hour, unitWeights, 6);
+        setBcd(bits, 36, t.tm_mday, unitWeights, 6);
+        setBcd(bits, 42, t.tm_wday == 0 ? 7 : t.tm_wday, unitWeights, 3);     // Monday 1 to Sunday 7
+        setBcd(bits, 45, t.tm_mon + 1, unitWeights, 5);
+        setBcd(bits, 50, t.tm_year % 100, unitWeights, 8);
+        bits[0] |= (uint64_t)parityOf(bits, 21, 27) << 28;
+        bits[0] |= (uint64_t)parityOf(bits, 29, 34) << 35;
+        bits[0] |= (uint64_t)parityOf(bits, 36, 57) << 58;
+        // A leap minute sends a 0 in second 59 and leaves out second 60
+        int seconds = leapSec != 0 && epochSec == leapSec - 60 ? 60 : 59;
+        for (int s = 0; s < seconds; s++) {
+            uint64_t start = startMono + (uint64_t)s * 1000000;
+            uint64_t width = ((bits[0] >> s) & 1) ? 200000 : 100000;
+            pulse(start, width, start + 1000000, out, max, &count);
+        }
+        return count;
+    }
+
+    epochToTm(epochSec, &t);
+    int second = t.tm_sec, minute = t.tm_min, hour = t.tm_hour, dayOfYear = t.tm_yday + 1, year = t.tm_year + 1900;
+    static const int tens[] = {10, 20, 40, 80};
+    static const int hundreds[] = {100, 200};
+    setBcd(bits, 1, second % 10, unitWeights, 4);
+    setBcd(bits, 6, second / 10 * 10, tens, 3);
+    setBcd(bits, 10, minute % 10, unitWeights, 4);
+    setBcd(bits, 15, minute / 10 * 10, tens, 3);
+    setBcd(bits, 20, hour % 10, unitWeights, 4);
+    setBcd(bits, 25, hour / 10 * 10, tens, 2);
+    setBcd(bits, 30, dayOfYear % 10, unitWeights, 4);
+    setBcd(bits, 35, dayOfYear / 10 % 10 * 10, tens, 4);
+    setBcd(bits, 40, dayOfYear / 100 * 100, hundreds, 2);
+    setBcd(bits, 50, year % 10, unitWeights, 4);
+    setBcd(bits, 55, year / 10 % 10 * 10, tens, 4);
+    bits[1] |= (uint64_t)parityOf(bits, 1, 74) << (75 - 64);
+
+    // Position 0 is the reference marker; the previous frame's position 99 supplies the marker before it
+    for (int p = 0; p < 100; p++) {
+        uint64_t start = startMono + (uint64_t)p * 10000;
+        bool marker = p == 0 || p % 10 == 9;
+        bool one = (bits[p / 64] >> (p % 64)) & 1;
+        uint64_t width = marker ? 8000 : one ? 5000 : 2000;
+        pulse(start, width, start + 10000, out, max, &count);
+    }
+    return count;
+}
@@ -0,0 +1,52 @@
+#ifndef TIMECODE_GEN_H
+#define TIMECODE_GEN_H
+
+#include <cstdint>
+#include "timecode.h"
+
+// Synthetic DCF77 / IRIG-B signal generator for exercising the decoders off target.
+// It produces the edge stream a capture timer would deliver, with configurable impairments,
+// so decode robustness and per-edge CPU cost can be measured on a host (host/timecode_sim.cpp).
+
+struct TimeCodeEdge {
+    uint64_t mono;      // Capture time of the edge
+    bool level;         // Pin level after the edge (active high)
+};
+
+struct TimeCodeNoise {
+    uint32_t jitterUs;          // Uniform jitter applied independently to every edge (+/-)
+    uint32_t glitchPerMille;    // Chance per pulse of a spurious short pulse in the following gap
+    uint32_t glitchMaxUs;       // Longest spurious pulse
+    uint32_t dropPerMille;      // Chance per pulse that it is lost entirely
+};
+
+class TimeCodeGenerator {
+public:
+    TimeCodeGenerator(TimeCodeFormat format, const TimeCodeNoise &noise, uint32_t seed = 1);
+
+    // Emits the edges of one frame into "out" (at most "max" edges) and returns how many were written.
+    // DCF77: the minute starting at UTC "epochSec" (encoding the following minute, CET).
+    // IRIG-B: the second starting at UTC "epochSec", with its reference marker at "startMono".
+    // "startMono" is the monotonic time of the frame's first on-time edge.
+    int frame(int64_t epochSec, uint64_t startMono, TimeCodeEdge *out, int max);
+
+    // Insert a leap second at the midnight "utcSec" (DCF77 only). Frames sent in the hour before
+    // carry the announcement bit, and the minute before the midnight has a 60th second, so that
+    // frame spans 61 s.
+    void insertLeap(int64_t utcSec) { leapSec = utcSec; }
+
+    // Longest edge list a single frame can produce, for sizing "out"
+    static constexpr int MAX_FRAME_EDGES = 4 * 101;
+
+private:
+    uint32_t random();
+    int64_t jitter();
+    void pulse(uint64_t start, uint64_t width, uint64_t gapEnd, TimeCodeEdge *out, int max, int *count);
+
+    TimeCodeFormat format;
+    TimeCodeNoise noise;
+    uint32_t state;
+    int64_t leapSec;        // Midnight of the inserted leap second, 0 for none
+};
+
+#endif // TIMECODE_GEN_H
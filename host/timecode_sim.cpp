@@ -0,0 +1,202 @@
+// Decode robustness and CPU cost of the DCF77 and IRIG-B decoders (timecode.h) under noise.
+// TimeCodeGenerator (host/timecode_gen.h) produces the edges a capture timer would deliver, with
+// jitter on every edge, spurious pulses in the gaps and lost pulses. Each row of the sweep feeds
+// one impairment at a time, at rising levels, to a fresh decoder. It reports the share of frames
+// decoded, the frames decoded to the wrong time, the decoder's error counters and the host time per
+// edge. A fix is right if its time, taken at its reference edge, is the generator's time to within
+// the jitter. The runs cross a year boundary, so the date fields roll over.
+//
+//   g++ -std=c++17 -O2 -I. -Ihost host/timecode_sim.cpp host/timecode_gen.cpp timecode.cpp leap_seconds.cpp -o timecode_sim
+//   ./timecode_sim [-m dcf77 minutes] [-s irig-b seconds] [-r seed]
+//
+// Parity only catches an odd number of bit errors per group, so heavy noise can produce wrong
+// fixes; the "wrong" column shows how many. A last run sends the DCF77 hour before a leap second,
+// including the 61 s leap minute, and passes the announcements to a LeapTable as main.cpp does.
+// The exit status is 0 only if the clean signal decoded every frame to the right time and the
+// table gained exactly that leap second.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "timecode.h"
+#include "timecode_gen.h"
+#include "civil_time.h"
+#include "leap_seconds.h"
+
+struct SweepRow {
+    TimeCodeFormat format;
+    TimeCodeNoise noise;
+};
+
+// Glitches up to 1.5x the decoder's glitch limit, so some are long enough to look like data
+const SweepRow SWEEP[] = {
+    {TIMECODE_DCF77, {0, 0, 0, 0}},
+    {TIMECODE_DCF77, {2000, 0, 0, 0}},
+    {TIMECODE_DCF77, {10000, 0, 0, 0}},
+    {TIMECODE_DCF77, {30000, 0, 0, 0}},
+    {TIMECODE_DCF77, {60000, 0, 0, 0}},
+    {TIMECODE_DCF77, {0, 50, 60000, 0}},
+    {TIMECODE_DCF77, {0, 200, 60000, 0}},
+    {TIMECODE_DCF77, {0, 1000, 60000, 0}},
+    {TIMECODE_DCF77, {0, 0, 0, 1}},
+    {TIMECODE_DCF77, {0, 0, 0, 10}},
+    {TIMECODE_DCF77, {0, 0, 0, 50}},
+    {TIMECODE_DCF77, {10000, 200, 60000, 10}},
+    {TIMECODE_IRIGB, {0, 0, 0, 0}},
+    {TIMECODE_IRIGB, {100, 0, 0, 0}},
+    {TIMECODE_IRIGB, {300, 0, 0, 0}},
+    {TIMECODE_IRIGB, {600, 0, 0, 0}},
+    {TIMECODE_IRIGB, {1000, 0, 0, 0}},
+    {TIMECODE_IRIGB, {0, 10, 1500, 0}},
+    {TIMECODE_IRIGB, {0, 50, 1500, 0}},
+    {TIMECODE_IRIGB, {0, 200, 1500, 0}},
+    {TIMECODE_IRIGB, {0, 0, 0, 1}},
+    {TIMECODE_IRIGB, {0, 0, 0, 5}},
+    {TIMECODE_IRIGB, {0, 0, 0, 20}},
+    {TIMECODE_IRIGB, {300, 50, 1500, 5}},
+};
+constexpr int SWEEP_ROWS = sizeof(SWEEP) / sizeof(SWEEP[0]);
+
+struct RowResult {
+    int frames;             // Frames that could be decoded
+    int decoded;
+    int wrong;
+    uint64_t edges;
+    double ns;
+    TimeCodeCounters counters;
+};
+
+template <typename Decoder>
+RowResult runRow(Decoder &decoder, const SweepRow &row, int frames, uint32_t seed) {
+    TimeCodeGenerator generator(row.format, row.noise, seed);
+    bool dcf = row.format == TIMECODE_DCF77;
+    uint64_t frameUs = dcf ? 60000000 : 1000000;
+    // Every run is centred on the start of 2026
+    int64_t startSec = civilToEpoch(2026, 1, 1, 0, 0, 0) - (int64_t)frames * (int64_t)(frameUs / 1000000) / 2;
+    uint64_t startMono = 5000000;
+    int64_t trueOffset = startSec * 1000000 - (int64_t)startMono;   // Epoch minus monotonic time
+
+    static TimeCodeEdge edges[TimeCodeGenerator::MAX_FRAME_EDGES];
+    // The first DCF77 minute only finds the minute marker and the last one has none after it to
+    // end it; an IRIG-B frame needs the previous frame's last marker
+    RowResult result = {dcf ? frames - 2 : frames - 1, 0, 0, 0, 0, {}};
+    for (int f = 0; f < frames; f++) {
+        int count = generator.frame(startSec + f * (int64_t)(frameUs / 1000000), startMono + f * frameUs, edges,
+                                    TimeCodeGenerator::MAX_FRAME_EDGES);
+        // Jitter can swap neighbouring edges; the capture hardware delivers them in time order
+        std::stable_sort(edges, edges + count, [](const TimeCodeEdge &a, const TimeCodeEdge &b) { return a.mono < b.mono; });
+
+        TimeCodeFix fixes[4];
+        int fixCount = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            if (decoder.onEdge(edges[i].level, edges[i].mono, &fixes[fixCount]) && fixCount < 3) fixCount++;
+        }
+        result.ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+        result.edges += count;
+
+        for (int i = 0; i < fixCount; i++) {
+            int64_t error = fixes[i].epochUs - (int64_t)fixes[i].refMono - trueOffset;
+            if (error < 0) error = -error;
+            if (error <= (int64_t)row.noise.jitterUs) {
+                result.decoded++;
+            } else {
+                result.wrong++;
+            }
+        }
+    }
+    result.counters = decoder.counters();
+    return result;
+}
+
+// A leap second at the end of June 2026, which the built-in table does not have
+bool leapRun() {
+    const int64_t leapSec = civilToEpoch(2026, 7, 1, 0, 0, 0);
+    const int64_t firstSec = leapSec - 90 * 60;
+    const uint64_t firstMono = 5000000;
+    TimeCodeGenerator generator(TIMECODE_DCF77, {0, 0, 0, 0});
+    generator.insertLeap(leapSec);
+    Dcf77Decoder decoder;
+    LeapTable table;
+    int known = table.count();
+
+    static TimeCodeEdge edges[TimeCodeGenerator::MAX_FRAME_EDGES];
+    int frames = 0, fixes = 0, wrong = 0, announcements = 0;
+    uint64_t mono = firstMono;
+    for (int64_t sec = firstSec; sec < leapSec + 10 * 60; sec += 60, frames++) {
+        int count = generator.frame(sec, mono, edges, TimeCodeGenerator::MAX_FRAME_EDGES);
+        for (int i = 0; i < count; i++) {
+            TimeCodeFix fix;
+            if (!decoder.onEdge(edges[i].level, edges[i].mono, &fix)) continue;
+            fixes++;
+            // Every minute from the leap on starts one second later on the monotonic clock
+            int64_t epochSec = fix.epochUs / 1000000;
+            uint64_t expectMono = firstMono + (uint64_t)(epochSec - firstSec) * 1000000 + (epochSec >= leapSec ? 1000000 : 0);
+            if (fix.refMono != expectMono || fix.epochUs % 60000000 != 0) wrong++;
+            if (fix.leapPending) {
+                announcements++;
+                table.announce(fix.sentSec, fix.leapDelete ? -1 : 1);
+            }
+        }
+        mono += (sec == leapSec - 60 ? 61 : 60) * 1000000ULL;
+    }
+
+    const LeapEntry &last = table.entry(table.count() - 1);
+    bool ok = fixes == frames - 2 && wrong == 0 && announcements == 60 && table.count() == known + 1 &&
+              last.utcSec == leapSec && last.sign == 1;
+    printf("DCF77 leap: %d frames, %d decoded, %d wrong, %d announcements, %d leap seconds added, last at %lld "
+           "(want %lld)%s\n", frames, fixes, wrong, announcements, table.count() - known, (long long)last.utcSec,
+           (long long)leapSec, ok ? "" : "  FAIL");
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int dcfMinutes = 240;
+    int irigSeconds = 1200;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            dcfMinutes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            irigSeconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "usage: timecode_sim [-m dcf77 minutes] [-s irig-b seconds] [-r seed]\n");
+            return 2;
+        }
+    }
+    if (dcfMinutes < 3 || irigSeconds < 2) {
+        fprintf(stderr, "at least three DCF77 minutes and two IRIG-B seconds\n");
+        return 2;
+    }
+
+    printf("%-7s %9s %9s %8s %7s %8s %6s %7s %7s %8s %8s %8s\n", "format", "jitter us", "glitch %o", "drop %o",
+           "frames", "decoded", "wrong", "rate %", "parity", "framing", "glitches", "ns/edge");
+    int failures = 0;
+    for (int r = 0; r < SWEEP_ROWS; r++) {
+        const SweepRow &row = SWEEP[r];
+        RowResult result;
+        if (row.format == TIMECODE_DCF77) {
+            Dcf77Decoder decoder;
+            result = runRow(decoder, row, dcfMinutes, seed);
+        } else {
+            IrigBDecoder decoder;
+            result = runRow(decoder, row, irigSeconds, seed);
+        }
+        bool clean = row.noise.jitterUs == 0 && row.noise.glitchPerMille == 0 && row.noise.dropPerMille == 0;
+        bool failed = clean && (result.wrong > 0 || result.decoded != result.frames);
+        if (failed) failures++;
+        printf("%-7s %9lu %9lu %8lu %7d %8d %6d %7.1f %7lu %8lu %8lu %8.1f%s\n",
+               row.format == TIMECODE_DCF77 ? "DCF77" : "IRIG-B", (unsigned long)row.noise.jitterUs,
+               (unsigned long)row.noise.glitchPerMille, (unsigned long)row.noise.dropPerMille, result.frames,
+               result.decoded, result.wrong, 100.0 * result.decoded / result.frames,
+               (unsigned long)result.counters.parityErrors, (unsigned long)result.counters.framingErrors,
+               (unsigned long)result.counters.glitches, result.edges ? result.ns / result.edges : 0.0,
+               failed ? "  FAIL" : "");
+    }
+    if (!leapRun()) failures++;
+    return failures ? 1 : 0;
+}
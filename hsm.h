@@ -0,0 +1,161 @@
+#ifndef HSM_H
+#define HSM_H
+
+#include <cstdint>
+
+// Table-driven hierarchical state machine.
+// States are small integers. Each state names its parent (HSM_NONE for the top) and has optional
+// entry and exit actions. Transitions are rows of (from, event, guard, to, action), with
+// to == HSM_NONE for an internal transition (action only, no exit or entry). A row on a superstate
+// applies to every state below it unless a substate has its own row for that event.
+// hsmBuildLookup resolves the hierarchy at compile time into a [state][event] array holding the
+// first row that handles each pair. Dispatch is one array lookup plus the guards of that pair, so
+// adding states or rows does not slow down any existing pair. Rows with the same (from, event)
+// must be adjacent and are tried in order. If every guard fails, the event goes on to the parent.
+// Transition targets must be leaf states. After entering a state, the completion event (if the
+// machine has one) is dispatched once, so a transient state can move on by itself.
+
+constexpr int HSM_NONE = -1;
+
+typedef void (*HsmAction)();
+typedef bool (*HsmGuard)();
+
+struct HsmState {
+    int parent;
+    HsmAction entry;
+    HsmAction exit;
+};
+
+struct HsmTransition {
+    int from;
+    int event;
+    HsmGuard guard;          // nullptr = always
+    int to;                  // HSM_NONE = internal
+    HsmAction action;
+};
+
+template <int STATES, int EVENTS>
+struct HsmLookup {
+    int16_t row[STATES][EVENTS];   // First row handling (state, event), from the state or its nearest ancestor; -1 if none
+};
+
+template <int EVENTS, int STATES, int ROWS>
+constexpr HsmLookup<STATES, EVENTS> hsmBuildLookup(const HsmState (&states)[STATES], const HsmTransition (&rows)[ROWS]) {
+    HsmLookup<STATES, EVENTS> lookup{};
+    for (int s = 0; s < STATES; s++) {
+        for (int e = 0; e < EVENTS; e++) {
+            lookup.row[s][e] = -1;
+            for (int a = s; a != HSM_NONE && lookup.row[s][e] < 0; a = states[a].parent) {
+                for (int r = 0; r < ROWS; r++) {
+                    if (rows[r].from == a && rows[r].event == e) {
+                        lookup.row[s][e] = (int16_t)r;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return lookup;
+}
+
+template <int STATES, int EVENTS, int ROWS>
+class Hsm {
+public:
+    typedef void (*ChangeHook)(int from, int to);
+
+    // "changed" is called with the old and new leaf state after the exits and the transition
+    // action, before the entries
+    Hsm(const HsmState (&states)[STATES], const HsmTransition (&rows)[ROWS], const HsmLookup<STATES, EVENTS> &lookup,
+        int completionEvent, ChangeHook changed)
+        : states(states), rows(rows), lookup(lookup), completionEvent(completionEvent), changed(changed), leaf(HSM_NONE) {}
+
+    // Enter "initial" (a leaf) from the top
+    void start(int initial) {
+        int from = leaf;
+        leaf = initial;
+        if (changed) changed(from, initial);
+        enter(HSM_NONE, initial);
+        complete();
+    }
+
+    // Returns false if no state on the current path handled the event
+    bool dispatch(int event) {
+        if (leaf == HSM_NONE || event < 0 || event >= EVENTS) return false;
+        int s = leaf;
+        while (s != HSM_NONE) {
+            int r = lookup.row[s][event];
+            if (r < 0) return false;
+            int owner = rows[r].from;
+            for (; r < ROWS && rows[r].from == owner && rows[r].event == event; r++) {
+                if (rows[r].guard == nullptr || rows[r].guard()) {
+                    fire(rows[r]);
+                    return true;
+                }
+            }
+            s = states[owner].parent;
+        }
+        return false;
+    }
+
+    int current() const { return leaf; }
+
+    // True if "s" is the current leaf or one of its ancestors
+    bool in(int s) const {
+        for (int a = leaf; a != HSM_NONE; a = states[a].parent) {
+            if (a == s) return true;
+        }
+        return false;
+    }
+
+private:
+    void fire(const HsmTransition &t) {
+        if (t.to == HSM_NONE) {
+            if (t.action) t.action();
+            return;
+        }
+        // A transition to the current state leaves and re-enters it
+        int top = t.to == leaf ? states[leaf].parent : commonAncestor(leaf, t.to);
+        for (int a = leaf; a != top; a = states[a].parent) {
+            if (states[a].exit) states[a].exit();
+        }
+        if (t.action) t.action();
+        int from = leaf;
+        leaf = t.to;
+        if (changed) changed(from, t.to);
+        enter(top, t.to);
+        complete();
+    }
+
+    // Run the entry actions from just below "top" down to "target"
+    void enter(int top, int target) {
+        int path[STATES];
+        int depth = 0;
+        for (int a = target; a != top && a != HSM_NONE; a = states[a].parent) path[depth++] = a;
+        while (depth > 0) {
+            int a = path[--depth];
+            if (states[a].entry) states[a].entry();
+        }
+    }
+
+    int commonAncestor(int a, int b) const {
+        for (int x = a; x != HSM_NONE; x = states[x].parent) {
+            for (int y = b; y != HSM_NONE; y = states[y].parent) {
+                if (x == y) return x;
+            }
+        }
+        return HSM_NONE;
+    }
+
+    void complete() {
+        if (completionEvent != HSM_NONE && lookup.row[leaf][completionEvent] >= 0) dispatch(completionEvent);
+    }
+
+    const HsmState (&states)[STATES];
+    const HsmTransition (&rows)[ROWS];
+    const HsmLookup<STATES, EVENTS> &lookup;
+    int completionEvent;
+    ChangeHook changed;
+    int leaf;
+};
+
+#endif // HSM_H
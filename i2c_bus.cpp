@@ -0,0 +1,163 @@
+#include "i2c_bus.h"
+#include "wallclock.h"
+#include <cstring>
+
+I2cBus::I2cBus(PinName sda, PinName scl)
+    : i2c(sda, scl), thread(osPriorityAboveNormal, 1024, nullptr, "i2c"), queued(0), clients(0), watchdog(nullptr) {
+    for (int p = 0; p < I2C_PRIORITY_COUNT; p++) {
+        head[p] = nullptr;
+        tail[p] = nullptr;
+    }
+    memset(clientStats, 0, sizeof(clientStats));
+}
+
+void I2cBus::start() {
+    thread.start(callback(this, &I2cBus::run));
+}
+
+int I2cBus::addClient(const char *name) {
+    lock.lock();
+    int id = -1;
+    if (clients < I2C_BUS_MAX_CLIENTS) {
+        id = clients++;
+        clientStats[id].name = name;
+    }
+    lock.unlock();
+    return id;
+}
+
+I2cClientStats I2cBus::stats(int client) {
+    lock.lock();
+    I2cClientStats s = clientStats[client];
+    lock.unlock();
+    return s;
+}
+
+void I2cBus::resetStats() {
+    lock.lock();
+    for (int i = 0; i < clients; i++) {
+        const char *name = clientStats[i].name;
+        memset(&clientStats[i], 0, sizeof(clientStats[i]));
+        clientStats[i].name = name;
+    }
+    lock.unlock();
+}
+
+// The transaction lives on the caller's stack; the caller sleeps on its semaphore until the bus
+// thread has run it
+int I2cBus::transfer(int client, int address, const char *tx, int txLength, char *rx, int rxLength, I2cPriority priority) {
+    if (client < 0 || client >= clients) return -1;
+    Transaction t;
+    t.client = client;
+    t.address = address;
+    t.tx = tx;
+    t.txLength = txLength;
+    t.rx = rx;
+    t.rxLength = rxLength;
+    t.result = -1;
+    t.next = nullptr;
+
+    lock.lock();
+    t.queuedAt = monotonicMicros();
+    if (tail[priority] != nullptr) {
+        tail[priority]->next = &t;
+    } else {
+        head[priority] = &t;
+    }
+    tail[priority] = &t;
+    lock.unlock();
+    queued.release();
+
+    t.done.acquire();
+    return t.result;
+}
+
+void I2cBus::run() {
+    while (true) {
+        queued.acquire();
+        Transaction *t = takeNext();
+        if (t != nullptr) execute(t);
+    }
+}
+
+I2cBus::Transaction *I2cBus::takeNext() {
+    lock.lock();
+    Transaction *t = nullptr;
+    for (int p = 0; p < I2C_PRIORITY_COUNT && t == nullptr; p++) {
+        t = head[p];
+        if (t != nullptr) {
+            head[p] = t->next;
+            if (head[p] == nullptr) tail[p] = nullptr;
+        }
+    }
+    lock.unlock();
+    return t;
+}
+
+int I2cBus::copyTrace(I2cTraceEntry *out, int capacity, uint32_t *lost) {
+    lock.lock();
+    int n = trace.count() < capacity ? trace.count() : capacity;
+    int skip = trace.count() - n;
+    for (int i = 0; i < n; i++) out[i] = trace.entry(skip + i);
+    *lost = trace.overwritten() + (uint32_t)skip;
+    lock.unlock();
+    return n;
+}
+
+void I2cBus::clearTrace() {
+    lock.lock();
+    trace.clear();
+    lock.unlock();
+}
+
+void I2cBus::tracePhase(const Transaction *t, char direction, int length, uint64_t start, uint64_t end,
+                        uint32_t waitUs, int result) {
+    I2cTraceEntry e;
+    e.start = start;
+    e.durationUs = (uint32_t)(end - start);
+    e.waitUs = waitUs;
+    e.length = (uint16_t)length;
+    e.client = (uint8_t)t->client;
+    e.address = (uint8_t)t->address;
+    e.direction = direction;
+    e.result = (int8_t)(result < -128 ? -128 : result > 127 ? 127 : result);
+    lock.lock();
+    trace.record(e);
+    lock.unlock();
+}
+
+// Same sequence the EEPROM code used on its own: write (with stop), then read
+void I2cBus::execute(Transaction *t) {
+    if (watchdog) watchdog->setBusy(WATCHDOG_TASK_I2C, true);
+    uint64_t started = monotonicMicros();
+    uint32_t waitUs = (uint32_t)(started - t->queuedAt);
+    int result = 0;
+    uint64_t finished = started;
+    if (t->txLength > 0) {
+        result = i2c.write(t->address, t->tx, t->txLength, false);
+        finished = monotonicMicros();
+        tracePhase(t, 'W', t->txLength, started, finished, waitUs, result);
+    }
+    if (result == 0 && t->rxLength > 0) {
+        uint64_t readStart = monotonicMicros();
+        result = i2c.read(t->address, t->rx, t->rxLength);
+        finished = monotonicMicros();
+        tracePhase(t, 'R', t->rxLength, readStart, finished, t->txLength > 0 ? 0 : waitUs, result);
+    }
+    if (watchdog) {
+        watchdog->checkIn(WATCHDOG_TASK_I2C);
+        watchdog->setBusy(WATCHDOG_TASK_I2C, false);
+    }
+
+    lock.lock();
+    I2cClientStats &s = clientStats[t->client];
+    s.transactions++;
+    if (result != 0) s.errors++;
+    s.totalWaitUs += waitUs;
+    if (waitUs > s.maxWaitUs) s.maxWaitUs = waitUs;
+    s.totalBusUs += finished - started;
+    lock.unlock();
+
+    t->result = result;
+    t->done.release();    // "t" belongs to the caller from here on
+}
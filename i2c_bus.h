@@ -0,0 +1,92 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "mbed.h"
+#include "task_watchdog.h"
+#include "i2c_trace.h"
+
+// Shared I2C bus, run by its own thread.
+// Clients (EEPROM log, RTC chip, sensors) register once and then submit transactions from their own
+// threads. Each call blocks only its caller until the transaction has run. The bus thread is the
+// only code that touches the I2C peripheral and serves the queue in priority order: critical
+// transactions (reads something is waiting on) go ahead of bulk ones (EEPROM page writes), FIFO
+// within a priority. A running transaction is never interrupted, so a critical read waits for at
+// most one bulk transaction.
+// For each client the bus records how long transactions waited in the queue and how long they
+// held the bus. Every phase also goes into a trace ring (i2c_trace.h) for a closer look.
+
+enum I2cPriority {
+    I2C_PRIORITY_CRITICAL,
+    I2C_PRIORITY_BULK,
+    I2C_PRIORITY_COUNT
+};
+
+constexpr int I2C_BUS_MAX_CLIENTS = 4;
+
+struct I2cClientStats {
+    const char *name;
+    uint32_t transactions;
+    uint32_t errors;          // Transactions that were not acknowledged throughout
+    uint64_t totalWaitUs;     // Time from submission to start, summed
+    uint32_t maxWaitUs;
+    uint64_t totalBusUs;      // Time on the bus, summed
+};
+
+class I2cBus {
+public:
+    I2cBus(PinName sda, PinName scl);
+
+    void start();
+
+    // Report bus progress to "watchdog" (the bus counts as busy while a transaction runs)
+    void setWatchdog(TaskWatchdog *watchdog) { this->watchdog = watchdog; }
+
+    // Register a client; returns its id, or -1 if the table is full
+    int addClient(const char *name);
+
+    // Write "txLength" bytes to the device at "address", then read "rxLength" bytes if rxLength > 0.
+    // Blocks the calling thread until the transaction has run. Returns 0 if every byte was acknowledged.
+    int transfer(int client, int address, const char *tx, int txLength, char *rx, int rxLength, I2cPriority priority);
+
+    int clientCount() const { return clients; }
+    // Snapshot of one client's counters, taken under the lock
+    I2cClientStats stats(int client);
+    void resetStats();
+
+    // Copy the trace, oldest first, into "out" (up to "capacity" entries); returns the number
+    // copied and sets "lost" to the count overwritten before the oldest
+    int copyTrace(I2cTraceEntry *out, int capacity, uint32_t *lost);
+    void clearTrace();
+
+private:
+    struct Transaction {
+        int client;
+        int address;
+        const char *tx;
+        int txLength;
+        char *rx;
+        int rxLength;
+        uint64_t queuedAt;
+        int result;
+        Semaphore done;
+        Transaction *next;
+    };
+
+    void run();
+    Transaction *takeNext();
+    void execute(Transaction *t);
+    void tracePhase(const Transaction *t, char direction, int length, uint64_t start, uint64_t end, uint32_t waitUs, int result);
+
+    I2C i2c;
+    Thread thread;
+    Mutex lock;                               // Guards the queues, the client table and its stats
+    Semaphore queued;                         // One count per queued transaction
+    Transaction *head[I2C_PRIORITY_COUNT];
+    Transaction *tail[I2C_PRIORITY_COUNT];
+    I2cClientStats clientStats[I2C_BUS_MAX_CLIENTS];
+    I2cTrace trace;                           // Guarded by "lock" as well
+    int clients;
+    TaskWatchdog *watchdog;
+};
+
+#endif // I2C_BUS_H
@@ -0,0 +1,30 @@
+#include "i2c_trace.h"
+#include <cstdio>
+
+void I2cTrace::format(const I2cTraceEntry &e, char *line, size_t size) {
+    snprintf(line, size, "%llu %llu %lu %u %02x %c %u %d", (unsigned long long)e.start,
+             (unsigned long long)(e.start + e.durationUs), (unsigned long)e.waitUs, (unsigned)e.client,
+             (unsigned)e.address, e.direction, (unsigned)e.length, (int)e.result);
+}
+
+bool I2cTrace::parse(const char *line, I2cTraceEntry *e) {
+    unsigned long long start, end;
+    unsigned long wait;
+    unsigned client, address, length;
+    char direction;
+    int result;
+    if (sscanf(line, " %llu %llu %lu %u %x %c %u %d", &start, &end, &wait, &client, &address, &direction, &length,
+               &result) != 8) {
+        return false;
+    }
+    if ((direction != 'W' && direction != 'R') || end < start) return false;
+    e->start = start;
+    e->durationUs = (uint32_t)(end - start);
+    e->waitUs = (uint32_t)wait;
+    e->client = (uint8_t)client;
+    e->address = (uint8_t)address;
+    e->direction = direction;
+    e->length = (uint16_t)length;
+    e->result = (int8_t)result;
+    return true;
+}
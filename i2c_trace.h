@@ -0,0 +1,41 @@
+#ifndef I2C_TRACE_H
+#define I2C_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include "trace_ring.h"
+
+// Record of the most recent I2C bus phases, kept all the time so a slow or failed EEPROM access
+// can be looked at after the fact.
+// A transaction is one or two phases: a write (with stop), and a read if it asked for data.
+// Each phase records the client, device address, direction, length, when it started and ended on
+// the bus and whether every byte was acknowledged. The first phase also carries how long the
+// transaction waited in the queue. The trace keeps the most recent I2C_TRACE_CAPACITY phases
+// (trace_ring.h).
+// The text form is one phase per line, "<start us> <end us> <wait us> <client> <address> <W|R>
+// <length> <result>", with the address in hex (8-bit form, as mbed takes it). It is printed by the
+// console command "i2c trace" and parsed by host/i2c_decode.cpp.
+
+struct I2cTraceEntry {
+    uint64_t start;          // Monotonic time the phase started
+    uint32_t durationUs;     // Start to end on the bus
+    uint32_t waitUs;         // Queue wait of the transaction (first phase), else 0
+    uint16_t length;         // Bytes after the address
+    uint8_t client;
+    uint8_t address;
+    char direction;          // 'W' or 'R'
+    int8_t result;           // 0 if acknowledged throughout, else the driver's error
+};
+
+constexpr int I2C_TRACE_CAPACITY = 128;
+constexpr size_t I2C_TRACE_LINE_SIZE = 64;
+
+class I2cTrace : public TraceRing<I2cTraceEntry, I2C_TRACE_CAPACITY> {
+public:
+    // Text form of one phase
+    static void format(const I2cTraceEntry &e, char *line, size_t size);
+    // Reads one phase back from its text form; returns false if "line" does not hold one
+    static bool parse(const char *line, I2cTraceEntry *e);
+};
+
+#endif // I2C_TRACE_H
@@ -0,0 +1,31 @@
+#ifndef INPUT_EVENTS_H
+#define INPUT_EVENTS_H
+
+#include <cstdint>
+
+// Button input as a stream of timestamped edges.
+// The interrupts record every edge in arrival order; the main thread drains them in that order, so
+// presses that arrive faster than they are handled are neither merged nor reordered.
+
+enum InputSource : uint8_t {
+    INPUT_LOG_BUTTON,        // BUTTON1: log the current time
+    INPUT_REPLAY_BUTTON,     // PE_6: show logs / decrement
+    INPUT_SET_TIME_BUTTON,   // PE_4: enter time setting / next digit
+    INPUT_INCREMENT_BUTTON,  // PE_2: increment
+    INPUT_SOURCE_COUNT
+};
+
+enum InputEdge : uint8_t {
+    INPUT_PRESSED,
+    INPUT_RELEASED
+};
+
+struct InputEvent {
+    uint64_t mono;           // Monotonic time of the edge
+    InputSource source;
+    InputEdge edge;
+};
+
+constexpr uint32_t INPUT_EVENT_RING_SIZE = 32;
+
+#endif // INPUT_EVENTS_H
@@ -0,0 +1,32 @@
+#include "input_trace.h"
+#include <cstdio>
+
+void InputTrace::record(TraceKind kind, uint64_t mono, uint8_t a, uint8_t b, uint32_t value) {
+    TraceEntry e;
+    e.mono = mono;
+    e.value = value;
+    e.kind = kind;
+    e.a = a;
+    e.b = b;
+    record(e);
+}
+
+void InputTrace::format(const TraceEntry &e, char *line, size_t size) {
+    snprintf(line, size, "%c %llu %lu %u %u", (char)e.kind, (unsigned long long)e.mono, (unsigned long)e.value,
+             (unsigned)e.a, (unsigned)e.b);
+}
+
+bool InputTrace::parse(const char *line, TraceEntry *e) {
+    char kind;
+    unsigned long long mono;
+    unsigned long value;
+    unsigned a, b;
+    if (sscanf(line, " %c %llu %lu %u %u", &kind, &mono, &value, &a, &b) != 5) return false;
+    if (kind != TRACE_INPUT && kind != TRACE_EVENT && kind != TRACE_STATE && kind != TRACE_CLOCK) return false;
+    e->kind = (TraceKind)kind;
+    e->mono = mono;
+    e->value = (uint32_t)value;
+    e->a = (uint8_t)a;
+    e->b = (uint8_t)b;
+    return true;
+}
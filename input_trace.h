@@ -0,0 +1,51 @@
+#ifndef INPUT_TRACE_H
+#define INPUT_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include "trace_ring.h"
+
+// Record of what drove the application and what it did, for replay on the host.
+// Entries are button edges, events raised by the platform (such as the display timeout), state
+// transitions and clock entries. Clock entries are anchors (the UTC second at a monotonic time,
+// written when the trace starts and whenever the clock is stepped), times entered by the user, and
+// every clock read by the application. Reads are recorded because they happen when an input is
+// serviced, not at its edge. The trace keeps the most recent TRACE_CAPACITY entries (trace_ring.h).
+// The text form is one entry per line, "<kind> <mono us> <value> <a> <b>", between
+// "trace begin" and "trace end" lines. It is printed by the device and parsed by the host replay.
+
+enum TraceKind : uint8_t {
+    TRACE_INPUT = 'I',       // a = InputSource, b = InputEdge
+    TRACE_EVENT = 'E',       // a = application event raised by the platform
+    TRACE_STATE = 'S',       // a = from (TRACE_NO_STATE at start), b = to
+    TRACE_CLOCK = 'C'        // value = UTC seconds starting at "mono", a = TRACE_CLOCK_*
+};
+
+constexpr uint8_t TRACE_NO_STATE = 0xFF;
+constexpr uint8_t TRACE_CLOCK_ANCHOR = 0;   // Where the platform's clock stood (trace start, steps)
+constexpr uint8_t TRACE_CLOCK_SET = 1;      // Time entered on the SET_TIME screen
+constexpr uint8_t TRACE_CLOCK_READ = 2;     // Time read by the application while handling the last input
+
+struct TraceEntry {
+    uint64_t mono;
+    uint32_t value;
+    TraceKind kind;
+    uint8_t a;
+    uint8_t b;
+};
+
+constexpr int TRACE_CAPACITY = 256;
+constexpr size_t TRACE_LINE_SIZE = 48;
+
+class InputTrace : public TraceRing<TraceEntry, TRACE_CAPACITY> {
+public:
+    using TraceRing::record;
+    void record(TraceKind kind, uint64_t mono, uint8_t a = 0, uint8_t b = 0, uint32_t value = 0);
+
+    // Text form of one entry
+    static void format(const TraceEntry &e, char *line, size_t size);
+    // Reads one entry back from its text form; returns false if "line" does not hold one
+    static bool parse(const char *line, TraceEntry *e);
+};
+
+#endif // INPUT_TRACE_H
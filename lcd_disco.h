@@ -0,0 +1,41 @@
+#ifndef LCD_DISCO_H
+#define LCD_DISCO_H
+
+#include "LCD_DISCO_F429ZI.h"
+#include "hal.h"
+#include "profiler.h"
+
+// HalLcd on the DISCO board's LCD (ILI9341 panel scanned out of SDRAM by the LTDC)
+class DiscoLcd : public HalLcd {
+public:
+    DiscoLcd() : fontHeight(20) {}
+
+    void clear() override {
+        ProfileProbe probe(PROFILE_LCD_CLEAR);
+        lcd.Clear(LCD_COLOR_WHITE);
+        lcd.SetTextColor(LCD_COLOR_BLACK);
+    }
+    void setFont(HalFont font) override {
+        lcd.SetFont(font == HAL_FONT_20 ? &Font20 : &Font16);
+        fontHeight = font == HAL_FONT_20 ? 20 : 16;
+    }
+    void drawCentered(int y, const char *text) override {
+        ProfileProbe probe(PROFILE_LCD_TEXT);
+        lcd.DisplayStringAt(0, y, (uint8_t *)text, CENTER_MODE);
+    }
+    int line(int n) const override { return n * fontHeight; }   // Same as the driver's LINE()
+    void displayOn() override {
+        ProfileProbe probe(PROFILE_LCD_POWER);
+        lcd.DisplayOn();
+    }
+    void displayOff() override {
+        ProfileProbe probe(PROFILE_LCD_POWER);
+        lcd.DisplayOff();
+    }
+
+private:
+    LCD_DISCO_F429ZI lcd;
+    int fontHeight;
+};
+
+#endif // LCD_DISCO_H
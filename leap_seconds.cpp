@@ -0,0 +1,99 @@
+#include "leap_seconds.h"
+#include "civil_time.h"
+#include "wallclock.h"
+
+// Midnights following each inserted leap second, from IERS Bulletin C
+static const int64_t KNOWN_LEAPS[] = {
+    78796800, 94694400, 126230400, 157766400, 189302400, 220924800, 252460800,
+    283996800, 315532800, 362793600, 394329600, 425865600, 489024000, 567993600,
+    631152000, 662688000, 709948800, 741484800, 773020800, 820454400, 867715200,
+    915148800, 1136073600, 1230768000, 1341100800, 1435708800, 1483228800,
+};
+
+LeapTable::LeapTable(LeapMode mode, uint32_t smearWindowSec)
+    : entryCount(0), leapMode(mode), halfWindowUs((int64_t)smearWindowSec * USEC_PER_SEC / 2) {
+    for (int64_t utcSec : KNOWN_LEAPS) add(utcSec, 1);
+}
+
+bool LeapTable::add(int64_t utcSec, int sign) {
+    if (utcSec % 86400 != 0 || (sign != 1 && sign != -1)) return false;
+    int pos = entryCount;
+    while (pos > 0 && entries[pos - 1].utcSec >= utcSec) {
+        if (entries[pos - 1].utcSec == utcSec) return true;
+        pos--;
+    }
+    if (entryCount >= LEAP_TABLE_CAPACITY) return false;
+    for (int i = entryCount; i > pos; i--) entries[i] = entries[i - 1];
+    entries[pos].utcSec = utcSec;
+    entries[pos].sign = (int8_t)sign;
+    entryCount++;
+    int32_t sum = 0;
+    for (int i = 0; i < entryCount; i++) {
+        entries[i].before = sum;
+        sum += entries[i].sign;
+    }
+    return true;
+}
+
+// Unix time of the first midnight of the month after the one containing "utcSec"
+static int64_t endOfMonth(int64_t utcSec) {
+    int64_t days = utcSec >= 0 ? utcSec / 86400 : (utcSec - 86399) / 86400;
+    int year, month, day;
+    civilFromDays(days, &year, &month, &day);
+    if (++month > 12) {
+        month = 1;
+        year++;
+    }
+    return daysFromCivil(year, month, 1) * 86400;
+}
+
+bool LeapTable::announce(int64_t utcNowSec, int sign) {
+    return add(endOfMonth(utcNowSec), sign);
+}
+
+int LeapTable::pending(int64_t utcNowSec) const {
+    int64_t end = endOfMonth(utcNowSec);
+    for (int i = entryCount - 1; i >= 0 && entries[i].utcSec >= end; i--) {
+        if (entries[i].utcSec == end) return entries[i].sign;
+    }
+    return 0;
+}
+
+int64_t LeapTable::toContinuous(int64_t utcUs) const {
+    // Newest entries first: the present is almost always past all of them
+    for (int i = entryCount - 1; i >= 0; i--) {
+        if (utcUs >= entries[i].utcSec * USEC_PER_SEC) {
+            return utcUs + (int64_t)(entries[i].before + entries[i].sign) * USEC_PER_SEC;
+        }
+    }
+    return utcUs;
+}
+
+// Instant on the leap-free timescale at which the leap happens: the start of the inserted second,
+// or the instant 23:59:59 would have begun for a deleted one
+int64_t LeapTable::startContinuousUs(const LeapEntry &e) const {
+    return (e.utcSec + e.before + (e.sign < 0 ? -1 : 0)) * USEC_PER_SEC;
+}
+
+int64_t LeapTable::toUtc(int64_t continuousUs) const {
+    int i = entryCount - 1;
+    int64_t margin = leapMode == LEAP_MODE_SMEAR ? halfWindowUs : 0;
+    while (i >= 0 && continuousUs < startContinuousUs(entries[i]) - margin) i--;
+    if (i < 0) return continuousUs;
+
+    const LeapEntry &e = entries[i];
+    int64_t start = startContinuousUs(e);
+    int64_t before = continuousUs - (int64_t)e.before * USEC_PER_SEC;
+    int64_t after = before - (int64_t)e.sign * USEC_PER_SEC;
+    if (leapMode == LEAP_MODE_SMEAR) {
+        // Linear ramp of the whole second across [start - half, start + half]
+        int64_t elapsed = continuousUs - (start - halfWindowUs);
+        if (halfWindowUs == 0 || elapsed >= 2 * halfWindowUs) return after;
+        return before - (int64_t)e.sign * elapsed * USEC_PER_SEC / (2 * halfWindowUs);
+    }
+    // Freeze: an inserted second shows the last microsecond of 23:59:59 until it is over
+    if (e.sign > 0 && continuousUs < start + USEC_PER_SEC) {
+        return start - (int64_t)e.before * USEC_PER_SEC - 1;
+    }
+    return after;
+}
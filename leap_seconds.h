@@ -0,0 +1,63 @@
+#ifndef LEAP_SECONDS_H
+#define LEAP_SECONDS_H
+
+#include <cstdint>
+
+// Leap-second handling.
+// UTC occasionally has a 61st second (23:59:60) or, in principle, drops 23:59:59. Neither fits the
+// HH:MM:SS display, the 0-59 field editor or the ordering of stored logs, so the firmware never
+// shows one. Internally the WallClock runs on a leap-free timescale: UTC (Unix seconds) plus the
+// number of leap seconds inserted since 1970. It never jumps, so the discipline loop, the selector and
+// the sync bus are not disturbed by a leap. Conversion back to the UTC the user sees happens on
+// read-out, where the leap second is either smeared linearly over a window centred on the leap
+// (default 24 hours, noon to noon) or absorbed by holding 23:59:59 for two seconds.
+
+enum LeapMode {
+    LEAP_MODE_SMEAR,    // Spread the leap second over the smear window (11.6 ppm for 24 hours)
+    LEAP_MODE_FREEZE    // Hold 23:59:59 through the inserted second; skip it for a deleted one
+};
+
+constexpr int LEAP_TABLE_CAPACITY = 40;
+constexpr uint32_t LEAP_SMEAR_WINDOW_SEC = 86400;
+
+struct LeapEntry {
+    int64_t utcSec;         // Unix time of the midnight that follows the leap
+    int8_t sign;            // +1 inserted second, -1 deleted second
+    int32_t before;         // Sum of the signs of all earlier entries
+};
+
+class LeapTable {
+public:
+    // Starts with every leap second announced by the IERS up to the time of writing (the last was
+    // at the end of 2016).
+    explicit LeapTable(LeapMode mode = LEAP_MODE_SMEAR, uint32_t smearWindowSec = LEAP_SMEAR_WINDOW_SEC);
+
+    // Add a leap that takes effect at the midnight "utcSec". Entries already known are ignored.
+    // Returns false if the table is full or "utcSec" is not a midnight.
+    bool add(int64_t utcSec, int sign);
+    // Sources announce a leap "at the end of the current month"; resolve that against the current UTC time.
+    bool announce(int64_t utcNowSec, int sign);
+    // Sign of a leap due at the end of the month containing "utcNowSec", 0 if none is known.
+    int pending(int64_t utcNowSec) const;
+
+    // Source UTC (Unix microseconds) to the leap-free timescale. A source reporting 23:59:60 as
+    // 00:00:00 of the next day is one second late for that second; the discipline loop rejects it as a spike.
+    int64_t toContinuous(int64_t utcUs) const;
+    // Leap-free timescale to the UTC shown and stored, with the leap second smeared or frozen.
+    // Never produces a second 60 and never runs backwards.
+    int64_t toUtc(int64_t continuousUs) const;
+
+    LeapMode mode() const { return leapMode; }
+    int count() const { return entryCount; }
+    const LeapEntry &entry(int i) const { return entries[i]; }
+
+private:
+    int64_t startContinuousUs(const LeapEntry &e) const;
+
+    LeapEntry entries[LEAP_TABLE_CAPACITY];
+    int entryCount;
+    LeapMode leapMode;
+    int64_t halfWindowUs;
+};
+
+#endif // LEAP_SECONDS_H
@@ -0,0 +1,82 @@
+#ifndef LOG_HISTOGRAM_H
+#define LOG_HISTOGRAM_H
+
+#include <cstdint>
+#include <cstring>
+
+// Log-linear histogram of 32-bit durations in constant memory.
+// Values below 4 get a bucket each; above that every power of two is split into 4 equal
+// sub-buckets, so a bucket is never wider than a quarter of its lower bound and 124 buckets cover
+// the whole 32-bit range. Adding a value is a count-leading-zeros, a shift and an increment.
+// Percentiles are answered to the upper bound of the bucket they fall in.
+
+constexpr int LOG_HISTOGRAM_SUB_BITS = 2;
+constexpr int LOG_HISTOGRAM_SUB_BUCKETS = 1 << LOG_HISTOGRAM_SUB_BITS;
+constexpr int LOG_HISTOGRAM_BUCKETS = (32 - LOG_HISTOGRAM_SUB_BITS + 1) * LOG_HISTOGRAM_SUB_BUCKETS;
+
+class LogHistogram {
+public:
+    LogHistogram() { reset(); }
+
+    void add(uint32_t value) {
+        buckets[bucketOf(value)]++;
+        count++;
+        total += value;
+        if (value < minimum) minimum = value;
+        if (value > maximum) maximum = value;
+    }
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        count = 0;
+        total = 0;
+        minimum = UINT32_MAX;
+        maximum = 0;
+    }
+
+    uint32_t samples() const { return count; }
+    uint64_t sum() const { return total; }
+    uint32_t min() const { return count ? minimum : 0; }
+    uint32_t max() const { return maximum; }
+    uint32_t bucketCount(int i) const { return buckets[i]; }
+
+    // Smallest value "p" percent of the samples do not exceed (to bucket resolution, never above max)
+    uint32_t percentile(double p) const {
+        if (count == 0) return 0;
+        uint64_t rank = (uint64_t)(p / 100.0 * count + 0.5);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint32_t upper = bucketHigh(i);
+                return upper < maximum ? upper : maximum;
+            }
+        }
+        return maximum;
+    }
+
+    static int bucketOf(uint32_t value) {
+        if (value < LOG_HISTOGRAM_SUB_BUCKETS) return (int)value;
+        int msb = 31 - __builtin_clz(value);
+        int sub = (int)(value >> (msb - LOG_HISTOGRAM_SUB_BITS)) & (LOG_HISTOGRAM_SUB_BUCKETS - 1);
+        return ((msb - LOG_HISTOGRAM_SUB_BITS + 1) << LOG_HISTOGRAM_SUB_BITS) + sub;
+    }
+    static uint32_t bucketLow(int i) {
+        if (i < LOG_HISTOGRAM_SUB_BUCKETS) return (uint32_t)i;
+        int msb = (i >> LOG_HISTOGRAM_SUB_BITS) + LOG_HISTOGRAM_SUB_BITS - 1;
+        uint32_t sub = (uint32_t)(i & (LOG_HISTOGRAM_SUB_BUCKETS - 1));
+        return (LOG_HISTOGRAM_SUB_BUCKETS + sub) << (msb - LOG_HISTOGRAM_SUB_BITS);
+    }
+    static uint32_t bucketHigh(int i) {     // Inclusive
+        return i + 1 < LOG_HISTOGRAM_BUCKETS ? bucketLow(i + 1) - 1 : UINT32_MAX;
+    }
+
+private:
+    uint32_t buckets[LOG_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint64_t total;
+    uint32_t minimum;
+    uint32_t maximum;
+};
+
+#endif // LOG_HISTOGRAM_H
@@ -0,0 +1,23 @@
+#ifndef LOG_RECORDS_H
+#define LOG_RECORDS_H
+
+#include <ctime>
+
+// Layout of the time log on the EEPROM: two fixed slots holding the latest and the previous record.
+
+constexpr int LOG_RECORD_SIZE = 20;             // "YYYY/MM/DD HH:MM:SS" plus terminator
+constexpr unsigned int LOG_LATEST_ADDR = 0;     // EEPROM address of the latest record
+constexpr unsigned int LOG_PREVIOUS_ADDR = 32;  // EEPROM address of the record before it
+
+struct StorageLogs {
+    bool ok;                                    // False if the bus reported an error
+    char latest[LOG_RECORD_SIZE];
+    char previous[LOG_RECORD_SIZE];
+};
+
+inline void formatLogRecord(const struct tm &t, char *record) {
+    strftime(record, LOG_RECORD_SIZE, "%Y/%m/%d %H:%M:%S", &t);
+    record[LOG_RECORD_SIZE - 1] = '\0';
+}
+
+#endif // LOG_RECORDS_H
@@ -0,0 +1,125 @@
+#include "log_storage.h"
+#include <cstring>
+
+LogStorage::LogStorage(HalEeprom &eeprom, EventQueue &replyQueue)
+    : eeprom(eeprom), replyQueue(replyQueue),
+      thread(osPriorityBelowNormal, 1536, nullptr, "storage"), latestDirty(false), previousDirty(false),
+      waitingCount(0), coalesced(0), queueFull(0), errors(0), replyRetry(0), watchdog(nullptr) {
+    memset(&cache, 0, sizeof(cache));
+}
+
+void LogStorage::start() {
+    thread.start(callback(this, &LogStorage::run));
+}
+
+bool LogStorage::append(const char *record, StorageCallback done) {
+    return post(OP_APPEND, record, done);
+}
+
+bool LogStorage::read(StorageCallback done) {
+    return post(OP_READ, nullptr, done);
+}
+
+bool LogStorage::flush(StorageCallback done) {
+    return post(OP_FLUSH, nullptr, done);
+}
+
+bool LogStorage::post(Op op, const char *record, StorageCallback done) {
+    Request *request = mail.try_alloc();
+    if (request == nullptr) {
+        queueFull = queueFull + 1;
+        return false;
+    }
+    request->op = op;
+    request->record[0] = '\0';
+    if (record != nullptr) {
+        strncpy(request->record, record, LOG_RECORD_SIZE - 1);
+        request->record[LOG_RECORD_SIZE - 1] = '\0';
+    }
+    request->done = done;
+    mail.put(request);
+    return true;
+}
+
+// A reply is never dropped: a StorageAwait coroutine would stay suspended and keep its frame for
+// good. If the event queue is full, wait for the main thread to make room.
+void LogStorage::complete(const StorageCallback &done) {
+    if (!done) return;
+    while (replyQueue.call(done, cache) == 0) {
+        replyRetry = replyRetry + 1;
+        if (watchdog) watchdog->checkIn(WATCHDOG_TASK_STORAGE);
+        thread_sleep_for(LOG_STORAGE_REPLY_RETRY_MS);
+    }
+}
+
+void LogStorage::run() {
+    setBusy(true);
+    cache.ok = readEeprom(LOG_LATEST_ADDR, cache.latest, LOG_RECORD_SIZE) &&
+               readEeprom(LOG_PREVIOUS_ADDR, cache.previous, LOG_RECORD_SIZE);
+    cache.latest[LOG_RECORD_SIZE - 1] = '\0';
+    cache.previous[LOG_RECORD_SIZE - 1] = '\0';
+
+    while (true) {
+        setBusy(false);
+        Request *request = mail.try_get_for(Kernel::wait_for_u32_forever);
+        setBusy(true);
+        if (request == nullptr) continue;
+        Op op = request->op;
+        StorageCallback done = request->done;
+        if (op == OP_APPEND) {
+            // An empty latest slot means there was nothing to move down (same rule as before the worker)
+            if (cache.latest[0] != '\0') {
+                memcpy(cache.previous, cache.latest, LOG_RECORD_SIZE);
+                previousDirty = true;
+            }
+            memcpy(cache.latest, request->record, LOG_RECORD_SIZE);
+            if (latestDirty) coalesced = coalesced + 1;
+            latestDirty = true;
+        }
+        mail.free(request);
+
+        if (op == OP_READ) {
+            complete(done);
+        } else {
+            if (done) waiting[waitingCount++] = done;
+            // Write once nothing else is queued, or when a flush asks for it
+            if (op == OP_FLUSH || mail.empty() || waitingCount == LOG_STORAGE_QUEUE_SIZE) writeBack();
+        }
+    }
+}
+
+void LogStorage::setBusy(bool busy) {
+    if (watchdog == nullptr) return;
+    watchdog->checkIn(WATCHDOG_TASK_STORAGE);
+    watchdog->setBusy(WATCHDOG_TASK_STORAGE, busy);
+}
+
+void LogStorage::writeBack() {
+    bool ok = true;
+    if (previousDirty) ok = writeEeprom(LOG_PREVIOUS_ADDR, cache.previous, LOG_RECORD_SIZE) && ok;
+    if (latestDirty) ok = writeEeprom(LOG_LATEST_ADDR, cache.latest, LOG_RECORD_SIZE) && ok;
+    previousDirty = false;
+    latestDirty = false;
+    cache.ok = ok;
+    for (int i = 0; i < waitingCount; i++) {
+        complete(waiting[i]);
+        waiting[i] = nullptr;
+    }
+    waitingCount = 0;
+}
+
+bool LogStorage::writeEeprom(unsigned int epAddress, const char *data, int size) {
+    bool ok = eeprom.write(epAddress, data, size);
+    if (watchdog) watchdog->checkIn(WATCHDOG_TASK_STORAGE);
+    if (!ok) errors = errors + 1;
+    return ok;
+}
+
+bool LogStorage::readEeprom(unsigned int epAddress, char *data, int size) {
+    bool ok = eeprom.read(epAddress, data, size);
+    if (!ok) {
+        errors = errors + 1;
+        data[0] = '\0';
+    }
+    return ok;
+}
@@ -0,0 +1,107 @@
+#ifndef LOG_STORAGE_H
+#define LOG_STORAGE_H
+
+#include "mbed.h"
+#include "hal.h"
+#include "log_records.h"
+#include "task_watchdog.h"
+
+// Time-log storage on the I2C EEPROM, run by its own thread.
+// The worker owns the EEPROM (on the board an I2cEeprom, a client of the shared I2C bus). Other
+// threads post read/append/flush requests through a Mail queue and never wait for the bus: each request completes by posting its callback, with the resulting records, to the caller's
+// EventQueue.
+// The worker keeps both records in RAM. Reads are answered from that copy, and appends only
+// update it. The EEPROM is written once the queue has drained, so a burst of appends costs one
+// write of each slot instead of one per append.
+
+constexpr int LOG_STORAGE_QUEUE_SIZE = 8;
+constexpr uint32_t LOG_STORAGE_REPLY_RETRY_MS = 10;   // Wait before posting a reply again to a full event queue
+
+typedef mbed::Callback<void(StorageLogs)> StorageCallback;
+
+class LogStorage {
+public:
+    LogStorage(HalEeprom &eeprom, EventQueue &replyQueue);
+
+    // Start the worker; it loads both records before serving requests.
+    void start();
+
+    // Report worker progress to "watchdog" (the worker counts as busy while it handles a request)
+    void setWatchdog(TaskWatchdog *watchdog) { this->watchdog = watchdog; }
+
+    // Each returns false without blocking if the request queue is full. "done" may be empty.
+    bool append(const char *record, StorageCallback done = nullptr);  // Latest becomes previous, "record" becomes latest
+    bool read(StorageCallback done);
+    bool flush(StorageCallback done = nullptr);                       // Completes once everything before it is on the EEPROM
+
+    uint32_t coalescedAppends() const { return coalesced; }  // Appends that never needed their own write
+    uint32_t rejected() const { return queueFull; }          // Requests refused because the queue was full
+    uint32_t busErrors() const { return errors; }
+    uint32_t replyRetries() const { return replyRetry; }     // Replies that found the event queue full and waited
+
+private:
+    enum Op { OP_READ, OP_APPEND, OP_FLUSH };
+    struct Request {
+        Op op;
+        char record[LOG_RECORD_SIZE];
+        StorageCallback done;
+    };
+
+    bool post(Op op, const char *record, StorageCallback done);
+    void run();
+    void writeBack();
+    void complete(const StorageCallback &done);
+    void setBusy(bool busy);     // Check in with the watchdog and mark the worker busy or waiting
+    bool writeEeprom(unsigned int epAddress, const char *data, int size);
+    bool readEeprom(unsigned int epAddress, char *data, int size);
+
+    HalEeprom &eeprom;
+    EventQueue &replyQueue;
+    Thread thread;
+    Mail<Request, LOG_STORAGE_QUEUE_SIZE> mail;
+    StorageLogs cache;
+    bool latestDirty;
+    bool previousDirty;
+    StorageCallback waiting[LOG_STORAGE_QUEUE_SIZE];   // Append/flush completions held until the write-back
+    int waitingCount;
+    volatile uint32_t coalesced;
+    volatile uint32_t queueFull;
+    volatile uint32_t errors;
+    volatile uint32_t replyRetry;
+    TaskWatchdog *watchdog;
+};
+
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+
+// co_await StorageAwait(storage) reads both records; StorageAwait(storage, record) appends "record".
+// Either gives the resulting StorageLogs, resumed from the reply queue. If the request queue is
+// full, the coroutine is not suspended and gets ok == false.
+class StorageAwait {
+public:
+    explicit StorageAwait(LogStorage &storage, const char *record = nullptr) : storage(storage), record(record) {
+        result.ok = false;
+        result.latest[0] = '\0';
+        result.previous[0] = '\0';
+    }
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> waiting) {
+        handle = waiting;
+        StorageCallback done = callback(this, &StorageAwait::complete);
+        return record != nullptr ? storage.append(record, done) : storage.read(done);
+    }
+    StorageLogs await_resume() { return result; }
+
+private:
+    void complete(StorageLogs logs) {
+        result = logs;
+        handle.resume();
+    }
+    LogStorage &storage;
+    const char *record;       // Copied into the request, so it only has to outlive the co_await
+    StorageLogs result;
+    std::coroutine_handle<> handle;
+};
+#endif // __cpp_impl_coroutine
+
+#endif // LOG_STORAGE_H
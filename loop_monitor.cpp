@@ -0,0 +1,91 @@
+#include "loop_monitor.h"
+#include "wallclock.h"
+
+static const char *const SOURCE_NAMES[LOOP_SOURCE_COUNT] = {"input", "periodic", "console", "sync_rx", "display", "storage"};
+static const char *const INPUT_NAMES[INPUT_SOURCE_COUNT] = {"log", "replay", "set", "inc"};
+
+LoopMonitor::LoopMonitor() : workLimit(LOOP_WORK_ALERT_US), inputLimit(LOOP_INPUT_ALERT_US) {
+    reset();
+}
+
+void LoopMonitor::reset() {
+    workHistogram.reset();
+    for (int i = 0; i < INPUT_SOURCE_COUNT; i++) latency[i].reset();
+    for (int i = 0; i < LOOP_SOURCE_COUNT; i++) {
+        sources[i].runs = 0;
+        sources[i].maxUs = 0;
+    }
+    worstSource = LOOP_INPUT;
+    worstAt = 0;
+    depth = 0;
+    alerts = 0;
+    lastAlertAt = 0;
+    alertPending = false;
+}
+
+const char *LoopMonitor::sourceName(int source) {
+    return source >= 0 && source < LOOP_SOURCE_COUNT ? SOURCE_NAMES[source] : "?";
+}
+
+const char *LoopMonitor::inputName(int source) {
+    return source >= 0 && source < INPUT_SOURCE_COUNT ? INPUT_NAMES[source] : "?";
+}
+
+void LoopMonitor::begin(LoopSource source, uint64_t mono) {
+    if (depth++ > 0) return;
+    current = source;
+    startedAt = mono;
+}
+
+void LoopMonitor::end(uint64_t mono) {
+    if (depth == 0 || --depth > 0) return;
+    uint32_t us = (uint32_t)(mono - startedAt);
+    workHistogram.add(us);
+    LoopSourceStats &s = sources[current];
+    s.runs++;
+    if (us > s.maxUs) s.maxUs = us;
+    if (us >= workHistogram.max()) {
+        worstSource = current;
+        worstAt = startedAt;
+    }
+    if (us > workLimit) raise(false, (uint8_t)current, us, workLimit, startedAt);
+}
+
+void LoopMonitor::inputServiced(InputSource source, uint64_t edgeMono, uint64_t mono) {
+    uint32_t us = mono > edgeMono ? (uint32_t)(mono - edgeMono) : 0;
+    latency[source].add(us);
+    if (us > inputLimit) raise(true, (uint8_t)source, us, inputLimit, edgeMono);
+}
+
+void LoopMonitor::setLimits(uint32_t workUs, uint32_t inputUs) {
+    workLimit = workUs;
+    inputLimit = inputUs;
+}
+
+// Alerts within the holdoff of the last reported one are only counted
+void LoopMonitor::raise(bool input, uint8_t source, uint32_t valueUs, uint32_t limitUs, uint64_t mono) {
+    alerts++;
+    if (alertPending || (lastAlertAt != 0 && mono - lastAlertAt < LOOP_ALERT_HOLDOFF_US)) return;
+    pending.mono = mono;
+    pending.valueUs = valueUs;
+    pending.limitUs = limitUs;
+    pending.input = input;
+    pending.source = source;
+    alertPending = true;
+    lastAlertAt = mono == 0 ? 1 : mono;
+}
+
+bool LoopMonitor::takeAlert(LoopAlert *out) {
+    if (!alertPending) return false;
+    *out = pending;
+    alertPending = false;
+    return true;
+}
+
+LoopProbe::LoopProbe(LoopMonitor &monitor, LoopSource source) : monitor(monitor) {
+    monitor.begin(source, monotonicMicros());
+}
+
+LoopProbe::~LoopProbe() {
+    monitor.end(monotonicMicros());
+}
@@ -0,0 +1,107 @@
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#include <cstdint>
+#include "log_histogram.h"
+#include "input_events.h"
+
+// Latency and jitter of the main event loop.
+// Each handler run from the main EventQueue is bracketed by a LoopProbe. The monitor keeps a
+// histogram of the work time per handler run, and the count and longest run per kind of handler.
+// The longest run overall is the worst stall: nothing else on the loop, button or console, could
+// run meanwhile. For every button edge it also keeps a histogram of the time from the interrupt
+// that queued the edge to the handler that serviced it, per button.
+// All times are microseconds of the monotonic clock, and the memory used is constant.
+// A handler run over the work limit, or an edge serviced later than the input limit, counts as an
+// alert. The first alert after a quiet period is kept for the owner to report (takeAlert), so a
+// burst prints one line, not one per event.
+
+enum LoopSource {
+    LOOP_INPUT,              // Button edges and the edit repeat
+    LOOP_PERIODIC,           // Jobs of the EDF scheduler
+    LOOP_CONSOLE,
+    LOOP_SYNC_RX,            // Sync bus frames
+    LOOP_DISPLAY,            // Display timeout
+    LOOP_STORAGE,            // Replies from the storage thread
+    LOOP_SOURCE_COUNT
+};
+
+constexpr uint32_t LOOP_WORK_ALERT_US = 20000;      // Default work limit: about one frame
+constexpr uint32_t LOOP_INPUT_ALERT_US = 50000;     // Default input limit: a press starts to feel slow
+constexpr uint32_t LOOP_ALERT_HOLDOFF_US = 10000000;
+
+struct LoopSourceStats {
+    uint32_t runs;
+    uint32_t maxUs;
+};
+
+struct LoopAlert {
+    uint64_t mono;           // When it happened
+    uint32_t valueUs;        // Work time or input latency
+    uint32_t limitUs;
+    bool input;              // Input latency (source is the InputSource) or work time (a LoopSource)
+    uint8_t source;
+};
+
+class LoopMonitor {
+public:
+    LoopMonitor();
+
+    // Bracket a handler run. Nested probes (a handler calling another) count once, as the outer one.
+    void begin(LoopSource source, uint64_t mono);
+    void end(uint64_t mono);
+
+    // A button edge queued at "edgeMono" by the interrupt was handled at "mono"
+    void inputServiced(InputSource source, uint64_t edgeMono, uint64_t mono);
+
+    void setLimits(uint32_t workUs, uint32_t inputUs);
+    uint32_t workLimitUs() const { return workLimit; }
+    uint32_t inputLimitUs() const { return inputLimit; }
+
+    // Returns true once per reportable alert
+    bool takeAlert(LoopAlert *out);
+    uint32_t alertCount() const { return alerts; }
+
+    const LogHistogram &work() const { return workHistogram; }
+    const LogHistogram &inputLatency(int source) const { return latency[source]; }
+    const LoopSourceStats &sourceStats(int source) const { return sources[source]; }
+    LoopSource worstStallSource() const { return worstSource; }
+    uint64_t worstStallAt() const { return worstAt; }
+    static const char *sourceName(int source);
+    static const char *inputName(int source);     // Button, by InputSource
+
+    void reset();
+
+private:
+    void raise(bool input, uint8_t source, uint32_t valueUs, uint32_t limitUs, uint64_t mono);
+
+    LogHistogram workHistogram;
+    LogHistogram latency[INPUT_SOURCE_COUNT];
+    LoopSourceStats sources[LOOP_SOURCE_COUNT];
+    LoopSource worstSource;
+    uint64_t worstAt;
+    LoopSource current;
+    uint64_t startedAt;
+    int depth;
+    uint32_t workLimit;
+    uint32_t inputLimit;
+    uint32_t alerts;
+    uint64_t lastAlertAt;
+    bool alertPending;
+    LoopAlert pending;
+};
+
+// Brackets the enclosing block as one handler run of "source"
+class LoopProbe {
+public:
+    LoopProbe(LoopMonitor &monitor, LoopSource source);
+    ~LoopProbe();
+
+    LoopProbe(const LoopProbe &) = delete;
+    LoopProbe &operator=(const LoopProbe &) = delete;
+
+private:
+    LoopMonitor &monitor;
+};
+
+#endif // LOOP_MONITOR_H
@@ -1,25 +1,106 @@
-#include "LCD_DISCO_F429ZI.h"
 #include "mbed.h"
 #include <time.h>
 #include <cstring>
 #include <cstdio>
+#include "wallclock.h"
+#include "timesync.h"
+#include "nmea.h"
+#include "gps_uart.h"
+#include "sync_stats.h"
+#include "console.h"
+#include "timecode.h"
+#include "timecode_capture.h"
+#include "clock_select.h"
+#include "clock_discipline.h"
+#include "holdover.h"
+#include "leap_seconds.h"
+#include "spsc_ring.h"
+#include "input_events.h"
+#include "debouncer.h"
+#include "i2c_bus.h"
+#include "log_storage.h"
+#include "event_delay.h"
+#include "task_watchdog.h"
+#include "edf_scheduler.h"
+#include "duty_cycle.h"
+#include "app.h"
+#include "input_trace.h"
+#include "time_snapshot.h"
+#include "lcd_disco.h"
+#include "eeprom_i2c.h"
+#include "screens.h"
+#include "profiler.h"
+#include "loop_monitor.h"
 
 // I2C and EEPROM related definitions
 #define SDA_PIN       PC_9            // I2C data pin
 #define SCL_PIN       PA_8            // I2C clock pin
 #define EEPROM_ADDR   0xA0            // EEPROM device I2C address
-#define TIME_STR_SIZE 20              // Size of time string "YYYY/MM/DD HH:MM:SS" (19 characters + NULL terminator)
-#define LOG1_ADDR     0               // EEPROM starting address for the latest log record
-#define LOG2_ADDR     32              // EEPROM starting address for the previous log record
-constexpr int DEBOUNCE_TIME_MS = 200;
+constexpr uint32_t DEBOUNCE_SAMPLE_US = 1000;   // Button sampling period while any button is moving
+constexpr uint32_t DEBOUNCE_STABLE_US = 10000;  // A level must hold this long to count as a press or release
+constexpr int SOURCE_POLL_MS = 100;     // GPS DMA ring and time-code capture ring drain interval (only when fitted)
+constexpr int UI_HEARTBEAT_MS = 1000;   // Main event queue checks in with the watchdog
+constexpr int LOG_BANNER_MS = 2000;     // How long the clock face reports a log write (C++20 builds)
+
+// Time distribution over the RS-485 bus (UART5 through a half-duplex transceiver)
+#define TIMESYNC_ROLE_MASTER   0      // This unit owns the time and broadcasts it
+#define TIMESYNC_ROLE_FOLLOWER 1      // This unit takes its time from the bus
+#ifndef TIMESYNC_ROLE
+#define TIMESYNC_ROLE TIMESYNC_ROLE_MASTER
+#endif
+#define SYNC_TX_PIN   PC_12           // UART5 TX to transceiver DI
+#define SYNC_RX_PIN   PD_2            // UART5 RX from transceiver RO
+#define SYNC_DE_PIN   PG_3            // Transceiver driver enable (high while transmitting)
+constexpr uint32_t SYNC_RX_RING_SIZE = 64; // Received bytes buffered between the UART interrupt and the main thread
+
+// Optional GPS receiver: NMEA on USART2 (see gps_uart.h) plus the 1PPS output on GPS_PPS_PIN
+#ifndef GPS_TIME_SOURCE
+#define GPS_TIME_SOURCE 0             // Set to 1 on units fitted with a GPS receiver
+#endif
+#define GPS_PPS_PIN   PB_4            // Receiver 1PPS output, rising edge marks the second
+
+// Optional time-code receiver (DCF77 module or IRIG-B DC line) on PA_5, timestamped by TIM2 input capture
+#define TIMECODE_SOURCE_NONE  0
+#define TIMECODE_SOURCE_DCF77 1
+#define TIMECODE_SOURCE_IRIGB 2
+#ifndef TIMECODE_SOURCE
+#define TIMECODE_SOURCE TIMECODE_SOURCE_NONE
+#endif
+
+// Sync-quality page on the LCD, reached from the log display with the replay button
+#ifndef SHOW_SYNC_STATS_PAGE
+#define SHOW_SYNC_STATS_PAGE 0
+#endif
+// Leap seconds: LEAP_MODE_SMEAR spreads the second over 24 hours, LEAP_MODE_FREEZE holds 23:59:59 for two seconds
+#ifndef LEAP_SECOND_MODE
+#define LEAP_SECOND_MODE LEAP_MODE_SMEAR
+#endif
+// Low-power idle: the timebase runs from the low-power ticker so the event loop can enter STOP
+// whenever nothing is due, and the LCD is switched off after DISPLAY_TIMEOUT_S without a button press
+#ifndef LOW_POWER_IDLE
+#define LOW_POWER_IDLE 0
+#endif
+constexpr int DISPLAY_TIMEOUT_S = 30;
+// Factory calibration of the internal temperature sensor (raw 12-bit readings at VDDA = 3.3 V)
+#define TS_CAL1       (*(const uint16_t *)0x1FFF7A2C)   // Reading at 30 C
+#define TS_CAL2       (*(const uint16_t *)0x1FFF7A2E)   // Reading at 110 C
+
+constexpr int CONSOLE_BAUD = 115200;  // Debug serial (ST-LINK virtual COM port) used for printf and commands
 
 // Global objects
-LCD_DISCO_F429ZI LCD;               // LCD display object
-I2C i2c(SDA_PIN, SCL_PIN);            // I2C object for communication with EEPROM
-Timeout debounce_user_button;
-Timeout debounce_replayButton;
-Timeout debounce_setTimeButton;
-Timeout debounce_incrementButton;
+DiscoLcd lcd;                       // LCD display object
+
+// All application work runs as events dispatched on the main thread. Interrupts only post events,
+// so the thread sleeps until a button, a received byte or a scheduled frame gives it something to do.
+EventQueue events(32 * EVENTS_EVENT_SIZE);
+
+// Periodic and timed work, run earliest-deadline-first on the event queue (ids are set in main)
+EdfScheduler scheduler(events);
+int tickTask = -1;
+constexpr uint32_t TICK_DEADLINE_US = 50000;          // The published and displayed second may lag the real one by this much
+constexpr uint32_t BROADCAST_DEADLINE_US = 20000;
+constexpr uint32_t SELECT_DEADLINE_US = 200000;
+constexpr uint32_t SOURCE_POLL_DEADLINE_US = 100000;
 
 // Button definitions using interrupts for asynchronous input
 InterruptIn userButton(BUTTON1);       // Button for logging current time
@@ -27,533 +108,970 @@ InterruptIn replayButton(PE_6, PullUp);  // Button to switch between log display
 InterruptIn setTimeButton(PE_4, PullUp); // Button to enter time-setting mode or move to the next editable digit
 InterruptIn incrementButton(PE_2, PullUp); // Button to increment the currently selected digit in time-setting mode
 
-// Application state machine to manage different modes
-enum AppState {
-    IDLE,        // Idle state: display current time
-    LOG_TIME,    // Log time state: save current time to EEPROM
-    DISPLAY_LOG, // Display log state: show stored log records on LCD
-    SET_TIME     // Time-setting state: allow user to adjust the system time
+// All buttons are debounced together by one sampler, indexed by InputSource. Edges only start the
+// sampler; it stops itself once every button has been stable for a full window.
+InterruptIn *const buttonPins[INPUT_SOURCE_COUNT] = {&userButton, &replayButton, &setTimeButton, &incrementButton};
+const bool buttonActiveHigh[INPUT_SOURCE_COUNT] = {true, false, false, false};  // BUTTON1 has an external pull-down
+Debouncer<INPUT_SOURCE_COUNT, DEBOUNCE_SAMPLE_US, DEBOUNCE_STABLE_US> buttonDebouncer;
+Ticker debounceTicker;
+volatile bool debounceRunning = false;
+
+// Timebase: a free-running timer provides monotonic microseconds, the WallClock layers the
+// (slewed) calendar time on top of it. The RTC is only written when the time is stepped.
+#if LOW_POWER_IDLE
+LowPowerTimer monoTimer;   // RTC-clocked, keeps counting in STOP at the cost of ~30 us resolution
+#else
+Timer monoTimer;           // Holds a deep-sleep lock while running
+#endif
+WallClock wallClock;
+// The time for every other context, published at each second tick and whenever the clock steps
+TimeSnapshotLatch timeSnapshot;
+LeapTable leapTable(LEAP_SECOND_MODE);  // Converts the leap-free clock to the UTC shown and stored
+
+// RS-485 transport: the driver is enabled only while a frame is being sent so followers can share the pair
+class Rs485Transport : public SyncTransport {
+public:
+    Rs485Transport(PinName tx, PinName rx, PinName de, int baud) : serial(tx, rx, baud), driverEnable(de, 0), baud(baud) {}
+    void send(const uint8_t *data, size_t size) override {
+        driverEnable = 1;
+        serial.write(data, size);
+        // write() returns once the last byte is in the shift register; hold the driver until it is on the wire
+        wait_us(TIMESYNC_BITS_PER_BYTE * 1000000 / baud + 1);
+        driverEnable = 0;
+    }
+    UnbufferedSerial serial;
+
+private:
+    DigitalOut driverEnable;
+    int baud;
+};
+Rs485Transport syncBus(SYNC_TX_PIN, SYNC_RX_PIN, SYNC_DE_PIN, TIMESYNC_DEFAULT_CONFIG.baud);
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_MASTER
+TimeSyncMaster syncMaster(wallClock, syncBus);
+#else
+TimeSyncFollower syncFollower(wallClock, TIMESYNC_DEFAULT_CONFIG, nullptr, false);
+#endif
+
+#if GPS_TIME_SOURCE
+InterruptIn ppsInput(GPS_PPS_PIN, PullDown);
+NmeaParser gpsParser(gpsDmaBuffer, GPS_DMA_BUFFER_SIZE);
+PpsPairing ppsPairing(10 * 1000000 / GPS_BAUD, GPS_DMA_BUFFER_SIZE);
+#endif
+
+#if TIMECODE_SOURCE == TIMECODE_SOURCE_DCF77
+Dcf77Decoder timecodeDecoder;
+#elif TIMECODE_SOURCE == TIMECODE_SOURCE_IRIGB
+IrigBDecoder timecodeDecoder;
+#endif
+
+// All sources report to the selector; once per second it intersects them and the combined
+// estimate drives the discipline loop, which is the only code that moves the wall clock
+constexpr uint32_t CLOCK_SELECT_PERIOD_US = 1000000;
+ClockSelector clockSelector(wallClock);
+ClockDiscipline clockDiscipline(wallClock);
+
+// Holdover: the rate error learned against die temperature while locked is applied when every source is lost
+AnalogIn dieTempSensor(ADC_TEMP);
+TempFrequencyModel tempModel;
+HoldoverController holdover(wallClock, tempModel);
+
+// Quality of the combined estimate that is disciplining the clock
+SyncStats syncStats(CLOCK_SELECT_PERIOD_US);
+
+// Bytes received from the bus, timestamped in the UART interrupt and parsed on the main thread
+struct SyncRxByte {
+    uint64_t mono;
+    uint8_t byte;
 };
-volatile AppState state = IDLE;   // Initialize to IDLE state
-
-// Function declarations for EEPROM read/write
-// Writes data to EEPROM. "address" is the I2C device address,
-// "ep_address" is the internal EEPROM address, "data" is the buffer to write,
-// and "size" is the number of bytes to write.
-void WriteEEPROM(int address, unsigned int ep_address, char *data, int size);
-
-// Reads data from EEPROM. "address" is the I2C device address,
-// "ep_address" is the internal EEPROM address, "data" is the buffer to store read data,
-// and "size" is the number of bytes to read.
-void ReadEEPROM(int address, unsigned int ep_address, char *data, int size);
-
-// Global variables for time setting and button events
-volatile bool incrementPressed = false;      // Flag to indicate increment button pressed in SET_TIME state
-volatile bool nextPositionPressed = false;     // Flag to indicate a request to move to the next editable digit
-char editBuffer[TIME_STR_SIZE] = {0};            // Buffer holding the time string for editing (format: "YYYY/MM/DD HH:MM:SS")
-int currentEditPos = 0;                         // Current index position in editBuffer that is being edited
-volatile bool timeSetRequested = false;         // Flag indicating a request to enter time setting mode
-volatile bool decrementPressed = false;          // Flag to indicate the decrement operation in SET_TIME mode
-
-volatile bool user_button_debouncing = false;
-volatile bool replayButton_debouncing = false;
-volatile bool setTimeButton_debouncing = false;
-volatile bool incrementButton_debouncing = false;
+SpscRing<SyncRxByte, SYNC_RX_RING_SIZE> syncRx;
+volatile bool syncRxPending = false;    // A drain event is already queued
+volatile bool consoleRxPending = false;
+
+// Debounced button edges in arrival order, pushed only by the debounce sampler
+SpscRing<InputEvent, INPUT_EVENT_RING_SIZE> inputEvents;
+volatile bool inputEventsPending = false;
+
+int editRepeatEvent = 0;    // Pending onEditRepeat event for the application's hold-to-repeat, 0 if none
+
+// Recent inputs and state transitions, dumped with "trace" for replay on the host (host/replay.cpp)
+InputTrace inputTrace;
+
+DutyCycleMeter dutyMeter;  // Time and CPU use per AppState (needs platform.cpu-stats-enabled)
+
+// The LCD controller scans the frame out of SDRAM and cannot run in STOP, so deep sleep is only
+// allowed while the display is off
+bool displayAwake = true;
+int displaySleepEvent = 0;  // Pending sleepDisplay event, 0 if none
+
+// Fed only while the UI, sync, storage and bus tasks all make progress; see task_watchdog.h
+TaskWatchdog taskWatchdog;
+
+// Work time of every handler on the main event queue and the delay of every button edge; see loop_monitor.h
+LoopMonitor loopMonitor;
+
+// I2C devices share one bus thread; the EEPROM log is its first client
+I2cBus i2cBus(SDA_PIN, SCL_PIN);
+// EEPROM log records; the storage thread replies through the event queue
+I2cEeprom eeprom(i2cBus, EEPROM_ADDR);
+LogStorage logStorage(eeprom, events);
+
+// Status line shown under the date on the clock face (nullptr for none)
+const char *clockBanner = nullptr;
+uint32_t clockBannerSerial = 0;  // Bumped by every new banner, so only the latest one clears it
 
 // Function declarations for various functionalities
-void storeCurrentTime();           // Save the current system time to EEPROM
-void displayLogs();                // Read and display stored log records from EEPROM on LCD
-void updateDisplay();              // Update the LCD with the current system time and date
-void updateSetTimeDisplay();       // Update the LCD with the time-setting interface
-bool isEditablePosition(int pos);  // Check if a given index in the time string is editable (i.e., not a separator)
-bool parseEditBufferToTm(const char *buffer, struct tm *timeinfo); // Convert the editBuffer string to a struct tm
-const char* getCurrentFieldName(int pos); // Get the name of the time field (Year, Month, etc.) based on the current edit position
-int getMaxDay(int month, int year);        // Get the maximum number of days in the given month (Note: February fixed at 28 days)
-int my_strcmp(const char *s1, const char *s2); // Custom string comparison function, similar to strcmp
-void adjustField(struct tm *timeinfo, int currentEditPos, int delta); // Adjust the corresponding field in tm by delta
-
-void debounce_user_button_callback(){
-    user_button_debouncing = false;
-}
-
-void debounce_replayButton_callback(){
-    replayButton_debouncing = false;
-}
-
-void debounce_setTimeButton_callback(){
-    setTimeButton_debouncing = false;
-}
-
-void debounce_incrementButton_callback(){
-    incrementButton_debouncing = false;
-}
-
-// Return the maximum number of days in a given month (ignores leap year for February)
-int getMaxDay(int month, int year) {
-    switch(month) {
-        case 1: case 3: case 5: case 7: case 8: case 10: case 12:
-            return 31;
-        case 4: case 6: case 9: case 11:
-            return 30;
-        case 2:
-            return 28; // Fixed 28 days for February
-        default:
-            return 31;
-    }
-}
-
-// Custom string comparison function similar to the standard strcmp.
-// Returns 0 if strings are equal, otherwise returns the difference between the first differing characters.
-int my_strcmp(const char *s1, const char *s2) {
-    while (*s1 && *s2 && (*s1 == *s2)) {
-        s1++;
-        s2++;
-    }
-    return ((unsigned char)*s1 - (unsigned char)*s2);
-}
-
-// Adjusts the appropriate field (Year, Month, Day, Hour, Minute, or Second) in the tm structure based on the current edit position.
-// "delta" indicates how much to change (positive to increase, negative to decrease).
-void adjustField(struct tm *timeinfo, int currentEditPos, int delta) {
-    // Retrieve the field name based on the current edit position.
-    const char* field = getCurrentFieldName(currentEditPos);
-    if (my_strcmp(field, "Year") == 0) {
-        // tm_year stores the number of years since 1900.
-        timeinfo->tm_year += delta;
-    } else if (my_strcmp(field, "Month") == 0) {
-        timeinfo->tm_mon += delta;
-        // Ensure month cycles within the valid range (0-11)
-        if (timeinfo->tm_mon > 11) timeinfo->tm_mon = 0;
-        else if (timeinfo->tm_mon < 0) timeinfo->tm_mon = 11;
-        // Adjust the day field if it exceeds the maximum days for the new month.
-        int max_day = getMaxDay(timeinfo->tm_mon + 1, timeinfo->tm_year + 1900);
-        if (timeinfo->tm_mday > max_day) {
-            timeinfo->tm_mday = max_day;
+void showLogs(StorageLogs logs);   // Display two log records on the LCD (if the log page is still shown)
+void broadcastTime();              // Master: send one TIME frame on the bus
+void serviceSyncRx();              // Follower: parse received bus bytes and report frames to the selector
+void pollTimeSources();            // Drain the GPS and time-code rings into the selector
+void selectClock();                // Combine the sources and steer the wall clock (once per selection period)
+void scheduleSecondTick();         // Queue the next tick just after the wall-clock second changes
+void onSecondTick();               // Publish the time snapshot and redraw the pages that show live values
+void publishTimeSnapshot();        // Publish the wall-clock time as of now
+void wakeDisplay();                // Button activity: turn the LCD on (if off) and restart the display timeout
+void sleepDisplay();               // Display timeout: turn the LCD off and allow STOP
+CpuCounters readCpuCounters();     // Uptime/idle/sleep counters kept by the platform
+uint32_t readButtons();            // Raw button levels as a bitmask indexed by InputSource
+void onButtonEdge();               // Any button edge: start the debounce sampler if it is idle
+void sampleButtons();              // Debounce sampler tick (interrupt context)
+void postInputEvent(InputSource source, InputEdge edge); // Interrupt side: record an edge and queue the drain
+void serviceInputEvents();         // Main thread: handle recorded button edges in order
+void onEditRepeat();               // Repeat event: apply the steps that fell due
+void traceClockAnchor();           // Record where the wall clock stands, so a replay can reproduce the times read
+void serviceConsole();             // Run any commands typed on the debug serial port
+void onConsoleSigio();             // Console serial interrupt: queue serviceConsole when input is waiting
+void cmdStats(const char *args);   // Console: print (or reset) the sync statistics
+void cmdTimecode(const char *args); // Console: print the time-code decoder counters
+void cmdSources(const char *args);  // Console: print the clock-selection state of every source
+void cmdHoldover(const char *args); // Console: print the holdover state and temperature model
+void cmdLeap(const char *args);     // Console: print the leap-second mode and the pending leap, if any
+void cmdRings(const char *args);    // Console: print fill level and overflow count of the interrupt rings
+void cmdStorage(const char *args);  // Console: print the storage thread counters
+void cmdDuty(const char *args);     // Console: print (or reset) the per-state duty cycle
+void cmdI2c(const char *args);      // Console: print (or reset) the I2C bus wait times per client, or dump the trace
+void cmdTasks(const char *args);    // Console: print the coroutine frame pool usage
+void cmdWatchdog(const char *args); // Console: print the watchdog task states and the last reset
+void cmdSched(const char *args);    // Console: print (or reset) the scheduler's deadline statistics
+void cmdTrace(const char *args);    // Console: dump (or clear) the input trace
+void cmdProf(const char *args);     // Console: print (or reset) the profiling histograms
+void cmdLoop(const char *args);     // Console: print (or reset) the event-loop latency figures, or set the alert limits
+void uiHeartbeat();                // Periodic: show the watchdog that the main event queue is running
+const char *resetReasonName(reset_reason_t reason);
+double readDieTemperature();       // STM32 internal temperature sensor reading in degrees C
+
+// Console commands; each handler prints its own reply
+const ConsoleCommand consoleCommands[] = {
+    {"stats", "sync offset/jitter/frequency/ADEV ('stats reset' clears)", &cmdStats},
+    {"timecode", "DCF77/IRIG-B decoder counters", &cmdTimecode},
+    {"sources", "clock sources, truechimers and falsetickers", &cmdSources},
+    {"holdover", "holdover state and temperature model", &cmdHoldover},
+    {"leap", "leap-second mode, table size and pending leap", &cmdLeap},
+    {"rings", "interrupt-to-thread ring fill and overflow counts", &cmdRings},
+    {"storage", "EEPROM log worker: coalesced appends, rejected requests, bus errors", &cmdStorage},
+    {"duty", "time, active CPU % and sleep per state ('duty reset' clears)", &cmdDuty},
+    {"i2c", "bus transactions and queue wait per client ('i2c reset' clears, 'i2c trace [clear]' dumps phases)", &cmdI2c},
+    {"tasks", "coroutine frames in use, peak and failed starts", &cmdTasks},
+    {"watchdog", "task progress, budgets and the reason for the last reset", &cmdWatchdog},
+    {"sched", "runs, deadline misses, worst lateness and run time per task ('sched reset' clears)", &cmdSched},
+    {"trace", "recent button edges and state changes for host replay ('trace clear' restarts)", &cmdTrace},
+    {"prof", "time per profiled scope ('prof <scope>' lists its histogram, 'prof reset' clears)", &cmdProf},
+    {"loop", "event-loop work time, worst stall and button latency ('loop reset', 'loop alert <work us> <input us>')", &cmdLoop},
+};
+Console console(consoleCommands, sizeof(consoleCommands) / sizeof(consoleCommands[0]));
+BufferedSerial *consoleSerial = nullptr;
+
+// Route printf through a non-blocking BufferedSerial so typed input can be read from an event
+FileHandle *mbed::mbed_override_console(int fd) {
+    static BufferedSerial serial(USBTX, USBRX, CONSOLE_BAUD);
+    consoleSerial = &serial;
+    return &serial;
+}
+
+uint64_t monotonicMicros() {
+    return (uint64_t)monoTimer.elapsed_time().count();
+}
+
+// Raw button levels, bit i = button i pressed
+uint32_t readButtons() {
+    uint32_t raw = 0;
+    for (int i = 0; i < INPUT_SOURCE_COUNT; i++) {
+        if ((buttonPins[i]->read() != 0) == buttonActiveHigh[i]) raw |= 1u << i;
+    }
+    return raw;
+}
+
+// Edge interrupt shared by all buttons: make sure the sampler is running. Bounces while it already
+// runs cost nothing beyond the interrupt entry.
+void onButtonEdge() {
+    if (!debounceRunning) {
+        debounceRunning = true;
+        debounceTicker.attach(&sampleButtons, std::chrono::microseconds(DEBOUNCE_SAMPLE_US));
+    }
+}
+
+// Sampler tick: debounce every button at once and record each settled press or release.
+// Button actions: BUTTON1 logs the time (IDLE); PE_6 shows logs or decrements (SET_TIME);
+// PE_4 enters time setting or moves to the next digit; PE_2 increments (SET_TIME).
+void sampleButtons() {
+    uint32_t raw = readButtons();
+    uint32_t changed = buttonDebouncer.sample(raw);
+    for (int i = 0; i < INPUT_SOURCE_COUNT; i++) {
+        if (changed & (1u << i)) {
+            postInputEvent((InputSource)i, (buttonDebouncer.state() & (1u << i)) ? INPUT_PRESSED : INPUT_RELEASED);
         }
-    } else if (my_strcmp(field, "Day") == 0) {
-        int max_day = getMaxDay(timeinfo->tm_mon + 1, timeinfo->tm_year + 1900);
-        timeinfo->tm_mday += delta;
-        // Cycle the day within valid limits.
-        if (timeinfo->tm_mday > max_day) timeinfo->tm_mday = 1;
-        else if (timeinfo->tm_mday < 1) timeinfo->tm_mday = max_day;
-    } else if (my_strcmp(field, "Hour") == 0) {
-        timeinfo->tm_hour += delta;
-        if (timeinfo->tm_hour > 23) timeinfo->tm_hour = 0;
-        else if (timeinfo->tm_hour < 0) timeinfo->tm_hour = 23;
-    } else if (my_strcmp(field, "Minute") == 0) {
-        timeinfo->tm_min += delta;
-        if (timeinfo->tm_min > 59) timeinfo->tm_min = 0;
-        else if (timeinfo->tm_min < 0) timeinfo->tm_min = 59;
-    } else if (my_strcmp(field, "Second") == 0) {
-        timeinfo->tm_sec += delta;
-        if (timeinfo->tm_sec > 59) timeinfo->tm_sec = 0;
-        else if (timeinfo->tm_sec < 0) timeinfo->tm_sec = 59;
-    }
-}
-
-// Interrupt handler for the userButton (BUTTON1)
-// When triggered, if in IDLE state, switch to LOG_TIME state to log the current time.
-void onUserButtonPressed() {
-    if (user_button_debouncing){
-        return;
     }
-    user_button_debouncing = true;
-    debounce_user_button.attach(&debounce_user_button_callback, std::chrono::milliseconds(DEBOUNCE_TIME_MS));
+    if (buttonDebouncer.settled()) {
+        // An edge between the read above and here would find the sampler still running, so check
+        // again with interrupts masked before stopping; a later edge restarts it
+        CriticalSectionLock lock;
+        if (readButtons() == raw) {
+            debounceTicker.detach();
+            debounceRunning = false;
+        }
+    }
+}
 
-    if (state == IDLE) {
-        state = LOG_TIME;
+// Updates the LCD with the current system time and date.
+// Retrieves the system time, formats it, and displays it on the LCD.
+void updateDisplay() {
+    TimeSnapshot now;
+    if (!timeSnapshot.read(&now)) return;          // Nothing to show before the clock is set
+    drawClockFace(lcd, now.fields, clockBanner);   // Broken-down UTC, published once per second
+    
+    //thread_sleep_for(200); // Delay for 0.1 second to update the display once per second (can use 1s if want)
+}
+
+// Formats the current time as a log record
+void formatCurrentLog(char *record) {
+    TimeSnapshot now;
+    timeSnapshot.read(&now);
+    formatLogRecord(now.fields, record);
+}
+
+#if defined(__cpp_impl_coroutine)
+// Log the time, then report on the clock face whether it reached the EEPROM.
+// Everything live across a co_await is in the frame, so the snapshot is read outside the flow and
+// only the outcome of the write is kept.
+EventTask logTimeFlow() {
+    char newLog[TIME_STR_SIZE];
+    formatCurrentLog(newLog);
+    bool logged = (co_await StorageAwait(logStorage, newLog)).ok;
+
+    uint32_t serial = ++clockBannerSerial;
+    clockBanner = logged ? "Time logged" : "Log failed";
+    if (state == IDLE && displayAwake) updateDisplay();
+    co_await EventDelay(events, std::chrono::milliseconds(LOG_BANNER_MS));
+    if (clockBannerSerial != serial) co_return;   // A newer banner owns the line
+    clockBanner = nullptr;
+    if (state == IDLE && displayAwake) updateDisplay();
+}
+
+EventTask displayLogsFlow() {
+    StorageLogs logs = co_await StorageAwait(logStorage);
+    showLogs(logs);
+}
+#endif
+
+// Saves the current system time to the EEPROM.
+// The storage thread moves the latest log to the previous slot and writes the new one as latest.
+void storeCurrentTime() {
+#if defined(__cpp_impl_coroutine)
+    logTimeFlow();
+#else
+    char newLog[TIME_STR_SIZE];
+    formatCurrentLog(newLog);
+    logStorage.append(newLog);
+#endif
+}
+
+// Asks the storage thread for both log records; they are displayed when the reply arrives.
+void displayLogs() {
+#if defined(__cpp_impl_coroutine)
+    displayLogsFlow();
+#else
+    logStorage.read(&showLogs);
+#endif
+}
+
+// Displays two log records on the LCD.
+// The function tries to parse the logs; if parsing fails, the original string is used.
+void showLogs(StorageLogs logs) {
+    LoopProbe probe(loopMonitor, LOOP_STORAGE);
+    if (state != DISPLAY_LOG) return;   // The user moved on before the reply arrived
+    drawLogs(lcd, logs.latest, logs.previous);
+    
+    //thread_sleep_for(1000); // Display logs for 1 second
+}
+
+// Updates the LCD to show the time-setting interface.
+// This includes the current editable time string and an underline indicating the current editable digit.
+void updateSetTimeDisplay() {
+    drawSetTime(lcd, editBuffer, currentEditPos);
+}
+
+// UART receive interrupt for the sync bus: timestamp each byte as it arrives and queue a drain event.
+// Bytes are dropped if the main thread falls a full ring behind; the frame CRC then rejects the damaged frame.
+void onSyncRxByte() {
+    SyncRxByte rx;
+    rx.mono = monotonicMicros();
+    while (syncBus.serial.readable()) {
+        syncBus.serial.read(&rx.byte, 1);
+        syncRx.push(rx);
+    }
+    if (!syncRxPending) {
+        syncRxPending = true;
+        events.call(&serviceSyncRx);
     }
 }
 
-// Interrupt handler for the replayButton (PE_6)
-// In SET_TIME mode, this button acts as the "decrement" action;
-// in other modes, it toggles between displaying logs and the normal IDLE display.
-void onReplayButtonPressed() {
-    if (replayButton_debouncing){
-        return;
+#if GPS_TIME_SOURCE
+// 1PPS rising edge: capture the monotonic time as close to the edge as possible, and where the
+// NMEA stream had got to
+void onPpsEdge() {
+    ppsPairing.onPps(monotonicMicros(), gpsDmaWriteIndex());
+}
+#endif
+
+time_t currentTime() {
+    return (time_t)(wallClock.utc() / USEC_PER_SEC);
+}
+
+void setSystemTime(time_t t) {
+    uint64_t mono = monotonicMicros();
+    int64_t continuousUs = leapTable.toContinuous((int64_t)t * USEC_PER_SEC);
+    wallClock.step(continuousUs, mono);
+    set_time(t);
+    traceClockAnchor();
+    // The second boundary moved with the clock
+    publishTimeSnapshot();
+    scheduleSecondTick();
+    clockSelector.addSample(CLOCK_SOURCE_MANUAL, continuousUs, mono);
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_MASTER
+    // Push the new time out right away instead of waiting for the next period
+    syncMaster.broadcast(mono);
+#endif
+}
+
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_MASTER
+void broadcastTime() {
+    LoopProbe probe(loopMonitor, LOOP_PERIODIC);
+    if (wallClock.isSet()) syncMaster.broadcast(monotonicMicros());
+}
+#endif
+
+void serviceSyncRx() {
+    LoopProbe probe(loopMonitor, LOOP_SYNC_RX);
+    // Cleared before draining so a byte arriving meanwhile queues another pass
+    syncRxPending = false;
+    SyncRxByte rx;
+    while (syncRx.pop(&rx)) {
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_FOLLOWER
+        if (syncFollower.onRxByte(rx.byte, rx.mono)) {
+            // Each repeater hop adds its own latency uncertainty
+            uint32_t hopError = (uint32_t)syncFollower.lastHops() * ClockSelector::spec(CLOCK_SOURCE_BUS).baseErrorUs;
+            clockSelector.addSample(CLOCK_SOURCE_BUS, syncFollower.lastReferenceUs(), syncFollower.lastFrameMono(), hopError);
+            // The master's time is already leap-free; only its announcement has to be copied
+            uint8_t leapFlags = syncFollower.lastLeapFlags();
+            if (leapFlags != 0) {
+                leapTable.announce(currentTime(), (leapFlags & TIMESYNC_LEAP_DELETE) ? -1 : 1);
+            }
+        }
+#endif
+    }
+}
+
+void pollTimeSources() {
+    LoopProbe probe(loopMonitor, LOOP_PERIODIC);
+#if GPS_TIME_SOURCE
+    // Sentences are parsed straight out of the DMA ring; each one that names a PPS edge is a reference point.
+    // The edge is placed in the stream first, so the sentences are paired by where they start.
+    NmeaTime gpsTime;
+    size_t gpsWriteIndex = gpsDmaWriteIndex();
+    ppsPairing.locate(gpsParser.streamPosition(gpsWriteIndex), monotonicMicros());
+    while (gpsParser.poll(gpsWriteIndex, &gpsTime)) {
+        int64_t refEpochUs;
+        uint64_t refMono;
+        if (ppsPairing.pair(gpsTime, &refEpochUs, &refMono)) {
+            clockSelector.addSample(CLOCK_SOURCE_GPS, leapTable.toContinuous(refEpochUs), refMono);
+        }
+    }
+#endif
+#if TIMECODE_SOURCE != TIMECODE_SOURCE_NONE
+    // Edges were timestamped by the capture hardware; decoding here only costs a few operations per edge
+    bool level;
+    uint64_t edgeMono;
+    while (timecodeCapturePop(&level, &edgeMono)) {
+        TimeCodeFix fix;
+        if (timecodeDecoder.onEdge(level, edgeMono, &fix)) {
+            clockSelector.addSample(CLOCK_SOURCE_TIMECODE, leapTable.toContinuous(fix.epochUs), fix.refMono);
+            if (fix.leapPending) {
+                leapTable.announce(fix.sentSec, fix.leapDelete ? -1 : 1);
+            }
+        }
     }
-    replayButton_debouncing = true;
-    debounce_replayButton.attach(&debounce_replayButton_callback, std::chrono::milliseconds(DEBOUNCE_TIME_MS));
+#endif
+}
 
+// Runs every CLOCK_SELECT_PERIOD_US so the statistics see evenly spaced samples
+void selectClock() {
+    LoopProbe probe(loopMonitor, LOOP_PERIODIC);
+    uint64_t mono = monotonicMicros();
+    taskWatchdog.checkIn(WATCHDOG_TASK_SYNC);
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_MASTER
+    // Followers learn about a coming leap second from the frames
+    int leap = leapTable.pending(currentTime());
+    syncMaster.setLeapFlags(leap > 0 ? TIMESYNC_LEAP_INSERT : leap < 0 ? TIMESYNC_LEAP_DELETE : 0);
+#endif
+    ClockEstimate estimate;
+    bool haveReference = clockSelector.select(mono, &estimate);
+    if (haveReference) {
+        syncStats.addSample(mono, estimate.offsetUs, wallClock.now(mono) + estimate.offsetUs);
+        if (holdover.active()) {
+            // Leave holdover from the frequency it was applying so the rate does not jump back
+            clockDiscipline.seedFrequency(holdover.appliedPpb());
+        }
+        uint32_t steps = clockDiscipline.steps();
+        clockDiscipline.update(estimate.offsetUs, mono);
+        if (clockDiscipline.steps() != steps) {
+            // Keep the battery-backed RTC in step when the clock jumps
+            set_time(currentTime());
+            traceClockAnchor();
+            publishTimeSnapshot();
+            scheduleSecondTick();
+        }
+    }
+    holdover.update(haveReference && clockDiscipline.locked(), readDieTemperature(), clockDiscipline.frequencyPpb(), mono);
+    wallClock.rebase(mono);
+}
+
+// The anchor is the start of the current UTC second; a replay counts on from there
+void traceClockAnchor() {
+    uint64_t mono = monotonicMicros();
+    int64_t utcUs = wallClock.utc(mono);
+    inputTrace.record(TRACE_CLOCK, mono - (uint64_t)(utcUs % USEC_PER_SEC), TRACE_CLOCK_ANCHOR, 0, (uint32_t)(utcUs / USEC_PER_SEC));
+}
+
+// Also reports the latest loop alert, at most one line per heartbeat
+void uiHeartbeat() {
+    LoopProbe probe(loopMonitor, LOOP_PERIODIC);
+    taskWatchdog.checkIn(WATCHDOG_TASK_UI);
+    LoopAlert alert;
+    if (loopMonitor.takeAlert(&alert)) {
+        printf("loop alert: %s %s %lu us (limit %lu us) at %llu us, %lu alerts so far\n",
+               alert.input ? LoopMonitor::inputName(alert.source) : LoopMonitor::sourceName(alert.source),
+               alert.input ? "waited" : "ran", (unsigned long)alert.valueUs, (unsigned long)alert.limitUs,
+               (unsigned long long)alert.mono, (unsigned long)loopMonitor.alertCount());
+    }
+}
+
+// Charge the time spent to the state being left
+void appStateChanged(int from, int to) {
+    dutyMeter.transition(from, to, readCpuCounters());
+}
+
+bool syncStatsPageEnabled() {
+    return SHOW_SYNC_STATS_PAGE;
+}
+
+CpuCounters readCpuCounters() {
+    mbed_stats_cpu_t stats;
+    mbed_stats_cpu_get(&stats);   // All zero unless CPU statistics are enabled
+    CpuCounters counters = {stats.uptime, stats.idle_time, stats.sleep_time, stats.deep_sleep_time};
+    return counters;
+}
+
+// Every button press restarts the display timeout. The event loop then enters STOP on its own when
+// no event is due and nothing holds a deep-sleep lock; the RTC wakeup timer (for the next queued
+// event) and the button EXTI lines bring it back.
+void wakeDisplay() {
+#if LOW_POWER_IDLE
+    if (displaySleepEvent != 0) events.cancel(displaySleepEvent);
+    displaySleepEvent = events.call_in(std::chrono::seconds(DISPLAY_TIMEOUT_S), &sleepDisplay);
+    if (displayAwake) return;
+    displayAwake = true;
+    sleep_manager_lock_deep_sleep();
+    lcd.displayOn();
+    consoleSerial->enable_input(true);
+    updateDisplay();
+#endif
+}
+
+void sleepDisplay() {
+    LoopProbe probe(loopMonitor, LOOP_DISPLAY);
+    displaySleepEvent = 0;
+    appDispatch(APP_EV_DISPLAY_SLEEP, monotonicMicros());   // Back to the clock face, unless editing
     if (state == SET_TIME) {
-        decrementPressed = true;
-    } else {
+        // Never drop an edit in progress; check again after another timeout
+        displaySleepEvent = events.call_in(std::chrono::seconds(DISPLAY_TIMEOUT_S), &sleepDisplay);
+        return;
+    }
+    displayAwake = false;
+    lcd.displayOff();
+    // The console receiver would hold the UART clock on; it comes back with the display
+    consoleSerial->enable_input(false);
+    sleep_manager_unlock_deep_sleep();
+}
+
+// The time only changes when the second does, so ticks are timed 1 ms after each wall-clock second
+// boundary instead of being polled
+void scheduleSecondTick() {
+    int64_t intoSecond = wallClock.utc() % USEC_PER_SEC;
+    scheduler.releaseAt(tickTask, monotonicMicros() + (USEC_PER_SEC - intoSecond) + 1000);
+}
+
+void onSecondTick() {
+    LoopProbe probe(loopMonitor, LOOP_PERIODIC);
+    publishTimeSnapshot();
+    if (displayAwake) {
         if (state == IDLE) {
-            state = DISPLAY_LOG;
-        } else if (state == DISPLAY_LOG) {
-            state = IDLE;
+            updateDisplay();
+        } else if (state == SYNC_STATS) {
+            displaySyncStats();
         }
     }
+    scheduleSecondTick();
 }
 
-// Interrupt handler for the setTimeButton (PE_4)
-// In IDLE state, it requests entry into the time setting mode;
-// in SET_TIME mode, it signals to move to the next editable digit.
-void onSetTimeButtonPressed() {
-    if (setTimeButton_debouncing){
-        return;
+void publishTimeSnapshot() {
+    uint64_t mono = monotonicMicros();
+    timeSnapshot.publish(mono, wallClock.utc(mono));
+}
+
+void postInputEvent(InputSource source, InputEdge edge) {
+    InputEvent event = {monotonicMicros(), source, edge};
+    inputEvents.push(event);
+    if (!inputEventsPending) {
+        inputEventsPending = true;
+        events.call(&serviceInputEvents);
     }
-    setTimeButton_debouncing = true;
-    debounce_setTimeButton.attach(&debounce_setTimeButton_callback, std::chrono::milliseconds(DEBOUNCE_TIME_MS));
+}
 
-    if (state == IDLE) {
-        timeSetRequested = true;
-    } else if (state == SET_TIME) {
-        nextPositionPressed = true;
+void serviceInputEvents() {
+    LoopProbe probe(loopMonitor, LOOP_INPUT);
+    inputEventsPending = false;
+    InputEvent event;
+    while (inputEvents.pop(&event)) {
+        loopMonitor.inputServiced(event.source, event.mono, monotonicMicros());
+#if LOW_POWER_IDLE
+        // A press on a dark screen only wakes it, so nothing is logged or changed blind
+        if (event.edge == INPUT_PRESSED) {
+            bool wasAwake = displayAwake;
+            wakeDisplay();
+            if (!wasAwake) continue;
+        }
+#endif
+        appHandleInput(event);
     }
 }
 
-// Interrupt handler for the incrementButton (PE_2)
-// This button increments the currently selected time digit while in SET_TIME mode.
-void onIncrementButtonPressed() {
-    if (incrementButton_debouncing){
+void armEditRepeat(uint64_t due) {
+    cancelEditRepeat();
+    uint64_t now = monotonicMicros();
+    uint64_t waitMs = due > now ? (due - now + 999) / 1000 : 0;
+    editRepeatEvent = events.call_in(std::chrono::milliseconds(waitMs), &onEditRepeat);
+}
+
+void cancelEditRepeat() {
+    if (editRepeatEvent != 0) {
+        events.cancel(editRepeatEvent);
+        editRepeatEvent = 0;
+    }
+}
+
+// Handle queued edges first, so a release that happened before now stops the count at its own time
+void onEditRepeat() {
+    LoopProbe probe(loopMonitor, LOOP_INPUT);
+    editRepeatEvent = 0;
+    serviceInputEvents();
+    appEditRepeatDue(monotonicMicros());
+}
+
+// Shows the sync-quality estimators: offset, jitter, frequency error and a few Allan deviation points
+void displaySyncStats() {
+    drawSyncStats(lcd, syncStats);
+}
+
+void cmdStats(const char *args) {
+    if (strcmp(args, "reset") == 0) {
+        syncStats.reset();
+        printf("sync statistics cleared\n");
         return;
     }
-    incrementButton_debouncing = true;
-    debounce_incrementButton.attach(&debounce_incrementButton_callback, std::chrono::milliseconds(DEBOUNCE_TIME_MS));
+    char report[512];
+    syncStats.format(report, sizeof(report));
+    printf("%s", report);
+}
 
-    if (state == SET_TIME) {
-        incrementPressed = true;
+void cmdTimecode(const char *args) {
+#if TIMECODE_SOURCE != TIMECODE_SOURCE_NONE
+    const TimeCodeCounters &c = timecodeDecoder.counters();
+    printf("frames %lu parity %lu framing %lu glitches %lu overruns %lu\n",
+           (unsigned long)c.frames, (unsigned long)c.parityErrors, (unsigned long)c.framingErrors,
+           (unsigned long)c.glitches, (unsigned long)timecodeCaptureOverruns());
+#else
+    printf("no time-code receiver in this build\n");
+#endif
+}
+
+void cmdSources(const char *args) {
+    uint64_t mono = monotonicMicros();
+    for (int i = 0; i < CLOCK_SOURCE_COUNT; i++) {
+        const ClockSourceState &src = clockSelector.source((ClockSourceId)i);
+        if (!src.valid) {
+            printf("%-9s no sample\n", ClockSelector::spec((ClockSourceId)i).name);
+            continue;
+        }
+        printf("%-9s %s age %llu ms samples %lu falseticks %lu\n", ClockSelector::spec((ClockSourceId)i).name,
+               src.truechimer ? "truechimer " : "falseticker", (unsigned long long)((mono - src.refMono) / 1000),
+               (unsigned long)src.samples, (unsigned long)src.falseticks);
     }
+    printf("preferred %s, freq %ld ppb, spikes %lu, steps %lu\n", ClockSelector::spec(clockSelector.preferred()).name,
+           (long)clockDiscipline.frequencyPpb(), (unsigned long)clockDiscipline.spikes(), (unsigned long)clockDiscipline.steps());
+#if GPS_TIME_SOURCE
+    printf("gps: %lu sentences, %lu checksum errors, %lu PPS edges not placed in the stream\n",
+           (unsigned long)gpsParser.sentences(), (unsigned long)gpsParser.checksumErrors(),
+           (unsigned long)ppsPairing.unplacedEdges());
+#endif
 }
 
-// Updates the LCD with the current system time and date.
-// Retrieves the system time, formats it, and displays it on the LCD.
-void updateDisplay() {
-    time_t rawtime;
-    time(&rawtime);                              // Get current time in seconds since epoch
-    struct tm *timeinfo = localtime(&rawtime);     // Convert to local time representation
-
-    // Extract individual time components
-    int hour = timeinfo->tm_hour;
-    int minute = timeinfo->tm_min;
-    int second = timeinfo->tm_sec;
-    int year = timeinfo->tm_year + 1900;           // tm_year stores years since 1900
-    int month = timeinfo->tm_mon + 1;              // tm_mon is 0-indexed (0-11)
-    int day = timeinfo->tm_mday;
-    
-    // Format the time string (hours, minutes, seconds)
-    char formattedTime[30];
-    sprintf(formattedTime, "%02d:%02d:%02d(H,M,S)", hour, minute, second);
-    
-    // Format the date string (year, month, day)
-    char formattedDate[30];
-    sprintf(formattedDate, "%04d/%02d/%02d(Y,M,D)", year, month, day);
-    
-    // Clear LCD and set properties before displaying
-    LCD.Clear(LCD_COLOR_WHITE);
-    LCD.SetFont(&Font20);
-    //LCD.SetBackColor(LCD_COLOR_ORANGE);
-    LCD.SetTextColor(LCD_COLOR_BLACK);
-    
-    // Display time at vertical position 80
-    LCD.DisplayStringAt(0, 80, (uint8_t*)formattedTime, CENTER_MODE);
-    // Display date at vertical position 110
-    LCD.DisplayStringAt(0, 110, (uint8_t*)formattedDate, CENTER_MODE);
-    
-    //thread_sleep_for(200); // Delay for 0.1 second to update the display once per second (can use 1s if want)
+double readDieTemperature() {
+    uint16_t raw = dieTempSensor.read_u16() >> 4;   // AnalogIn scales the 12-bit result to 16 bits
+    return 30.0 + ((int)raw - (int)TS_CAL1) * 80.0 / ((int)TS_CAL2 - (int)TS_CAL1);
 }
 
-// Saves the current system time to the EEPROM.
-// It first backs up the previous log (LOG1) to LOG2, then writes the new log to LOG1.
-void storeCurrentTime() {
-    char newLog[TIME_STR_SIZE] = {0};
-    char oldLog[TIME_STR_SIZE] = {0};
-    // Read the current latest log from EEPROM (LOG1)
-    ReadEEPROM(EEPROM_ADDR, LOG1_ADDR, oldLog, TIME_STR_SIZE);
-    oldLog[TIME_STR_SIZE - 1] = '\0';
-    if (oldLog[0] != '\0') {
-        // If LOG1 is not empty, back it up to LOG2 (previous record)
-        WriteEEPROM(EEPROM_ADDR, LOG2_ADDR, oldLog, TIME_STR_SIZE);
-        //thread_sleep_for(10);
-    }
-    // Get the current system time and format it into a string
-    time_t rawtime;
-    time(&rawtime);
-    strftime(newLog, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", localtime(&rawtime));
-    newLog[TIME_STR_SIZE - 1] = '\0';
-    // Write the new log record to EEPROM at LOG1 address
-    WriteEEPROM(EEPROM_ADDR, LOG1_ADDR, newLog, TIME_STR_SIZE);
-    //thread_sleep_for(20);
-}
-
-// Reads two log records from the EEPROM and displays them on the LCD.
-// The function tries to parse the logs; if parsing fails, the original string is used.
-void displayLogs() {
-    char log1[TIME_STR_SIZE] = {0};
-    char log2[TIME_STR_SIZE] = {0};
-    
-    // Read two log records from EEPROM: LOG1 and LOG2
-    ReadEEPROM(EEPROM_ADDR, LOG1_ADDR, log1, TIME_STR_SIZE);
-    ReadEEPROM(EEPROM_ADDR, LOG2_ADDR, log2, TIME_STR_SIZE);
-    log1[TIME_STR_SIZE - 1] = '\0';
-    log2[TIME_STR_SIZE - 1] = '\0';
-
-    char formattedLog1[TIME_STR_SIZE] = {0};
-    char formattedLog2[TIME_STR_SIZE] = {0};
-    int year, month, day, hour, minute, second;
-
-    // Attempt to parse log1 string format using sscanf
-    if (sscanf(log1, "%d/%d/%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second) == 6) {
-        sprintf(formattedLog1, "%04d/%02d/%02d %02d:%02d:%02d", 
-                year, month, day, hour, minute, second);
+void cmdHoldover(const char *args) {
+    double temp = readDieTemperature();
+    double predicted = 0;
+    bool havePrediction = tempModel.predict(temp, &predicted);
+    printf("%s, entered %lu times", holdover.active() ? "IN HOLDOVER" : "not in holdover", (unsigned long)holdover.entries());
+    if (holdover.active()) {
+        printf(" (for %llu s, applying %ld ppb)", (unsigned long long)((monotonicMicros() - holdover.holdoverStartMono()) / USEC_PER_SEC),
+               (long)holdover.appliedPpb());
+    }
+    printf("\ndie %.1f C, model order %d from %lu samples over %.1f..%.1f C", temp, tempModel.order(),
+           (unsigned long)tempModel.samples(), tempModel.minTempC(), tempModel.maxTempC());
+    if (havePrediction) printf(", predicts %.0f ppb", predicted);
+    printf("\n");
+}
+
+void cmdLeap(const char *args) {
+    time_t now = currentTime();
+    int leap = leapTable.pending(now);
+    const LeapEntry &last = leapTable.entry(leapTable.count() - 1);
+    printf("mode %s, %d leap seconds known, last before %lld\n", leapTable.mode() == LEAP_MODE_SMEAR ? "smear" : "freeze",
+           leapTable.count(), (long long)last.utcSec);
+    if (leap != 0) {
+        printf("%s second due at the end of this month\n", leap > 0 ? "inserted" : "deleted");
     } else {
-        // If parsing fails, copy the original log string
-        for (int i = 0; i < TIME_STR_SIZE - 1 && log1[i] != '\0'; i++) {
-            formattedLog1[i] = log1[i];
+        printf("no leap second pending\n");
+    }
+}
+
+void cmdRings(const char *args) {
+    printf("input    %lu/%lu queued, %lu overflows\n", (unsigned long)inputEvents.size(),
+           (unsigned long)inputEvents.capacity(), (unsigned long)inputEvents.overflows());
+    printf("sync rx  %lu/%lu queued, %lu overflows\n", (unsigned long)syncRx.size(),
+           (unsigned long)syncRx.capacity(), (unsigned long)syncRx.overflows());
+#if TIMECODE_SOURCE != TIMECODE_SOURCE_NONE
+    printf("timecode %lu overruns\n", (unsigned long)timecodeCaptureOverruns());
+#endif
+    printf("time     %lu snapshots published, %lu reads retried\n", (unsigned long)timeSnapshot.updates(),
+           (unsigned long)timeSnapshot.retries());
+}
+
+void cmdStorage(const char *args) {
+    printf("coalesced appends %lu, rejected requests %lu, bus errors %lu, reply retries %lu\n",
+           (unsigned long)logStorage.coalescedAppends(), (unsigned long)logStorage.rejected(),
+           (unsigned long)logStorage.busErrors(), (unsigned long)logStorage.replyRetries());
+}
+
+void cmdDuty(const char *args) {
+    static const char *const stateNames[] = {"idle", "log", "logs", "set", "stats"};
+    if (strcmp(args, "reset") == 0) {
+        dutyMeter.reset(readCpuCounters());
+        printf("duty cycle reset\n");
+        return;
+    }
+#if MBED_CPU_STATS_ENABLED
+    dutyMeter.transition(state, state, readCpuCounters());
+    printf("state  time s   active %%  sleep s  deep s  entries\n");
+    for (int i = 0; i <= SYNC_STATS; i++) {
+        const DutyCycle &d = dutyMeter.state(i);
+        printf("%-6s %8.1f %8.2f %8.1f %7.1f %8lu\n", stateNames[i], d.totalUs / 1e6, dutyMeter.activePercent(i),
+               d.sleepUs / 1e6, d.deepSleepUs / 1e6, (unsigned long)d.entries);
+    }
+#else
+    printf("build with platform.cpu-stats-enabled to measure the duty cycle\n");
+#endif
+}
+
+// The trace dump is the input of host/i2c_decode.cpp; the client lines name the ids it uses
+void cmdI2c(const char *args) {
+    if (strcmp(args, "reset") == 0) {
+        i2cBus.resetStats();
+        printf("i2c statistics reset\n");
+        return;
+    }
+    if (strcmp(args, "trace clear") == 0) {
+        i2cBus.clearTrace();
+        printf("i2c trace cleared\n");
+        return;
+    }
+    if (strcmp(args, "trace") == 0) {
+        static I2cTraceEntry copy[I2C_TRACE_CAPACITY];   // Too big for the main thread's stack
+        uint32_t lost;
+        int n = i2cBus.copyTrace(copy, I2C_TRACE_CAPACITY, &lost);
+        char line[I2C_TRACE_LINE_SIZE];
+        printf("i2ctrace begin %d %lu\n", n, (unsigned long)lost);
+        for (int i = 0; i < i2cBus.clientCount(); i++) printf("client %d %s\n", i, i2cBus.stats(i).name);
+        for (int i = 0; i < n; i++) {
+            I2cTrace::format(copy[i], line, sizeof(line));
+            printf("%s\n", line);
         }
-        formattedLog1[TIME_STR_SIZE - 1] = '\0';
+        printf("i2ctrace end\n");
+        return;
+    }
+    printf("client    transfers errors  avg wait us  max wait us  bus ms\n");
+    for (int i = 0; i < i2cBus.clientCount(); i++) {
+        I2cClientStats s = i2cBus.stats(i);
+        unsigned long avgWait = s.transactions ? (unsigned long)(s.totalWaitUs / s.transactions) : 0;
+        printf("%-9s %9lu %6lu %12lu %12lu %7lu\n", s.name, (unsigned long)s.transactions, (unsigned long)s.errors,
+               avgWait, (unsigned long)s.maxWaitUs, (unsigned long)(s.totalBusUs / 1000));
     }
+}
 
-    // Attempt to parse log2 string format
-    if (sscanf(log2, "%d/%d/%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second) == 6) {
-        sprintf(formattedLog2, "%04d/%02d/%02d %02d:%02d:%02d", 
-                year, month, day, hour, minute, second);
-    } else {
-        for (int i = 0; i < TIME_STR_SIZE - 1 && log2[i] != '\0'; i++) {
-            formattedLog2[i] = log2[i];
+void cmdTasks(const char *args) {
+#if defined(__cpp_impl_coroutine)
+    printf("frames %d/%d in use, peak %d, failed starts %lu\n", EventTaskPool::inUse(), EVENT_TASK_FRAMES,
+           EventTaskPool::highWater(), (unsigned long)EventTaskPool::failures());
+    printf("largest frame %u of %u bytes\n", (unsigned)EventTaskPool::largestFrame(),
+           (unsigned)EVENT_TASK_FRAME_SIZE);
+#else
+    printf("built without coroutine support (needs C++20)\n");
+#endif
+}
+
+const char *resetReasonName(reset_reason_t reason) {
+    switch (reason) {
+        case RESET_REASON_POWER_ON: return "power on";
+        case RESET_REASON_PIN_RESET: return "reset pin";
+        case RESET_REASON_SOFTWARE: return "software";
+        case RESET_REASON_WATCHDOG: return "watchdog";
+        case RESET_REASON_BROWN_OUT: return "brown-out";
+        default: return "other";
+    }
+}
+
+void cmdWatchdog(const char *args) {
+    const WatchdogReport &report = taskWatchdog.lastReset();
+    printf("last reset: %s, %lu watchdog resets recorded\n", resetReasonName(report.resetReason),
+           (unsigned long)report.watchdogResets);
+    if (report.resetReason == RESET_REASON_WATCHDOG) {
+        printf("stuck before reset:");
+        if (report.stuckTasks == 0) printf(" none (checks stopped)");
+        for (int i = 0; i < WATCHDOG_TASK_COUNT; i++) {
+            if (report.stuckTasks & (1u << i)) printf(" %s", taskWatchdog.name(i));
         }
-        formattedLog2[TIME_STR_SIZE - 1] = '\0';
+        printf("\n");
+    }
+    printf("task     progress  quiet ms  budget ms\n");
+    for (int i = 0; i < WATCHDOG_TASK_COUNT; i++) {
+        printf("%-8s %8lu %9lu %10lu%s\n", taskWatchdog.name(i), (unsigned long)taskWatchdog.progressCount(i),
+               (unsigned long)taskWatchdog.quietMs(i), (unsigned long)taskWatchdog.budgetMs(i),
+               taskWatchdog.isBusy(i) ? "  busy" : "");
     }
-    
-    // Clear LCD and set font for log display
-    LCD.Clear(LCD_COLOR_WHITE);
-    LCD.SetFont(&Font16);
-    LCD.DisplayStringAt(0, LINE(2), (uint8_t *)"Time in:H,M,S", CENTER_MODE);
-    LCD.DisplayStringAt(0, LINE(3), (uint8_t *)"Date in Y,M,D", CENTER_MODE);
-    LCD.DisplayStringAt(0, LINE(5), (uint8_t *)"Latest:", CENTER_MODE);
-    LCD.DisplayStringAt(0, LINE(7), (uint8_t *)formattedLog1, CENTER_MODE);
-    LCD.DisplayStringAt(0, LINE(9), (uint8_t *)"Previous:", CENTER_MODE);
-    LCD.DisplayStringAt(0, LINE(11), (uint8_t *)formattedLog2, CENTER_MODE);
-    
-    //thread_sleep_for(1000); // Display logs for 1 second
 }
 
-// Updates the LCD to show the time-setting interface.
-// This includes the current editable time string and an underline indicating the current editable digit.
-void updateSetTimeDisplay() {
-    LCD.Clear(LCD_COLOR_WHITE);
-    LCD.SetFont(&Font16);
-    LCD.DisplayStringAt(0, LINE(1), (uint8_t *)"Set Time:", CENTER_MODE);
-
-    // Try to parse the time data from editBuffer (expected format: "YYYY/MM/DD HH:MM:SS")
-    int year, month, day, hour, minute, second;
-    char formatted[TIME_STR_SIZE] = {0};
-    if (sscanf(editBuffer, "%d/%d/%d %d:%d:%d", 
-               &year, &month, &day, &hour, &minute, &second) == 6) {
-        // Reformat into a fixed format ensuring leading zeros where necessary
-        sprintf(formatted, "%04d/%02d/%02d %02d:%02d:%02d", 
-                year, month, day, hour, minute, second);
-    } else {
-        // If parsing fails, simply copy the editBuffer to formatted
-        for (int i = 0; i < TIME_STR_SIZE - 1 && editBuffer[i] != '\0'; i++) {
-            formatted[i] = editBuffer[i];
+void cmdSched(const char *args) {
+    if (strcmp(args, "reset") == 0) {
+        scheduler.resetStats();
+        printf("scheduler statistics reset\n");
+        return;
+    }
+    printf("task      deadline us   runs  misses skipped  worst late us  max run us\n");
+    for (int i = 0; i < scheduler.taskCount(); i++) {
+        const EdfTaskStats &s = scheduler.stats(i);
+        printf("%-9s %11lu %6lu %7lu %7lu %14ld %11lu\n", scheduler.name(i), (unsigned long)scheduler.deadlineUs(i),
+               (unsigned long)s.runs, (unsigned long)s.misses, (unsigned long)s.skipped,
+               s.runs ? (long)s.maxLatenessUs : 0L, (unsigned long)s.maxRunUs);
+    }
+}
+
+// The dump is the input of host/replay.cpp. "trace clear" starts a new recording from the current
+// state; a replay can only start from the clock face, so clear it there.
+void cmdTrace(const char *args) {
+    if (strcmp(args, "clear") == 0) {
+        inputTrace.clear();
+        inputTrace.record(TRACE_STATE, monotonicMicros(), (uint8_t)state, (uint8_t)state);
+        traceClockAnchor();
+        printf("trace cleared\n");
+        return;
+    }
+    char line[TRACE_LINE_SIZE];
+    printf("trace begin %d %lu\n", inputTrace.count(), (unsigned long)inputTrace.overwritten());
+    for (int i = 0; i < inputTrace.count(); i++) {
+        InputTrace::format(inputTrace.entry(i), line, sizeof(line));
+        printf("%s\n", line);
+    }
+    printf("trace end\n");
+}
+
+void cmdProf(const char *args) {
+    if (strcmp(args, "reset") == 0) {
+        profilerReset();
+        printf("profile reset\n");
+        return;
+    }
+    char line[96];
+    if (args[0] != '\0') {
+        int scope = profileScopeByName(args);
+        if (scope < 0) {
+            printf("unknown scope %s\n", args);
+            return;
         }
-        formatted[TIME_STR_SIZE - 1] = '\0';
+        // Only the buckets that were hit; bounds in cycles and microseconds
+        const LogHistogram &h = profileHistograms[scope];
+        printf("%s: %lu samples at %lu Hz\n", profileScopeName(scope), (unsigned long)h.samples(),
+               (unsigned long)profilerHz());
+        for (int i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            if (h.bucketCount(i) == 0) continue;
+            printf("%10lu-%-10lu %10.1f us %8lu\n", (unsigned long)LogHistogram::bucketLow(i),
+                   (unsigned long)LogHistogram::bucketHigh(i), profileMicros(LogHistogram::bucketLow(i)),
+                   (unsigned long)h.bucketCount(i));
+        }
+        return;
     }
-    
-    // Create a display buffer to show on the LCD, allowing us to mark the editable position
-    char displayBuffer[TIME_STR_SIZE];
-    for (int i = 0; i < TIME_STR_SIZE - 1 && formatted[i] != '\0'; i++) {
-        displayBuffer[i] = formatted[i];
+    printf("%s\n", PROFILE_TABLE_HEADER);
+    for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+        profileFormat(i, line, sizeof(line));
+        printf("%s\n", line);
     }
-    displayBuffer[TIME_STR_SIZE - 1] = '\0';
-    
-    // Mark the current editable digit with an underscore, if it is an editable position
-    if (currentEditPos >= 0 && currentEditPos < TIME_STR_SIZE - 1) {
-        displayBuffer[currentEditPos] = '_';
+}
+
+void cmdLoop(const char *args) {
+    if (strcmp(args, "reset") == 0) {
+        loopMonitor.reset();
+        printf("loop statistics reset\n");
+        return;
     }
-    
-    // Display the time string with the current edit indicator
-    LCD.DisplayStringAt(0, LINE(3), (uint8_t *)displayBuffer, CENTER_MODE);
-
-    // Display the name of the current field being edited (e.g., "Year", "Month")
-    char hint[30];
-    snprintf(hint, sizeof(hint), "Edit: %s", getCurrentFieldName(currentEditPos));
-    LCD.DisplayStringAt(0, LINE(5), (uint8_t *)hint, CENTER_MODE);
-}
-
-// Checks whether a given position in the time string is editable (i.e., a digit rather than a separator).
-bool isEditablePosition(int pos) {
-    // The valid editable range is from index 0 to TIME_STR_SIZE-2 (since last index is '\0')
-    if (pos < 0 || pos >= TIME_STR_SIZE - 1) return false;
-
-    // Define positions where the character is a fixed separator ('/', space, or ':')
-    int separators[] = {4, 7, 10, 13, 16};
-    for (int i = 0; i < 5; i++) {
-        if (pos == separators[i]) return false;
-    }
-    return true;
-}
-
-// Converts the time string stored in editBuffer to a struct tm.
-// Returns true if the parsing is successful, false otherwise.
-bool parseEditBufferToTm(const char *buffer, struct tm *timeinfo) {
-    memset(timeinfo, 0, sizeof(struct tm)); // Clear the structure
-    int year, mon, day, hour, min, sec;
-    // Expecting the format "YYYY/MM/DD HH:MM:SS"
-    if (sscanf(buffer, "%4d/%2d/%2d %2d:%2d:%2d", &year, &mon, &day, &hour, &min, &sec) != 6) {
-        return false;
-    }
-    // Convert the values to the tm structure (note: tm_year is years since 1900 and tm_mon is 0-based)
-    timeinfo->tm_year = year - 1900;
-    timeinfo->tm_mon = mon - 1;
-    timeinfo->tm_mday = day;
-    timeinfo->tm_hour = hour;
-    timeinfo->tm_min = min;
-    timeinfo->tm_sec = sec;
-    return true;
-}
-
-// Returns the name of the field corresponding to the current edit position.
-// For example, positions 0-3 are for the "Year", 5-6 for the "Month", etc.
-const char* getCurrentFieldName(int pos) {
-    if (pos >= 0 && pos <= 3) return "Year";      // Characters 0-3 correspond to the year
-    if (pos >= 5 && pos <= 6) return "Month";       // Characters 5-6 for month
-    if (pos >= 8 && pos <= 9) return "Day";         // Characters 8-9 for day
-    if (pos >= 11 && pos <= 12) return "Hour";      // Characters 11-12 for hour
-    if (pos >= 14 && pos <= 15) return "Minute";    // Characters 14-15 for minute
-    if (pos >= 17 && pos <= 18) return "Second";    // Characters 17-18 for second
-    return "Unknown";
-}
-
-// EEPROM Write Function:
-// Combines a 2-byte internal EEPROM address with the data to be written,
-// then writes the full buffer to the EEPROM over I2C.
-void WriteEEPROM(int address, unsigned int ep_address, char *data, int size) {
-    // Optionally lock the I2C bus for atomic operations (commented out here)
-    //i2c.lock();
-    // Prepare a buffer that includes the 2-byte internal address followed by the data
-    char i2cBuffer[size + 2];
-    i2cBuffer[0] = (unsigned char)(ep_address >> 8);   // Most significant byte of internal address
-    i2cBuffer[1] = (unsigned char)(ep_address & 0xFF);   // Least significant byte
-    for (int i = 0; i < size; i++) {
-        i2cBuffer[i + 2] = data[i];
-    }
-    int result = i2c.write(address, i2cBuffer, size + 2, false);
-    thread_sleep_for(6);
-    //i2c.unlock();
-}
-
-// EEPROM Read Function:
-// First writes the 2-byte internal EEPROM address, then reads data from that location.
-void ReadEEPROM(int address, unsigned int ep_address, char *data, int size) {
-    //i2c.lock();
-    char i2cBuffer[2];
-    i2cBuffer[0] = (unsigned char)(ep_address >> 8);   // Internal address MSB
-    i2cBuffer[1] = (unsigned char)(ep_address & 0xFF);   // Internal address LSB
-    int result = i2c.write(address, i2cBuffer, 2, false);
-    thread_sleep_for(6);
-    i2c.read(address, data, size);
-    thread_sleep_for(6);
-    //i2c.unlock();
-} 
+    unsigned long workUs, inputUs;
+    if (sscanf(args, "alert %lu %lu", &workUs, &inputUs) == 2) {
+        loopMonitor.setLimits((uint32_t)workUs, (uint32_t)inputUs);
+        printf("alert when a handler runs over %lu us or a button waits over %lu us\n", workUs, inputUs);
+        return;
+    }
+    const LogHistogram &w = loopMonitor.work();
+    printf("work us: %lu runs, mean %lu, p50 %lu, p90 %lu, p99 %lu, max %lu\n", (unsigned long)w.samples(),
+           w.samples() ? (unsigned long)(w.sum() / w.samples()) : 0UL, (unsigned long)w.percentile(50),
+           (unsigned long)w.percentile(90), (unsigned long)w.percentile(99), (unsigned long)w.max());
+    if (w.samples() > 0) {
+        printf("worst stall %lu us in %s at %llu us\n", (unsigned long)w.max(),
+               LoopMonitor::sourceName(loopMonitor.worstStallSource()), (unsigned long long)loopMonitor.worstStallAt());
+    }
+    printf("handler      runs   max us\n");
+    for (int i = 0; i < LOOP_SOURCE_COUNT; i++) {
+        const LoopSourceStats &s = loopMonitor.sourceStats(i);
+        printf("%-9s %7lu %8lu\n", LoopMonitor::sourceName(i), (unsigned long)s.runs, (unsigned long)s.maxUs);
+    }
+    printf("button   edges   p50 us   p99 us   max us\n");
+    for (int i = 0; i < INPUT_SOURCE_COUNT; i++) {
+        const LogHistogram &h = loopMonitor.inputLatency(i);
+        printf("%-7s %6lu %8lu %8lu %8lu\n", LoopMonitor::inputName(i), (unsigned long)h.samples(),
+               (unsigned long)h.percentile(50), (unsigned long)h.percentile(99), (unsigned long)h.max());
+    }
+    printf("alerts %lu (limits: work %lu us, input %lu us)\n", (unsigned long)loopMonitor.alertCount(),
+           (unsigned long)loopMonitor.workLimitUs(), (unsigned long)loopMonitor.inputLimitUs());
+}
+
+// Drain characters typed on the debug serial port without blocking other events
+// Console serial event (called from interrupt context for both receive and transmit space)
+void onConsoleSigio() {
+    if (!consoleRxPending && consoleSerial->readable()) {
+        consoleRxPending = true;
+        events.call(&serviceConsole);
+    }
+}
+
+void serviceConsole() {
+    LoopProbe probe(loopMonitor, LOOP_CONSOLE);
+    consoleRxPending = false;
+    if (consoleSerial == nullptr) return;
+    char c;
+    while (consoleSerial->readable() && consoleSerial->read(&c, 1) == 1) {
+        console.feed(c);
+    }
+}
 
 // Main entry point of the program
 int main() {
+    profilerStart(SystemCoreClock);
     // Bind button interrupts to their respective handler functions
-    userButton.fall(&onUserButtonPressed);        // Trigger logging of current time on falling edge
-    replayButton.fall(&onReplayButtonPressed);      // Trigger log display toggle or decrement action
-    setTimeButton.fall(&onSetTimeButtonPressed);    // Enter time setting mode or move to next editable digit
-    incrementButton.fall(&onIncrementButtonPressed);// Increment the current digit in SET_TIME mode
+    // Any edge on any button starts the debounce sampler
+    for (int i = 0; i < INPUT_SOURCE_COUNT; i++) {
+        buttonPins[i]->rise(&onButtonEdge);
+        buttonPins[i]->fall(&onButtonEdge);
+    }
 
     // Initialize LCD display with initial settings
-    LCD.Clear(LCD_COLOR_WHITE);
-    LCD.SetFont(&Font20);
-    //LCD.SetBackColor(LCD_COLOR_ORANGE);
-    LCD.SetTextColor(LCD_COLOR_BLACK);
+    lcd.clear();
+    lcd.setFont(HAL_FONT_20);
 
     // Set initial system time to January 1, 2025.
     tm t = {0};
     t.tm_year = 125; // 2025 (years since 1900)
     t.tm_mon = 0;    // January (months are 0-indexed)
     t.tm_mday = 1;
-    set_time(mktime(&t));  // Convert tm to time_t and set the system time
-
-    // Main application loop
-    while(1) {
-        // Check if time setting is requested while in IDLE mode.
-        // If requested, initialize the edit buffer with the current time and switch to SET_TIME state.
-        if (timeSetRequested && state == IDLE) {
-            timeSetRequested = false;
-            state = SET_TIME;
-            time_t rawtime;
-            time(&rawtime);
-            struct tm *timeinfo = localtime(&rawtime);
-            // Format the current system time into the editBuffer (ensuring proper format)
-            strftime(editBuffer, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", timeinfo);
-            currentEditPos = 0;
-            // Find the first editable digit by skipping non-editable separator positions
-            while (currentEditPos < TIME_STR_SIZE - 1 && !isEditablePosition(currentEditPos)) {
-                currentEditPos++;
-            }
-            updateSetTimeDisplay();
-        }
+    monoTimer.start();
+    dutyMeter.reset(readCpuCounters());
+    taskWatchdog.addTask(WATCHDOG_TASK_UI, "ui", 3 * UI_HEARTBEAT_MS, true);
+    taskWatchdog.addTask(WATCHDOG_TASK_SYNC, "sync", 3 * CLOCK_SELECT_PERIOD_US / 1000, true);
+    taskWatchdog.addTask(WATCHDOG_TASK_STORAGE, "storage", 2000, false);
+    taskWatchdog.addTask(WATCHDOG_TASK_I2C, "i2c", 1000, false);
+    i2cBus.setWatchdog(&taskWatchdog);
+    logStorage.setWatchdog(&taskWatchdog);
+    i2cBus.start();
+    eeprom.start();
+    logStorage.start();
+    wallClock.setLeapTable(&leapTable);
+    setSystemTime(mktime(&t));  // Convert tm to time_t and set the system time
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_FOLLOWER
+    // Only followers listen; an attached receive interrupt keeps the UART clocked and blocks STOP
+    syncBus.serial.attach(&onSyncRxByte, SerialBase::RxIrq);
+#endif
+    printf("clock started, type help for commands\n");   // First printf also opens the console
+    taskWatchdog.start();
+    if (taskWatchdog.lastReset().resetReason == RESET_REASON_WATCHDOG) cmdWatchdog("");
+    consoleSerial->set_blocking(false);
+    consoleSerial->sigio(&onConsoleSigio);
+#if GPS_TIME_SOURCE
+    ppsInput.rise(&onPpsEdge);
+    gpsUartStart();
+#endif
+#if TIMECODE_SOURCE != TIMECODE_SOURCE_NONE
+    timecodeCaptureStart();
+#endif
 
-        // Execute state-specific operations
-        if (state == LOG_TIME) {
-            storeCurrentTime();  // Save the current time into EEPROM
-            state = IDLE;        // Return to IDLE state after logging
-        } 
-        if (state == DISPLAY_LOG) {
-            displayLogs();       // Show the stored log records on the LCD
-        } 
-        if (state == SET_TIME) {
-            // Handle increment operation: if the increment button was pressed
-            if (incrementPressed) {
-                incrementPressed = false;
-                struct tm currentTime;
-                if (parseEditBufferToTm(editBuffer, &currentTime)) {
-                    // Increase the currently selected field by 1
-                    adjustField(&currentTime, currentEditPos, 1);
-                    // Reformat the new time into the editBuffer
-                    strftime(editBuffer, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", &currentTime);
-                }
-                updateSetTimeDisplay();
-            }
-            
-            // Handle decrement operation: if the decrement flag was set (triggered by replayButton in SET_TIME)
-            if (decrementPressed) {
-                decrementPressed = false;
-                struct tm currentTime;
-                if (parseEditBufferToTm(editBuffer, &currentTime)) {
-                    // Decrease the currently selected field by 1
-                    adjustField(&currentTime, currentEditPos, -1);
-                    strftime(editBuffer, TIME_STR_SIZE, "%Y/%m/%d %H:%M:%S", &currentTime);
-                }
-                updateSetTimeDisplay();
-            }
-            
-            // Handle moving to the next editable digit position:
-            // If the nextPosition flag is set, either save the new time or move to the next digit.
-            if (nextPositionPressed) {
-                nextPositionPressed = false;
-                
-                // If we are at the last editable position (the second digit of seconds)
-                if (currentEditPos == 18) {
-                    // Parse the edited time, set the system time, and exit SET_TIME mode
-                    struct tm newTime;
-                    if (parseEditBufferToTm(editBuffer, &newTime)) {
-                        time_t newTimeT = mktime(&newTime);
-                        set_time(newTimeT);
-                    }
-                    state = IDLE;
-                } else {
-                    // Otherwise, cycle to the next editable digit (skip over non-editable separator positions)
-                    int startPos = currentEditPos;
-                    do {
-                        currentEditPos = (currentEditPos + 1) % (TIME_STR_SIZE - 1);
-                        if (currentEditPos == startPos) break; // Prevent infinite loop if no editable position found
-                    } while (!isEditablePosition(currentEditPos));
-                }
-                updateSetTimeDisplay();
-            }
-        }
-        // In IDLE state, continuously update the display with the current time
-        if (state == IDLE) {
-            updateDisplay();
-        }
-        thread_sleep_for(50);  // Delay 50 ms in the main loop to reduce CPU load
-    }
+    // Periodic and timed work; everything else is queued by interrupts
+    tickTask = scheduler.addTask("tick", &onSecondTick, 0, TICK_DEADLINE_US);
+#if TIMESYNC_ROLE == TIMESYNC_ROLE_MASTER
+    scheduler.addTask("broadcast", &broadcastTime, TIMESYNC_DEFAULT_CONFIG.periodMs * 1000, BROADCAST_DEADLINE_US);
+#endif
+#if GPS_TIME_SOURCE || TIMECODE_SOURCE != TIMECODE_SOURCE_NONE
+    scheduler.addTask("sources", &pollTimeSources, SOURCE_POLL_MS * 1000, SOURCE_POLL_DEADLINE_US);
+#endif
+    scheduler.addTask("select", &selectClock, CLOCK_SELECT_PERIOD_US, SELECT_DEADLINE_US);
+    scheduler.addTask("heartbeat", &uiHeartbeat, UI_HEARTBEAT_MS * 1000, UI_HEARTBEAT_MS * 1000);
+    scheduler.start();
+    appSetTrace(&inputTrace);
+    appStart(monotonicMicros());     // Draws the clock face
+    scheduleSecondTick();
+#if LOW_POWER_IDLE
+    // The display starts on: hold STOP off until its first timeout
+    sleep_manager_lock_deep_sleep();
+    wakeDisplay();
+#endif
+
+    // The main thread sleeps here until an event is due
+    events.dispatch_forever();
     return 0;
 }
@@ -0,0 +1,213 @@
+#include "nmea.h"
+#include "civil_time.h"
+
+static int hexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+NmeaParser::NmeaParser(const uint8_t *ring, size_t size)
+    : ring(ring), mask(size - 1), readPos(0), inSentence(false), inChecksum(false), checksum(0),
+      received(0), checksumDigits(0), sentenceStart(0), fieldCount(0), sentenceCount(0),
+      checksumErrorCount(0), overlongCount(0) {
+}
+
+int NmeaParser::fieldLength(int field) const {
+    // fieldStart[field + 1] points just past the separator that ended "field"
+    return (int)(fieldStart[field + 1] - fieldStart[field]) - 1;
+}
+
+// Reads "digits" decimal digits starting "offset" bytes into "field"
+bool NmeaParser::readNumber(int field, int digits, int offset, int *value) const {
+    if (field >= fieldCount || offset + digits > fieldLength(field)) return false;
+    int result = 0;
+    for (int i = 0; i < digits; i++) {
+        uint8_t c = at(fieldStart[field] + offset + i);
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+    }
+    *value = result;
+    return true;
+}
+
+// Decodes an "hhmmss[.sss]" field
+bool NmeaParser::decodeTime(int field, NmeaTime *out, int *hour, int *minute, int *second) const {
+    if (!readNumber(field, 2, 0, hour) || !readNumber(field, 2, 2, minute) || !readNumber(field, 2, 4, second)) {
+        return false;
+    }
+    out->fracUs = 0;
+    int length = fieldLength(field);
+    if (length > 7 && at(fieldStart[field] + 6) == '.') {
+        int scale = 100000;
+        for (int i = 7; i < length && scale > 0; i++, scale /= 10) {
+            uint8_t c = at(fieldStart[field] + i);
+            if (c < '0' || c > '9') return false;
+            out->fracUs += (c - '0') * scale;
+        }
+    }
+    return *hour < 24 && *minute < 60 && *second < 61;
+}
+
+bool NmeaParser::decode(NmeaTime *out) const {
+    // Field 0 is the address: two talker characters followed by the sentence formatter
+    if (fieldLength(0) != 5) return false;
+    size_t name = fieldStart[0] + 2;
+    int hour, minute, second, day, month, year;
+    if (at(name) == 'R' && at(name + 1) == 'M' && at(name + 2) == 'C') {
+        // $--RMC,hhmmss.ss,A,llll.ll,a,yyyyy.yy,a,x.x,x.x,ddmmyy,...
+        if (fieldCount < 10 || !decodeTime(1, out, &hour, &minute, &second)) return false;
+        if (!readNumber(9, 2, 0, &day) || !readNumber(9, 2, 2, &month) || !readNumber(9, 2, 4, &year)) return false;
+        year += 2000;
+        out->type = NMEA_RMC;
+        out->valid = fieldLength(2) == 1 && at(fieldStart[2]) == 'A';
+    } else if (at(name) == 'Z' && at(name + 1) == 'D' && at(name + 2) == 'A') {
+        // $--ZDA,hhmmss.ss,dd,mm,yyyy,zh,zm
+        if (fieldCount < 5 || !decodeTime(1, out, &hour, &minute, &second)) return false;
+        if (!readNumber(2, 2, 0, &day) || !readNumber(3, 2, 0, &month) || !readNumber(4, 4, 0, &year)) return false;
+        out->type = NMEA_ZDA;
+        out->valid = true;
+    } else {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    out->epochSec = civilToEpoch(year, month, day, hour, minute, second);
+    return true;
+}
+
+size_t NmeaParser::streamPosition(size_t writeIndex) const {
+    // readPos runs freely; bring the DMA index into the same lap
+    size_t pos = (readPos & ~mask) | (writeIndex & mask);
+    if (pos < readPos) pos += mask + 1;
+    return pos;
+}
+
+bool NmeaParser::poll(size_t writeIndex, NmeaTime *out) {
+    size_t target = streamPosition(writeIndex);
+
+    while (readPos != target) {
+        size_t pos = readPos++;
+        uint8_t c = at(pos);
+
+        if (c == '$') {
+            // A '$' always starts a new sentence, abandoning any partial one
+            inSentence = true;
+            inChecksum = false;
+            checksum = 0;
+            sentenceStart = pos;
+            fieldStart[0] = pos + 1;
+            fieldCount = 1;
+            continue;
+        }
+        if (!inSentence) continue;
+
+        if (pos - sentenceStart >= NMEA_MAX_SENTENCE) {
+            inSentence = false;
+            overlongCount++;
+            continue;
+        }
+
+        if (inChecksum) {
+            int digit = hexValue(c);
+            if (checksumDigits < 2 && digit >= 0) {
+                received = (uint8_t)((received << 4) | digit);
+                checksumDigits++;
+                continue;
+            }
+            // Sentence ends at the first byte after the two checksum digits (normally CR)
+            inSentence = false;
+            if (checksumDigits != 2 || received != checksum) {
+                checksumErrorCount++;
+                continue;
+            }
+            sentenceCount++;
+            out->startPos = sentenceStart;
+            if (decode(out)) return true;
+            continue;
+        }
+
+        if (c == '*') {
+            inChecksum = true;
+            received = 0;
+            checksumDigits = 0;
+            fieldStart[fieldCount] = pos + 1;
+            continue;
+        }
+        if (c == '\r' || c == '\n') {
+            // Sentences without a checksum are not trusted for time
+            inSentence = false;
+            checksumErrorCount++;
+            continue;
+        }
+        checksum ^= c;
+        if (c == ',') {
+            if (fieldCount < NMEA_MAX_FIELDS) {
+                fieldStart[fieldCount++] = pos + 1;
+            }
+        }
+    }
+    return false;
+}
+
+PpsPairing::PpsPairing(uint32_t byteUs, size_t ringSize, int labelOffsetSec)
+    : byteUs(byteUs), mask(ringSize - 1), labelOffsetSec(labelOffsetSec), edgeMono(0), edgeIndex(0), edgeCount(0),
+      locatedCount(0), edgeNext(0), edgesPlaced(0), locatePos(0), locateMono(0), lastPairedPps(0), unplaced(0) {
+}
+
+void PpsPairing::locate(size_t streamPos, uint64_t mono) {
+    locatePos = streamPos;
+    locateMono = mono;
+    // The edge is written by an interrupt; read it again if one came in between
+    uint32_t count;
+    uint64_t edge;
+    size_t index;
+    do {
+        count = edgeCount;
+        edge = edgeMono;
+        index = edgeIndex;
+    } while (count != edgeCount);
+    if (count == locatedCount || edge > mono) return;
+
+    // At most one byte per byteUs has arrived since the edge, plus the one being received
+    size_t back = (streamPos - index) & mask;
+    uint64_t maxBytes = (mono - edge) / byteUs + 1;
+    if (back > maxBytes) {
+        // Either the edge came after the index was read and is placed next time, or the
+        // index has lapped the ring since the edge and its position cannot be known
+        if (mono - edge < byteUs) return;
+        unplaced++;
+    } else if (maxBytes > mask) {
+        unplaced++;
+    } else {
+        edges[edgeNext].mono = edge;
+        edges[edgeNext].pos = streamPos - back;
+        edgeNext = (edgeNext + 1) % EDGE_HISTORY;
+        if (edgesPlaced < EDGE_HISTORY) edgesPlaced++;
+    }
+    locatedCount = count;
+}
+
+bool PpsPairing::pair(const NmeaTime &time, int64_t *refEpochUs, uint64_t *refMono) {
+    if (!time.valid) return false;
+    // Newest edge at or before the '$' (positions are free-running, so compare differences)
+    const Edge *edge = nullptr;
+    for (int i = 1; i <= edgesPlaced; i++) {
+        const Edge &e = edges[(edgeNext - i + EDGE_HISTORY) % EDGE_HISTORY];
+        if (time.startPos - e.pos <= locatePos - e.pos) {
+            edge = &e;
+            break;
+        }
+    }
+    if (edge == nullptr || edge->mono == lastPairedPps) return false;
+
+    // Latest instant the '$' can have arrived: every byte after it took at least byteUs on the wire
+    uint64_t after = (uint64_t)(locatePos - time.startPos - 1) * byteUs;
+    uint64_t latest = locateMono > after ? locateMono - after : 0;
+    if (latest > edge->mono && latest - edge->mono > PAIR_WINDOW_US) return false;
+
+    lastPairedPps = edge->mono;
+    *refEpochUs = (time.epochSec + labelOffsetSec) * 1000000;
+    *refMono = edge->mono;
+    return true;
+}
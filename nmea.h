@@ -0,0 +1,130 @@
+#ifndef NMEA_H
+#define NMEA_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Zero-copy NMEA 0183 time parser.
+// The GPS UART is received by DMA into a circular buffer; the parser walks that buffer in place,
+// tracking field boundaries as ring indices and converting digits directly from the ring.
+// Nothing is copied out of the DMA buffer and no sscanf is used. Only $--RMC and $--ZDA are
+// decoded (any talker ID, e.g. GP or GN); other sentences are checksummed and skipped.
+
+constexpr size_t NMEA_MAX_SENTENCE = 82;   // Longest legal sentence including "$" and CR LF
+constexpr int NMEA_MAX_FIELDS = 20;        // Fields tracked per sentence (RMC has 13)
+
+enum NmeaSentence {
+    NMEA_NONE,
+    NMEA_RMC,
+    NMEA_ZDA
+};
+
+// UTC time carried by one sentence.
+struct NmeaTime {
+    NmeaSentence type;
+    int64_t epochSec;   // Seconds since the Unix epoch
+    int32_t fracUs;     // Sub-second part of the time field (normally 0 when aligned to PPS)
+    bool valid;         // RMC status 'A', or a complete ZDA date
+    size_t startPos;    // Free-running ring position of the sentence's '$'
+};
+
+class NmeaParser {
+public:
+    // "ring" is the DMA target buffer; "size" must be a power of two.
+    NmeaParser(const uint8_t *ring, size_t size);
+
+    // Scan newly written bytes up to "writeIndex" (the DMA write position).
+    // Returns true as soon as one time sentence has been decoded into "out"; call again until it
+    // returns false to drain everything that has arrived.
+    bool poll(size_t writeIndex, NmeaTime *out);
+
+    // Free-running position (as in NmeaTime::startPos) of the DMA write index "writeIndex"
+    size_t streamPosition(size_t writeIndex) const;
+
+    uint32_t sentences() const { return sentenceCount; }
+    uint32_t checksumErrors() const { return checksumErrorCount; }
+    uint32_t overlongErrors() const { return overlongCount; }
+
+private:
+    uint8_t at(size_t pos) const { return ring[pos & mask]; }
+    bool readNumber(int field, int digits, int offset, int *value) const;
+    int fieldLength(int field) const;
+    bool decode(NmeaTime *out) const;
+    bool decodeTime(int field, NmeaTime *out, int *hour, int *minute, int *second) const;
+
+    const uint8_t *ring;
+    size_t mask;
+    size_t readPos;          // Next byte to examine (free-running, wrapped through mask)
+    bool inSentence;
+    bool inChecksum;
+    uint8_t checksum;        // Running XOR of the bytes between '$' and '*'
+    uint8_t received;        // Checksum digits as transmitted
+    int checksumDigits;
+    size_t sentenceStart;    // Position of the '$'
+    size_t fieldStart[NMEA_MAX_FIELDS + 1]; // Ring position of each field's first byte; one extra for the end
+    int fieldCount;
+    uint32_t sentenceCount;
+    uint32_t checksumErrorCount;
+    uint32_t overlongCount;
+};
+
+// Pairs decoded sentences with the PPS edge they describe.
+// A receiver reports the time of a pulse in the sentences that follow it, so a sentence labels the
+// last edge before its '$' arrived. The edge interrupt latches the DMA write index along with the
+// capture time, which puts the edge between two bytes of the stream. The main thread pins it to a
+// free-running stream position with locate(), before it parses, while fewer than a ring's worth of
+// bytes can have arrived since. An edge that waited longer is dropped: its lap would be a guess.
+// The sentence must also have started within PAIR_WINDOW_US of its edge. The latest the '$' can
+// have arrived is the locate() time less the wire time of every byte after it, so a sentence that
+// is not known to be that early is not paired. A missed pulse then costs a second of GPS
+// references rather than putting them a second out. "labelOffsetSec" covers receivers that instead
+// announce the time of the next pulse (set to -1 for those).
+class PpsPairing {
+public:
+    static constexpr uint64_t PAIR_WINDOW_US = 950000;
+    static constexpr int EDGE_HISTORY = 4;
+
+    // "byteUs" is the wire time of one byte (10 bits at the UART's baud rate), rounded down;
+    // "ringSize" is the DMA ring's size.
+    PpsPairing(uint32_t byteUs, size_t ringSize, int labelOffsetSec = 0);
+
+    // Called from the PPS edge interrupt with the monotonic capture time and the DMA write index.
+    void onPps(uint64_t mono, size_t ringIndex) {
+        edgeMono = mono;
+        edgeIndex = ringIndex;
+        edgeCount = edgeCount + 1;
+    }
+
+    // Places the latest edge in the stream. "streamPos" is the parser's position of a DMA write
+    // index read just before the monotonic time "mono"; call before parsing up to that index.
+    void locate(size_t streamPos, uint64_t mono);
+
+    // Returns true and fills the reference instant when "time" pairs with a PPS edge.
+    // Each edge is used once, so RMC and ZDA for the same second do not produce two corrections.
+    bool pair(const NmeaTime &time, int64_t *refEpochUs, uint64_t *refMono);
+
+    uint32_t unplacedEdges() const { return unplaced; }
+
+private:
+    struct Edge {
+        uint64_t mono;
+        size_t pos;
+    };
+
+    uint32_t byteUs;
+    size_t mask;
+    int labelOffsetSec;
+    volatile uint64_t edgeMono;          // Written by the edge interrupt
+    volatile size_t edgeIndex;
+    volatile uint32_t edgeCount;
+    uint32_t locatedCount;               // edgeCount when the last edge was placed or dropped
+    Edge edges[EDGE_HISTORY];            // Placed edges, newest at edges[(edgeNext - 1) % EDGE_HISTORY]
+    int edgeNext;
+    int edgesPlaced;
+    size_t locatePos;
+    uint64_t locateMono;
+    uint64_t lastPairedPps;
+    uint32_t unplaced;
+};
+
+#endif // NMEA_H
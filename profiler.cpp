@@ -0,0 +1,69 @@
+#include "profiler.h"
+#include <cstdio>
+#include <cstring>
+#if !(defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__))
+#include <ctime>
+#endif
+
+LogHistogram profileHistograms[PROFILE_SCOPE_COUNT];
+
+static const char *const SCOPE_NAMES[PROFILE_SCOPE_COUNT] = {
+    "ee_read", "ee_write", "lcd_clear", "lcd_text", "lcd_power", "page",
+};
+static uint32_t counterHz = 1000000000;
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+constexpr uintptr_t DEMCR_ADDR = 0xE000EDFC;     // Debug Exception and Monitor Control
+constexpr uint32_t DEMCR_TRCENA = 1u << 24;      // Enables the DWT and ITM blocks
+constexpr uintptr_t DWT_CTRL_ADDR = 0xE0001000;
+constexpr uint32_t DWT_CTRL_CYCCNTENA = 1u << 0;
+
+void profilerStart(uint32_t hz) {
+    counterHz = hz;
+    *(volatile uint32_t *)DEMCR_ADDR |= DEMCR_TRCENA;
+    *(volatile uint32_t *)DWT_CYCCNT_ADDR = 0;
+    *(volatile uint32_t *)DWT_CTRL_ADDR |= DWT_CTRL_CYCCNTENA;
+}
+#else
+void profilerStart(uint32_t) {
+    counterHz = 1000000000;
+}
+
+uint32_t profileNow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+uint32_t profilerHz() {
+    return counterHz;
+}
+
+const char *profileScopeName(int scope) {
+    return scope >= 0 && scope < PROFILE_SCOPE_COUNT ? SCOPE_NAMES[scope] : "?";
+}
+
+int profileScopeByName(const char *name) {
+    for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) {
+        if (strcmp(name, SCOPE_NAMES[i]) == 0) return i;
+    }
+    return -1;
+}
+
+void profilerReset() {
+    for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) profileHistograms[i].reset();
+}
+
+double profileMicros(uint32_t counts) {
+    return counts * 1e6 / counterHz;
+}
+
+int profileFormat(int scope, char *out, size_t size) {
+    const LogHistogram &h = profileHistograms[scope];
+    double mean = h.samples() ? (double)h.sum() / h.samples() : 0;
+    return snprintf(out, size, "%-10s %7lu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f", SCOPE_NAMES[scope],
+                    (unsigned long)h.samples(), mean * 1e6 / counterHz, profileMicros(h.min()),
+                    profileMicros(h.percentile(50)), profileMicros(h.percentile(90)),
+                    profileMicros(h.percentile(99)), profileMicros(h.max()));
+}
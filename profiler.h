@@ -0,0 +1,69 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "log_histogram.h"
+
+// Scoped profiling probes with a histogram of the time spent per scope.
+// On the Cortex-M4 the clock is the DWT cycle counter (CYCCNT), so a probe costs two register
+// reads, a subtraction and a histogram update. On the host, clock_gettime stands in, counting
+// nanoseconds. A scope is entered by constructing a ProfileProbe and left when it goes out of
+// scope:
+//
+//     { ProfileProbe probe(PROFILE_EEPROM_WRITE); ... }
+//
+// Each scope's histogram is updated by one thread at a time. The counts are plain words, so two
+// threads in the same scope at once can lose a sample but never corrupt the table. Durations are
+// 32-bit, which at 180 MHz means scopes of up to 23 s. The host's nanosecond count is truncated to
+// 32 bits as well, so there scopes wrap after 4.29 s.
+
+enum ProfileScope {
+    PROFILE_EEPROM_READ,     // I2cEeprom::read: address write and data read on the bus
+    PROFILE_EEPROM_WRITE,    // I2cEeprom::write: page write and the write cycle
+    PROFILE_LCD_CLEAR,       // Clearing the frame buffer
+    PROFILE_LCD_TEXT,        // One string drawn
+    PROFILE_LCD_POWER,       // Display on or off
+    PROFILE_PAGE_DRAW,       // A whole page in screens.cpp
+    PROFILE_SCOPE_COUNT
+};
+
+extern LogHistogram profileHistograms[PROFILE_SCOPE_COUNT];
+
+// Start the counter. "hz" is its rate (SystemCoreClock on the board); the host ignores it and
+// counts nanoseconds.
+void profilerStart(uint32_t hz);
+uint32_t profilerHz();
+const char *profileScopeName(int scope);
+int profileScopeByName(const char *name);    // -1 if unknown
+void profilerReset();
+
+// One line of the per-scope table: count, then mean, min, p50, p90, p99 and max in microseconds
+constexpr const char *PROFILE_TABLE_HEADER = "scope        count   mean us    min us    p50 us    p90 us    p99 us    max us";
+int profileFormat(int scope, char *out, size_t size);
+double profileMicros(uint32_t counts);
+
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+constexpr uintptr_t DWT_CYCCNT_ADDR = 0xE0001004;
+
+inline uint32_t profileNow() {
+    return *(volatile uint32_t *)DWT_CYCCNT_ADDR;
+}
+#else
+uint32_t profileNow();
+#endif
+
+class ProfileProbe {
+public:
+    explicit ProfileProbe(ProfileScope scope) : scope(scope), start(profileNow()) {}
+    ~ProfileProbe() { profileHistograms[scope].add(profileNow() - start); }
+
+    ProfileProbe(const ProfileProbe &) = delete;
+    ProfileProbe &operator=(const ProfileProbe &) = delete;
+
+private:
+    ProfileScope scope;
+    uint32_t start;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,137 @@
+#include "screens.h"
+#include <cstdio>
+#include "app.h"
+#include "profiler.h"
+
+// Formats the time and date and displays them on the LCD.
+void drawClockFace(HalLcd &lcd, const struct tm &t, const char *banner) {
+    ProfileProbe probe(PROFILE_PAGE_DRAW);
+    // Extract individual time components
+    int hour = t.tm_hour;
+    int minute = t.tm_min;
+    int second = t.tm_sec;
+    int year = t.tm_year + 1900;           // tm_year stores years since 1900
+    int month = t.tm_mon + 1;              // tm_mon is 0-indexed (0-11)
+    int day = t.tm_mday;
+
+    // Format the time string (hours, minutes, seconds). Both buffers have room for three
+    // full-range ints, so nothing is cut off whatever the fields hold.
+    char formattedTime[44];
+    snprintf(formattedTime, sizeof(formattedTime), "%02d:%02d:%02d(H,M,S)", hour, minute, second);
+
+    // Format the date string (year, month, day)
+    char formattedDate[44];
+    snprintf(formattedDate, sizeof(formattedDate), "%04d/%02d/%02d(Y,M,D)", year, month, day);
+
+    // Clear LCD and set properties before displaying
+    lcd.clear();
+    lcd.setFont(HAL_FONT_20);
+
+    // Display time at vertical position 80
+    lcd.drawCentered(80, formattedTime);
+    // Display date at vertical position 110
+    lcd.drawCentered(110, formattedDate);
+    if (banner != nullptr) {
+        lcd.setFont(HAL_FONT_16);
+        lcd.drawCentered(150, banner);
+    }
+}
+
+// Reformats a stored record with leading zeros; if parsing fails, the original string is used.
+static void formatStoredRecord(const char *log, char *formatted) {
+    int year, month, day, hour, minute, second;
+    if (sscanf(log, "%d/%d/%d %d:%d:%d", &year, &month, &day, &hour, &minute, &second) == 6) {
+        snprintf(formatted, TIME_STR_SIZE, "%04d/%02d/%02d %02d:%02d:%02d",
+                 year, month, day, hour, minute, second);
+    } else {
+        // If parsing fails, copy the original log string
+        for (int i = 0; i < TIME_STR_SIZE - 1 && log[i] != '\0'; i++) {
+            formatted[i] = log[i];
+        }
+        formatted[TIME_STR_SIZE - 1] = '\0';
+    }
+}
+
+// Displays two log records on the LCD.
+void drawLogs(HalLcd &lcd, const char *latest, const char *previous) {
+    ProfileProbe probe(PROFILE_PAGE_DRAW);
+    char formattedLog1[TIME_STR_SIZE] = {0};
+    char formattedLog2[TIME_STR_SIZE] = {0};
+    formatStoredRecord(latest, formattedLog1);
+    formatStoredRecord(previous, formattedLog2);
+
+    // Clear LCD and set font for log display
+    lcd.clear();
+    lcd.setFont(HAL_FONT_16);
+    lcd.drawCentered(lcd.line(2), "Time in:H,M,S");
+    lcd.drawCentered(lcd.line(3), "Date in Y,M,D");
+    lcd.drawCentered(lcd.line(5), "Latest:");
+    lcd.drawCentered(lcd.line(7), formattedLog1);
+    lcd.drawCentered(lcd.line(9), "Previous:");
+    lcd.drawCentered(lcd.line(11), formattedLog2);
+}
+
+// Shows the time-setting interface: the editable time string with an underline marking the
+// current editable digit.
+void drawSetTime(HalLcd &lcd, const char *editBuffer, int editPos) {
+    ProfileProbe probe(PROFILE_PAGE_DRAW);
+    lcd.clear();
+    lcd.setFont(HAL_FONT_16);
+    lcd.drawCentered(lcd.line(1), "Set Time:");
+
+    // Try to parse the time data from editBuffer (expected format: "YYYY/MM/DD HH:MM:SS")
+    int year, month, day, hour, minute, second;
+    char formatted[TIME_STR_SIZE] = {0};
+    if (sscanf(editBuffer, "%d/%d/%d %d:%d:%d",
+               &year, &month, &day, &hour, &minute, &second) == 6) {
+        // Reformat into a fixed format ensuring leading zeros where necessary
+        snprintf(formatted, sizeof(formatted), "%04d/%02d/%02d %02d:%02d:%02d",
+                 year, month, day, hour, minute, second);
+    } else {
+        // If parsing fails, simply copy the editBuffer to formatted
+        for (int i = 0; i < TIME_STR_SIZE - 1 && editBuffer[i] != '\0'; i++) {
+            formatted[i] = editBuffer[i];
+        }
+        formatted[TIME_STR_SIZE - 1] = '\0';
+    }
+
+    // Create a display buffer to show on the LCD, allowing us to mark the editable position
+    char displayBuffer[TIME_STR_SIZE] = {0};
+    for (int i = 0; i < TIME_STR_SIZE - 1 && formatted[i] != '\0'; i++) {
+        displayBuffer[i] = formatted[i];
+    }
+    displayBuffer[TIME_STR_SIZE - 1] = '\0';
+
+    // Mark the current editable digit with an underscore, if it is an editable position
+    if (editPos >= 0 && editPos < TIME_STR_SIZE - 1) {
+        displayBuffer[editPos] = '_';
+    }
+
+    // Display the time string with the current edit indicator
+    lcd.drawCentered(lcd.line(3), displayBuffer);
+
+    // Display the name of the current field being edited (e.g., "Year", "Month")
+    char hint[30];
+    snprintf(hint, sizeof(hint), "Edit: %s", getCurrentFieldName(editPos));
+    lcd.drawCentered(lcd.line(5), hint);
+}
+
+void drawSyncStats(HalLcd &lcd, const SyncStats &stats) {
+    ProfileProbe probe(PROFILE_PAGE_DRAW);
+    char line[32];
+    lcd.clear();
+    lcd.setFont(HAL_FONT_16);
+    lcd.drawCentered(lcd.line(1), "Sync quality");
+    snprintf(line, sizeof(line), "Offset %lld us", (long long)stats.lastOffsetUs());
+    lcd.drawCentered(lcd.line(3), line);
+    snprintf(line, sizeof(line), "Jitter %.1f us", stats.rmsJitterUs());
+    lcd.drawCentered(lcd.line(4), line);
+    snprintf(line, sizeof(line), "Freq %.0f ppb", stats.frequencyErrorPpb());
+    lcd.drawCentered(lcd.line(5), line);
+    // Every other tau keeps the page readable: 1, 4, 16 and 64 sample intervals
+    for (int i = 0; i < SYNC_STATS_TAU_COUNT; i += 2) {
+        AllanPoint p = stats.allan(i);
+        snprintf(line, sizeof(line), "ADEV %3.0fs %.2e", p.tauSec, p.adev);
+        lcd.drawCentered(lcd.line(7 + i / 2), line);
+    }
+}
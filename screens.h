@@ -0,0 +1,19 @@
+#ifndef SCREENS_H
+#define SCREENS_H
+
+#include <ctime>
+#include "hal.h"
+#include "sync_stats.h"
+
+// The LCD pages, drawn through HalLcd so they render the same on the board and on the host.
+
+// Clock face: time and date, with an optional status line under them (nullptr for none)
+void drawClockFace(HalLcd &lcd, const struct tm &t, const char *banner);
+// The two log records; either is shown as stored if it does not parse as a time
+void drawLogs(HalLcd &lcd, const char *latest, const char *previous);
+// Time-setting screen: "editBuffer" with the digit at "editPos" marked, and the field's name
+void drawSetTime(HalLcd &lcd, const char *editBuffer, int editPos);
+// Sync quality: offset, jitter, frequency error and a few Allan deviation points
+void drawSyncStats(HalLcd &lcd, const SyncStats &stats);
+
+#endif // SCREENS_H
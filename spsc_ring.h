@@ -0,0 +1,54 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer ring.
+// One context pushes (an interrupt, or several interrupts at the same priority, which cannot preempt
+// each other) and one pops (the main thread). Neither side blocks or masks interrupts. The indices run
+// freely and are masked on access, so all N slots are usable and full is told apart from empty without
+// a spare slot. N must be a power of two.
+template <typename T, uint32_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    // Producer side. When the ring is full the entry is dropped and counted; returns false.
+    bool push(const T &item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        // Publish the slot contents before the new head
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T *item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        *item = slots[t & (N - 1)];
+        // Hand the slot back only after it has been copied out
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    uint32_t overflows() const { return dropped.load(std::memory_order_relaxed); }   // Entries lost to a full ring
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head;     // Next slot to write, written only by the producer
+    std::atomic<uint32_t> tail;     // Next slot to read, written only by the consumer
+    std::atomic<uint32_t> dropped;  // Written only by the producer
+};
+
+#endif // SPSC_RING_H
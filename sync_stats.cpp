@@ -0,0 +1,106 @@
+#include "sync_stats.h"
+#include <cmath>
+#include <cstdio>
+
+SyncStats::SyncStats(uint32_t nominalIntervalUs, double smoothing)
+    : nominalUs(nominalIntervalUs), alpha(smoothing) {
+    reset();
+}
+
+void SyncStats::reset() {
+    sampleCount = 0;
+    gapCount = 0;
+    lastOffset = 0;
+    minOffset = 0;
+    maxOffset = 0;
+    meanOffset = 0;
+    jitterSq = 0;
+    freqPpb = 0;
+    lastMono = 0;
+    lastPhase = 0;
+    phaseOrigin = 0;
+    phaseHead = 0;
+    phaseFill = 0;
+    for (int i = 0; i < SYNC_STATS_TAU_COUNT; i++) {
+        adevSum[i] = 0;
+        adevTerms[i] = 0;
+    }
+}
+
+void SyncStats::addSample(uint64_t mono, int64_t offsetUs, int64_t referenceUs) {
+    int64_t phaseUs = referenceUs - (int64_t)mono;
+
+    if (sampleCount == 0) {
+        meanOffset = (double)offsetUs;
+        minOffset = maxOffset = offsetUs;
+        phaseOrigin = phaseUs;
+    } else {
+        double diff = (double)(offsetUs - lastOffset);
+        meanOffset += alpha * ((double)offsetUs - meanOffset);
+        jitterSq += alpha * (diff * diff - jitterSq);
+        if (offsetUs < minOffset) minOffset = offsetUs;
+        if (offsetUs > maxOffset) maxOffset = offsetUs;
+
+        uint64_t dt = mono - lastMono;
+        if (dt > 0) {
+            double rate = (double)(phaseUs - lastPhase) * 1e9 / (double)dt;
+            freqPpb = (sampleCount == 1) ? rate : freqPpb + alpha * (rate - freqPpb);
+        }
+
+        // ADEV assumes evenly spaced phase; a missed sample (or a burst) restarts the history
+        if (dt > nominalUs + nominalUs / 2 || dt < nominalUs / 2) {
+            gapCount++;
+            phaseFill = 0;
+        }
+    }
+    sampleCount++;
+    lastOffset = offsetUs;
+    lastMono = mono;
+    lastPhase = phaseUs;
+
+    // Store phase in seconds relative to the first sample so doubles keep full resolution
+    double x = (double)(phaseUs - phaseOrigin) * 1e-6;
+    phase[phaseHead] = x;
+    phaseHead = (phaseHead + 1) % SYNC_STATS_HISTORY;
+    if (phaseFill < SYNC_STATS_HISTORY) phaseFill++;
+
+    // For each tau = m * tau0 add the newest overlapping second difference x[n] - 2x[n-m] + x[n-2m]
+    int newest = (phaseHead + SYNC_STATS_HISTORY - 1) % SYNC_STATS_HISTORY;
+    for (int i = 0; i < SYNC_STATS_TAU_COUNT; i++) {
+        int m = 1 << i;
+        if (phaseFill <= 2 * m) break;
+        double xm = phase[(newest + SYNC_STATS_HISTORY - m) % SYNC_STATS_HISTORY];
+        double x2m = phase[(newest + SYNC_STATS_HISTORY - 2 * m) % SYNC_STATS_HISTORY];
+        double d = x - 2 * xm + x2m;
+        adevSum[i] += d * d;
+        adevTerms[i]++;
+    }
+}
+
+double SyncStats::rmsJitterUs() const {
+    return std::sqrt(jitterSq);
+}
+
+AllanPoint SyncStats::allan(int index) const {
+    AllanPoint point;
+    double tau = (double)(1 << index) * nominalUs * 1e-6;
+    point.tauSec = tau;
+    point.terms = adevTerms[index];
+    point.adev = point.terms > 0 ? std::sqrt(adevSum[index] / (2.0 * tau * tau * point.terms)) : 0.0;
+    return point;
+}
+
+int SyncStats::format(char *out, size_t size) const {
+    int n = snprintf(out, size,
+                     "samples %lu gaps %lu\n"
+                     "offset last %lld us mean %.1f us min %lld max %lld\n"
+                     "jitter %.1f us rms, freq %.1f ppb\n",
+                     (unsigned long)sampleCount, (unsigned long)gapCount,
+                     (long long)lastOffset, meanOffset, (long long)minOffset, (long long)maxOffset,
+                     rmsJitterUs(), freqPpb);
+    for (int i = 0; i < SYNC_STATS_TAU_COUNT && n > 0 && (size_t)n < size; i++) {
+        AllanPoint p = allan(i);
+        n += snprintf(out + n, size - n, "adev tau %4.0f s: %.3e (%lu)\n", p.tauSec, p.adev, (unsigned long)p.terms);
+    }
+    return n;
+}
@@ -0,0 +1,71 @@
+#ifndef SYNC_STATS_H
+#define SYNC_STATS_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Streaming estimators of synchronization quality.
+// Every sample is one comparison against a reference (a bus frame or a GPS second).
+// Memory is fixed and each sample costs O(1) work per estimator: exponentially weighted
+// mean/jitter/frequency, plus overlapping Allan deviation at SYNC_STATS_TAU_COUNT averaging
+// times held in one fixed phase history.
+
+constexpr int SYNC_STATS_TAU_COUNT = 7;                                 // tau = 1, 2, 4 ... 64 sample intervals
+constexpr int SYNC_STATS_MAX_M = 1 << (SYNC_STATS_TAU_COUNT - 1);       // Largest averaging factor
+constexpr int SYNC_STATS_HISTORY = 2 * SYNC_STATS_MAX_M + 1;            // Phase samples needed for the largest tau
+
+struct AllanPoint {
+    double tauSec;
+    double adev;        // Overlapping Allan deviation (dimensionless); 0 until enough samples
+    uint32_t terms;     // Second differences accumulated
+};
+
+class SyncStats {
+public:
+    // "nominalIntervalUs" is the expected spacing of samples (the master broadcast period);
+    // "smoothing" is the weight of the newest sample in the exponential averages.
+    explicit SyncStats(uint32_t nominalIntervalUs = 1000000, double smoothing = 1.0 / 16);
+
+    // Add one comparison: "offsetUs" is reference minus local wall clock at monotonic instant "mono",
+    // "referenceUs" the reference time itself. The free-running phase (reference minus monotonic)
+    // is derived from the two, so corrections applied to the wall clock do not pollute the ADEV.
+    void addSample(uint64_t mono, int64_t offsetUs, int64_t referenceUs);
+    void reset();
+
+    uint32_t samples() const { return sampleCount; }
+    uint32_t gaps() const { return gapCount; }
+    int64_t lastOffsetUs() const { return lastOffset; }
+    double meanOffsetUs() const { return meanOffset; }
+    double rmsJitterUs() const;         // RMS of successive offset differences (RFC 5905 style)
+    double frequencyErrorPpb() const { return freqPpb; }   // Raw timebase rate error against the reference
+    int64_t minOffsetUs() const { return minOffset; }
+    int64_t maxOffsetUs() const { return maxOffset; }
+    AllanPoint allan(int index) const;
+
+    // Multi-line human readable report; returns the number of characters written.
+    int format(char *out, size_t size) const;
+
+private:
+    uint32_t nominalUs;
+    double alpha;
+    uint32_t sampleCount;
+    uint32_t gapCount;
+    int64_t lastOffset;
+    int64_t minOffset;
+    int64_t maxOffset;
+    double meanOffset;
+    double jitterSq;
+    double freqPpb;
+    uint64_t lastMono;
+    int64_t lastPhase;
+
+    // Phase history (reference minus monotonic, relative to the first sample) for ADEV
+    int64_t phaseOrigin;
+    double phase[SYNC_STATS_HISTORY];
+    int phaseHead;      // Slot the next phase goes into
+    int phaseFill;      // Valid entries, saturates at SYNC_STATS_HISTORY
+    double adevSum[SYNC_STATS_TAU_COUNT];
+    uint32_t adevTerms[SYNC_STATS_TAU_COUNT];
+};
+
+#endif // SYNC_STATS_H
@@ -0,0 +1,82 @@
+#include "task_watchdog.h"
+
+static uint32_t readBackup(int reg) {
+    return (&RTC->BKP0R)[reg];
+}
+
+static void writeBackup(int reg, uint32_t value) {
+    (&RTC->BKP0R)[reg] = value;
+}
+
+TaskWatchdog::TaskWatchdog() : recorded(false) {
+    report.resetReason = RESET_REASON_UNKNOWN;
+    report.stuckTasks = 0;
+    report.watchdogResets = 0;
+    for (int i = 0; i < WATCHDOG_TASK_COUNT; i++) {
+        names[i] = "";
+        budget[i] = 0;
+        periodic[i] = false;
+        progress[i] = 0;
+        busy[i] = false;
+        seen[i] = 0;
+        quiet[i] = 0;
+    }
+}
+
+void TaskWatchdog::addTask(WatchdogTask task, const char *name, uint32_t budgetMs, bool isPeriodic) {
+    names[task] = name;
+    budget[task] = budgetMs;
+    periodic[task] = isPeriodic;
+}
+
+void TaskWatchdog::start() {
+    // The backup registers sit behind the backup-domain write protection
+    __HAL_RCC_PWR_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+
+    report.resetReason = ResetReason::get();
+    if (readBackup(WATCHDOG_BKP_MAGIC) != WATCHDOG_MAGIC) {
+        writeBackup(WATCHDOG_BKP_RESETS, 0);
+        writeBackup(WATCHDOG_BKP_STUCK, 0);
+        writeBackup(WATCHDOG_BKP_MAGIC, WATCHDOG_MAGIC);
+    }
+    if (report.resetReason == RESET_REASON_WATCHDOG) {
+        report.stuckTasks = readBackup(WATCHDOG_BKP_STUCK);
+        writeBackup(WATCHDOG_BKP_RESETS, readBackup(WATCHDOG_BKP_RESETS) + 1);
+    }
+    report.watchdogResets = readBackup(WATCHDOG_BKP_RESETS);
+    writeBackup(WATCHDOG_BKP_STUCK, 0);
+    writeBackup(WATCHDOG_BKP_RESET_REASON, (uint32_t)report.resetReason);
+
+    Watchdog::get_instance().start(WATCHDOG_TIMEOUT_MS);
+    ticker.attach(callback(this, &TaskWatchdog::check), std::chrono::milliseconds(WATCHDOG_CHECK_MS));
+}
+
+// Ticker interrupt. Once a task is found stuck the IWDG is left to expire. If every task recovers
+// first, kicking resumes and the record is withdrawn.
+void TaskWatchdog::check() {
+    uint32_t stuck = 0;
+    for (int i = 0; i < WATCHDOG_TASK_COUNT; i++) {
+        if (budget[i] == 0) continue;
+        uint32_t p = progress[i];
+        if (p != seen[i]) {
+            seen[i] = p;
+            quiet[i] = 0;
+        } else if (periodic[i] || busy[i]) {
+            quiet[i] += WATCHDOG_CHECK_MS;
+        } else {
+            quiet[i] = 0;    // Idle worker waiting for a request
+        }
+        if (quiet[i] > budget[i]) stuck |= 1u << i;
+    }
+    if (stuck == 0) {
+        if (recorded) {
+            recorded = false;
+            writeBackup(WATCHDOG_BKP_STUCK, 0);
+        }
+        Watchdog::get_instance().kick();
+        return;
+    }
+    recorded = true;
+    writeBackup(WATCHDOG_BKP_STUCK, readBackup(WATCHDOG_BKP_STUCK) | stuck);
+}
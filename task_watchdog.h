@@ -0,0 +1,74 @@
+#ifndef TASK_WATCHDOG_H
+#define TASK_WATCHDOG_H
+
+#include "mbed.h"
+
+// Independent watchdog that is fed only while every monitored task is making progress.
+// Each task bumps its progress counter as it works. A periodic task must check in within its
+// budget. A worker task is only held to its budget while it is marked busy, so it may wait for
+// work indefinitely. A low-power ticker interrupt checks the counters every WATCHDOG_CHECK_MS. It
+// kicks the IWDG only if no task is over budget. Otherwise it records the stuck tasks in an RTC
+// backup register and lets the IWDG reset the chip. The backup domain survives the reset, so the
+// next boot can report why the chip restarted and which task had hung.
+
+enum WatchdogTask {
+    WATCHDOG_TASK_UI,        // Main event queue
+    WATCHDOG_TASK_SYNC,      // Clock selection and discipline
+    WATCHDOG_TASK_STORAGE,   // EEPROM log thread
+    WATCHDOG_TASK_I2C,       // I2C bus thread
+    WATCHDOG_TASK_COUNT
+};
+
+constexpr uint32_t WATCHDOG_TIMEOUT_MS = 4000;   // IWDG period; must exceed the largest budget plus one check
+constexpr uint32_t WATCHDOG_CHECK_MS = 500;
+
+// RTC backup registers used (BKP16R..BKP19R; the rest are free)
+constexpr int WATCHDOG_BKP_RESET_REASON = 16;    // reset_reason_t of the last boot
+constexpr int WATCHDOG_BKP_RESETS = 17;          // Watchdog resets since the backup domain was powered up
+constexpr int WATCHDOG_BKP_STUCK = 18;           // Bit per WatchdogTask found stuck before the reset
+constexpr int WATCHDOG_BKP_MAGIC = 19;
+constexpr uint32_t WATCHDOG_MAGIC = 0x57444F47;  // "WDOG": the registers above are valid
+
+struct WatchdogReport {
+    reset_reason_t resetReason;  // Why this boot happened
+    uint32_t stuckTasks;         // For a watchdog reset: tasks over budget (0 = the check itself stopped)
+    uint32_t watchdogResets;
+};
+
+class TaskWatchdog {
+public:
+    TaskWatchdog();
+
+    // budgetMs: longest silence allowed. periodic: held to the budget all the time, otherwise only while busy.
+    void addTask(WatchdogTask task, const char *name, uint32_t budgetMs, bool periodic);
+
+    // Read and update the backup registers, then start the IWDG and the check ticker
+    void start();
+
+    // Any thread or interrupt
+    void checkIn(WatchdogTask task) { progress[task] = progress[task] + 1; }
+    void setBusy(WatchdogTask task, bool isBusy) { busy[task] = isBusy; }
+
+    const WatchdogReport &lastReset() const { return report; }
+    const char *name(int task) const { return names[task]; }
+    uint32_t progressCount(int task) const { return progress[task]; }
+    uint32_t quietMs(int task) const { return quiet[task]; }
+    uint32_t budgetMs(int task) const { return budget[task]; }
+    bool isBusy(int task) const { return busy[task]; }
+
+private:
+    void check();
+
+    LowPowerTicker ticker;     // Does not block STOP; the IWDG keeps counting there
+    WatchdogReport report;
+    const char *names[WATCHDOG_TASK_COUNT];
+    uint32_t budget[WATCHDOG_TASK_COUNT];        // 0 = not monitored
+    bool periodic[WATCHDOG_TASK_COUNT];
+    volatile uint32_t progress[WATCHDOG_TASK_COUNT];
+    volatile bool busy[WATCHDOG_TASK_COUNT];
+    uint32_t seen[WATCHDOG_TASK_COUNT];          // Progress at the last check
+    uint32_t quiet[WATCHDOG_TASK_COUNT];         // Time since progress was last seen
+    bool recorded;
+};
+
+#endif // TASK_WATCHDOG_H
@@ -0,0 +1,31 @@
+#include "time_snapshot.h"
+#include "civil_time.h"
+
+void TimeSnapshotLatch::publish(uint64_t mono, int64_t utcUs) {
+    TimeSnapshot next;
+    next.mono = mono;
+    next.utcUs = utcUs;
+    next.epoch = (time_t)(utcUs >= 0 ? utcUs / 1000000 : (utcUs - 999999) / 1000000);
+    epochToTm(next.epoch, &next.fields);
+
+    // The slots are plain memory; the fences keep the copies on their side of each sequence bump
+    uint32_t s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);   // Readers move to slot 1
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    slots[0] = next;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    sequence.store(s + 2, std::memory_order_relaxed);   // Back to slot 0
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    slots[1] = next;
+}
+
+bool TimeSnapshotLatch::read(TimeSnapshot *out) const {
+    while (true) {
+        uint32_t s = sequence.load(std::memory_order_acquire);
+        if (s < 2) return false;    // Slot 1 is only valid once the first publish has finished
+        *out = slots[s & 1];
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sequence.load(std::memory_order_relaxed) == s) return true;
+        retried.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef TIME_SNAPSHOT_H
+#define TIME_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+// The current time, published once per second for any context to read without locks or syscalls.
+// localtime() returns a shared static struct tm and is not safe from interrupts or several threads.
+// The main thread instead publishes (UTC microseconds, seconds, broken-down fields, monotonic time)
+// here at every second rollover and whenever the clock is stepped.
+// The snapshot is a seqlock with two copies (a "latch"). The writer updates one copy while readers
+// use the other, bumping the sequence number before each copy. A reader copies the slot the
+// sequence points at and retries if the sequence moved meanwhile. So an interrupt that preempts
+// the writer never waits for it, and a reader never sees a half-written snapshot.
+
+struct TimeSnapshot {
+    uint64_t mono;           // Monotonic time the snapshot was taken at
+    int64_t utcUs;           // Civil UTC at "mono" (epoch microseconds)
+    time_t epoch;            // utcUs in whole seconds
+    struct tm fields;        // "epoch" broken down (UTC)
+};
+
+class TimeSnapshotLatch {
+public:
+    TimeSnapshotLatch() : sequence(0), retried(0) {}
+
+    // Writer side, one context only
+    void publish(uint64_t mono, int64_t utcUs);
+
+    // Any context. Returns false until the first snapshot has been published.
+    bool read(TimeSnapshot *out) const;
+
+    uint32_t updates() const { return sequence.load(std::memory_order_relaxed) / 2; }
+    uint32_t retries() const { return retried.load(std::memory_order_relaxed); }  // Reads that overlapped an update
+
+private:
+    TimeSnapshot slots[2];
+    std::atomic<uint32_t> sequence;   // Odd: slot 0 is being written, even: slot 1 is
+    mutable std::atomic<uint32_t> retried;
+};
+
+#endif // TIME_SNAPSHOT_H
@@ -0,0 +1,248 @@
+#include "timecode.h"
+#include "civil_time.h"
+
+// DCF77 pulse timing (microseconds). Receiver modules round the edges, so the windows are generous.
+constexpr uint64_t DCF_GLITCH_US = 40000;          // Shorter pulses are noise
+constexpr uint64_t DCF_ONE_MIN_US = 150000;        // 100 ms nominal zero, 200 ms nominal one
+constexpr uint64_t DCF_MAX_PULSE_US = 260000;
+constexpr uint64_t DCF_SECOND_MIN_US = 900000;     // Spacing of consecutive second marks
+constexpr uint64_t DCF_SECOND_MAX_US = 1100000;
+constexpr uint64_t DCF_MINUTE_MIN_US = 1800000;    // Spacing across the missing 59th pulse
+constexpr uint64_t DCF_MINUTE_MAX_US = 2200000;
+
+// IRIG-B pulse timing (microseconds)
+constexpr uint64_t IRIG_GLITCH_US = 1000;
+constexpr uint64_t IRIG_ONE_MIN_US = 3500;         // 2 ms nominal zero
+constexpr uint64_t IRIG_MARKER_MIN_US = 6500;      // 5 ms nominal one, 8 ms nominal marker
+constexpr uint64_t IRIG_MAX_PULSE_US = 9500;
+constexpr uint64_t IRIG_PERIOD_MIN_US = 9000;      // 10 ms bit period
+constexpr uint64_t IRIG_PERIOD_MAX_US = 11000;
+constexpr int IRIG_FRAME_BITS = 100;
+constexpr int IRIG_PARITY_BIT = 75;
+
+// Sums BCD-weighted bits "first".."first + count - 1" of "bits" with the given weights
+static int bcdField(uint64_t bits, int first, const int *weights, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        if (bits & (1ULL << (first + i))) value += weights[i];
+    }
+    return value;
+}
+
+static bool evenParity(uint64_t bits, int first, int last) {
+    int ones = 0;
+    for (int i = first; i <= last; i++) {
+        ones += (bits >> i) & 1;
+    }
+    return (ones & 1) == 0;
+}
+
+Dcf77Decoder::Dcf77Decoder(bool activeHigh)
+    : activeHigh(activeHigh), pulseActive(false), pulseStart(0), lastSecondStart(0), haveSecond(false),
+      synced(false), bits(0), bitCount(0), stats() {
+}
+
+bool Dcf77Decoder::onEdge(bool level, uint64_t mono, TimeCodeFix *fix) {
+    if (level == activeHigh) {
+        pulseActive = true;
+        pulseStart = mono;
+        return false;
+    }
+    if (!pulseActive) return false;
+    pulseActive = false;
+
+    uint64_t width = mono - pulseStart;
+    // Short spikes, or pulses starting too soon after the last second mark, are interference
+    if (width < DCF_GLITCH_US || (haveSecond && pulseStart - lastSecondStart < DCF_SECOND_MIN_US)) {
+        stats.glitches++;
+        return false;
+    }
+    if (width > DCF_MAX_PULSE_US) {
+        stats.framingErrors++;
+        synced = false;
+        return false;
+    }
+
+    uint64_t gap = haveSecond ? pulseStart - lastSecondStart : 0;
+    haveSecond = true;
+    lastSecondStart = pulseStart;
+    int bit = width >= DCF_ONE_MIN_US ? 1 : 0;
+    bool decoded = false;
+
+    if (gap >= DCF_MINUTE_MIN_US && gap <= DCF_MINUTE_MAX_US) {
+        // Minute marker: this pulse is second 0 of the minute the collected bits describe
+        if (synced && decode(fix)) {
+            fix->refMono = pulseStart;
+            decoded = true;
+        }
+        synced = true;
+        bits = 0;
+        bitCount = 0;
+    } else if (gap < DCF_SECOND_MIN_US || gap > DCF_SECOND_MAX_US) {
+        if (synced) stats.framingErrors++;
+        synced = false;
+    }
+
+    if (synced) {
+        // Second 60 only exists in a leap-second minute; anything beyond is a lost marker
+        if (bitCount > 59) {
+            stats.framingErrors++;
+            synced = false;
+        } else {
+            bits |= (uint64_t)bit << bitCount;
+            bitCount++;
+        }
+    }
+    return decoded;
+}
+
+bool Dcf77Decoder::decode(TimeCodeFix *fix) {
+    static const int minuteWeights[] = {1, 2, 4, 8, 10, 20, 40};
+    static const int hourWeights[] = {1, 2, 4, 8, 10, 20};
+    static const int dayWeights[] = {1, 2, 4, 8, 10, 20};
+    static const int monthWeights[] = {1, 2, 4, 8, 10};
+    static const int yearWeights[] = {1, 2, 4, 8, 10, 20, 40, 80};
+
+    bool leapAnnounced = (bits >> 19) & 1;
+    if (bitCount != 59 && !(bitCount == 60 && leapAnnounced)) {
+        stats.framingErrors++;
+        return false;
+    }
+    // Bit 0 is always 0 and bit 20 (start of time information) always 1
+    if ((bits & 1) || !((bits >> 20) & 1)) {
+        stats.framingErrors++;
+        return false;
+    }
+    if (!evenParity(bits, 21, 28) || !evenParity(bits, 29, 35) || !evenParity(bits, 36, 58)) {
+        stats.parityErrors++;
+        return false;
+    }
+    bool cest = (bits >> 17) & 1;
+    bool cet = (bits >> 18) & 1;
+    int minute = bcdField(bits, 21, minuteWeights, 7);
+    int hour = bcdField(bits, 29, hourWeights, 6);
+    int day = bcdField(bits, 36, dayWeights, 6);
+    int month = bcdField(bits, 45, monthWeights, 5);
+    int year = 2000 + bcdField(bits, 50, yearWeights, 8);
+    if (cest == cet || minute > 59 || hour > 23 || day < 1 || day > 31 || month < 1 || month > 12) {
+        stats.framingErrors++;
+        return false;
+    }
+    int utcOffset = cest ? 7200 : 3600;
+    fix->epochUs = (civilToEpoch(year, month, day, hour, minute, 0) - utcOffset) * 1000000;
+    // The frame was sent during the minute before the one it describes. For the last frame before a
+    // leap that minute is still in the month the leap ends, while the time it decodes to is not.
+    fix->sentSec = fix->epochUs / 1000000 - 60;
+    fix->leapPending = leapAnnounced;
+    fix->leapDelete = false;
+    stats.frames++;
+    return true;
+}
+
+IrigBDecoder::IrigBDecoder(bool activeHigh, bool ieee1344)
+    : activeHigh(activeHigh), ieee1344(ieee1344), pulseActive(false), pulseStart(0), lastPulseStart(0),
+      lastSymbol(SYMBOL_BAD), inFrame(false), index(0), frameStart(0), bits{0, 0}, stats() {
+}
+
+void IrigBDecoder::loseFrame() {
+    if (inFrame) stats.framingErrors++;
+    inFrame = false;
+}
+
+bool IrigBDecoder::onEdge(bool level, uint64_t mono, TimeCodeFix *fix) {
+    if (level == activeHigh) {
+        pulseActive = true;
+        pulseStart = mono;
+        return false;
+    }
+    if (!pulseActive) return false;
+    pulseActive = false;
+
+    uint64_t width = mono - pulseStart;
+    if (width < IRIG_GLITCH_US) {
+        stats.glitches++;
+        return false;
+    }
+    Symbol symbol = width < IRIG_ONE_MIN_US ? SYMBOL_ZERO
+                  : width < IRIG_MARKER_MIN_US ? SYMBOL_ONE
+                  : width <= IRIG_MAX_PULSE_US ? SYMBOL_MARKER : SYMBOL_BAD;
+    uint64_t period = pulseStart - lastPulseStart;
+    Symbol previous = lastSymbol;
+    lastPulseStart = pulseStart;
+    lastSymbol = symbol;
+    if (symbol == SYMBOL_BAD || period < IRIG_PERIOD_MIN_US || period > IRIG_PERIOD_MAX_US) {
+        loseFrame();
+        lastSymbol = SYMBOL_BAD;
+        return false;
+    }
+
+    // Two consecutive markers: this one is the reference marker Pr, whose leading edge is on time
+    if (previous == SYMBOL_MARKER && symbol == SYMBOL_MARKER) {
+        inFrame = true;
+        index = 0;
+        frameStart = pulseStart;
+        bits[0] = bits[1] = 0;
+        return false;
+    }
+    if (!inFrame) return false;
+
+    index++;
+    bool markerPosition = (index % 10) == 9;
+    if (markerPosition != (symbol == SYMBOL_MARKER)) {
+        loseFrame();
+        return false;
+    }
+    if (symbol == SYMBOL_ONE) {
+        bits[index / 64] |= 1ULL << (index % 64);
+    }
+    if (index < IRIG_FRAME_BITS - 1) return false;
+
+    // Position 99 (P0) closes the frame; the next marker will open the following one
+    inFrame = false;
+    if (!decode(fix)) return false;
+    fix->refMono = frameStart;
+    return true;
+}
+
+bool IrigBDecoder::decode(TimeCodeFix *fix) {
+    static const int unitWeights[] = {1, 2, 4, 8};
+    static const int tensWeights[] = {10, 20, 40, 80};
+    static const int hundredsWeights[] = {100, 200};
+
+    uint64_t low = bits[0];     // Positions 0-63
+    uint64_t high = bits[1];    // Positions 64-99, shifted down by 64
+    if (ieee1344) {
+        // IEEE 1344: position 75 makes the count of ones over data positions 1-74 plus itself even
+        bool even = evenParity(low, 1, 63) == evenParity(high, 0, IRIG_PARITY_BIT - 64);
+        if (!even) {
+            stats.parityErrors++;
+            return false;
+        }
+    }
+    int second = bcdField(low, 1, unitWeights, 4) + bcdField(low, 6, tensWeights, 3);
+    int minute = bcdField(low, 10, unitWeights, 4) + bcdField(low, 15, tensWeights, 3);
+    int hour = bcdField(low, 20, unitWeights, 4) + bcdField(low, 25, tensWeights, 2);
+    int dayOfYear = bcdField(low, 30, unitWeights, 4) + bcdField(low, 35, tensWeights, 4) +
+                    bcdField(low, 40, hundredsWeights, 2);
+    int year = 2000 + bcdField(low, 50, unitWeights, 4) + bcdField(low, 55, tensWeights, 4);
+    if (second > 60 || minute > 59 || hour > 23 || dayOfYear < 1 || dayOfYear > (isLeapYear(year) ? 366 : 365)) {
+        stats.framingErrors++;
+        return false;
+    }
+    // IEEE 1344 time offset (local minus UTC): sign at 64, hours at 65-68, half hour at 70
+    int offsetSeconds = 0;
+    if (ieee1344) {
+        int offsetHours = (int)((high >> 1) & 0xF);
+        offsetSeconds = offsetHours * 3600 + (((high >> 6) & 1) ? 1800 : 0);
+        if (high & 1) offsetSeconds = -offsetSeconds;
+    }
+    int64_t local = daysFromCivil(year, 1, 1) * 86400 + (int64_t)(dayOfYear - 1) * 86400 +
+                    hour * 3600 + minute * 60 + second;
+    fix->epochUs = (local - offsetSeconds) * 1000000;
+    // A frame is sent during the second it describes; second 60 counts as 00 of the next minute above
+    fix->sentSec = local - offsetSeconds - (second == 60 ? 1 : 0);
+    fix->leapPending = (low >> 60) & 1;
+    fix->leapDelete = ieee1344 && ((low >> 61) & 1);
+    stats.frames++;
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef TIMECODE_H
+#define TIMECODE_H
+
+#include <cstdint>
+
+// Decoders for broadcast/wired time codes delivered as a pulse-width modulated level on one input.
+// Both decoders are driven purely by edges (level after the edge plus the hardware capture time),
+// so they never poll the pin and cost a few dozen instructions per edge.
+//
+// DCF77: one carrier reduction per second, 100 ms = 0 and 200 ms = 1, no pulse in second 59.
+//        The bits sent during a minute describe the next minute (CET/CEST), which starts at the
+//        leading edge of the pulse after the gap. Even parity over minute, hour and date.
+// IRIG-B (B00x, DC level shift): 100 pulses per second, 2 ms = 0, 5 ms = 1, 8 ms = position marker.
+//        Two markers in a row mark the on-time edge of the second; the frame carries
+//        second/minute/hour/day-of-year/year in BCD and the IEEE 1344 extension (leap second,
+//        local offset and an even parity bit at position 75).
+
+enum TimeCodeFormat {
+    TIMECODE_DCF77,
+    TIMECODE_IRIGB
+};
+
+// Result of one successfully decoded frame.
+struct TimeCodeFix {
+    int64_t epochUs;        // UTC time of the on-time edge
+    uint64_t refMono;       // Monotonic capture time of that edge
+    int64_t sentSec;        // UTC second the frame was sent in; an announced leap is due at the end of its month
+    bool leapPending;       // The code announces a leap second at the end of the current period
+    bool leapDelete;        // The announced leap second is a deletion (IRIG-B only; DCF77 cannot signal one)
+};
+
+struct TimeCodeCounters {
+    uint32_t frames;        // Frames decoded and accepted
+    uint32_t parityErrors;  // Frames rejected by a parity bit
+    uint32_t framingErrors; // Pulse widths, spacing or markers out of tolerance (decoder resynchronises)
+    uint32_t glitches;      // Pulses too short to be data, ignored
+};
+
+class Dcf77Decoder {
+public:
+    explicit Dcf77Decoder(bool activeHigh = true);
+
+    // Feed one edge: "level" is the pin level after the edge, "mono" its capture time.
+    // Returns true when the edge completed a minute; "fix" then describes the minute that just started.
+    bool onEdge(bool level, uint64_t mono, TimeCodeFix *fix);
+    const TimeCodeCounters &counters() const { return stats; }
+
+private:
+    bool decode(TimeCodeFix *fix);
+
+    bool activeHigh;
+    bool pulseActive;
+    uint64_t pulseStart;
+    uint64_t lastSecondStart;
+    bool haveSecond;
+    bool synced;            // A minute marker has been seen and every second since then was good
+    uint64_t bits;          // Bit n is the value received in second n of the minute
+    int bitCount;
+    TimeCodeCounters stats;
+};
+
+class IrigBDecoder {
+public:
+    // "ieee1344" enables the extension fields: parity check and local time offset.
+    explicit IrigBDecoder(bool activeHigh = true, bool ieee1344 = true);
+
+    bool onEdge(bool level, uint64_t mono, TimeCodeFix *fix);
+    const TimeCodeCounters &counters() const { return stats; }
+
+private:
+    enum Symbol { SYMBOL_ZERO, SYMBOL_ONE, SYMBOL_MARKER, SYMBOL_BAD };
+    bool decode(TimeCodeFix *fix);
+    void loseFrame();
+
+    bool activeHigh;
+    bool ieee1344;
+    bool pulseActive;
+    uint64_t pulseStart;
+    uint64_t lastPulseStart;
+    Symbol lastSymbol;
+    bool inFrame;
+    int index;              // Position of the last symbol stored in the current frame
+    uint64_t frameStart;    // Leading edge of the reference marker
+    uint64_t bits[2];       // Data bits of the frame, bit n = position n
+    TimeCodeCounters stats;
+};
+
+#endif // TIMECODE_H
@@ -0,0 +1,78 @@
+#include "timecode_capture.h"
+#include "wallclock.h"
+#include "spsc_ring.h"
+#include "mbed.h"
+
+constexpr uint32_t EDGE_QUEUE_SIZE = 256;   // IRIG-B produces 200 edges per second
+
+struct CapturedEdge {
+    uint64_t mono;
+    bool level;
+};
+
+static TIM_HandleTypeDef captureTimer;
+static SpscRing<CapturedEdge, EDGE_QUEUE_SIZE> edges;
+static volatile uint32_t overruns = 0;      // Edges the capture register lost (the ring counts its own)
+
+static void captureIrq() {
+    if (!__HAL_TIM_GET_FLAG(&captureTimer, TIM_FLAG_CC1)) return;
+    // Reading CCR1 clears the capture flag
+    uint32_t captured = captureTimer.Instance->CCR1;
+    uint32_t counter = captureTimer.Instance->CNT;
+    uint64_t mono = monotonicMicros() - (uint32_t)(counter - captured);
+    bool level = (GPIOA->IDR & GPIO_PIN_5) != 0;
+    if (__HAL_TIM_GET_FLAG(&captureTimer, TIM_FLAG_CC1OF)) {
+        // A second edge was latched before this one was read; its level is no longer known
+        __HAL_TIM_CLEAR_FLAG(&captureTimer, TIM_FLAG_CC1OF);
+        overruns = overruns + 1;
+    }
+    CapturedEdge edge = {mono, level};
+    edges.push(edge);
+}
+
+void timecodeCaptureStart() {
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    GPIO_InitTypeDef gpio = {0};
+    gpio.Pin = GPIO_PIN_5;
+    gpio.Mode = GPIO_MODE_AF_PP;
+    gpio.Pull = GPIO_NOPULL;
+    gpio.Speed = GPIO_SPEED_FREQ_LOW;
+    gpio.Alternate = GPIO_AF1_TIM2;
+    HAL_GPIO_Init(GPIOA, &gpio);
+
+    // APB1 timers run at twice PCLK1 whenever the APB1 prescaler is not 1 (always the case at 180 MHz)
+    uint32_t timerClock = HAL_RCC_GetPCLK1Freq() * 2;
+    captureTimer.Instance = TIM2;
+    captureTimer.Init.Prescaler = timerClock / 1000000 - 1;
+    captureTimer.Init.CounterMode = TIM_COUNTERMODE_UP;
+    captureTimer.Init.Period = 0xFFFFFFFF;
+    captureTimer.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    HAL_TIM_IC_Init(&captureTimer);
+
+    TIM_IC_InitTypeDef capture = {0};
+    capture.ICPolarity = TIM_INPUTCHANNELPOLARITY_BOTHEDGE;
+    capture.ICSelection = TIM_ICSELECTION_DIRECTTI;
+    capture.ICPrescaler = TIM_ICPSC_DIV1;
+    capture.ICFilter = 0x8;     // Require 6 stable samples at fDTS/8 before an edge is accepted
+    HAL_TIM_IC_ConfigChannel(&captureTimer, &capture, TIM_CHANNEL_1);
+
+    NVIC_SetVector(TIM2_IRQn, (uint32_t)&captureIrq);
+    NVIC_EnableIRQ(TIM2_IRQn);
+    HAL_TIM_IC_Start_IT(&captureTimer, TIM_CHANNEL_1);
+    // TIM2 stops in STOP mode, which would lose edges and break the timestamps
+    sleep_manager_lock_deep_sleep();
+}
+
+bool timecodeCapturePop(bool *level, uint64_t *mono) {
+    CapturedEdge edge;
+    if (!edges.pop(&edge)) return false;
+    *level = edge.level;
+    *mono = edge.mono;
+    return true;
+}
+
+uint32_t timecodeCaptureOverruns() {
+    return overruns + edges.overflows();
+}
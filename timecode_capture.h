@@ -0,0 +1,20 @@
+#ifndef TIMECODE_CAPTURE_H
+#define TIMECODE_CAPTURE_H
+
+#include <cstdint>
+
+// Hardware edge timestamping for the time-code input (PA_5, TIM2 channel 1).
+// TIM2 runs free at 1 MHz and latches its counter on both edges in the capture register,
+// so the timestamp does not depend on interrupt latency. The capture interrupt converts the
+// latched count to the monotonic timebase and queues (level, time) for the main thread.
+
+// Start the timer and the capture interrupt.
+void timecodeCaptureStart();
+
+// Pop the oldest captured edge. Returns false when no edge is waiting.
+bool timecodeCapturePop(bool *level, uint64_t *mono);
+
+// Edges lost because the main thread fell a full queue behind (or the capture register overran).
+uint32_t timecodeCaptureOverruns();
+
+#endif // TIMECODE_CAPTURE_H
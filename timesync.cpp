@@ -0,0 +1,145 @@
+#include "timesync.h"
+
+// CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF), bitwise to keep flash use small
+uint16_t timeSyncCrc16(const uint8_t *data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void putLe(uint8_t *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t getLe(const uint8_t *in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+void timeSyncEncode(const TimeSyncFrame &frame, uint8_t *out) {
+    out[0] = TIMESYNC_SYNC1;
+    out[1] = TIMESYNC_SYNC2;
+    out[2] = TIMESYNC_TYPE_TIME;
+    out[3] = frame.hops;
+    putLe(&out[4], frame.seq, 2);
+    putLe(&out[6], (uint64_t)frame.epochUs, 8);
+    putLe(&out[14], frame.residenceUs, 4);
+    out[18] = frame.leapFlags;
+    putLe(&out[19], timeSyncCrc16(&out[2], 17), 2);
+}
+
+bool timeSyncDecode(const uint8_t *in, TimeSyncFrame *frame) {
+    if (in[0] != TIMESYNC_SYNC1 || in[1] != TIMESYNC_SYNC2 || in[2] != TIMESYNC_TYPE_TIME) return false;
+    if ((uint16_t)getLe(&in[19], 2) != timeSyncCrc16(&in[2], 17)) return false;
+    frame->hops = in[3];
+    frame->seq = (uint16_t)getLe(&in[4], 2);
+    frame->epochUs = (int64_t)getLe(&in[6], 8);
+    frame->residenceUs = (uint32_t)getLe(&in[14], 4);
+    frame->leapFlags = in[18];
+    return true;
+}
+
+uint32_t timeSyncHopLatencyUs(const TimeSyncConfig &config) {
+    uint64_t bits = (uint64_t)TIMESYNC_FRAME_SIZE * TIMESYNC_BITS_PER_BYTE;
+    return (uint32_t)(bits * 1000000 / config.baud) + config.fixedLatencyUs;
+}
+
+TimeSyncParser::TimeSyncParser() : count(0), lastFrame(), lastRxMono(0), crcErrorCount(0) {
+}
+
+bool TimeSyncParser::feed(uint8_t byte, uint64_t mono) {
+    // Hunt for the two sync bytes, then collect the rest of the fixed-size frame
+    if (count == 0 && byte != TIMESYNC_SYNC1) return false;
+    if (count == 1 && byte != TIMESYNC_SYNC2) {
+        count = (byte == TIMESYNC_SYNC1) ? 1 : 0;
+        return false;
+    }
+    buffer[count++] = byte;
+    if (count < TIMESYNC_FRAME_SIZE) return false;
+
+    count = 0;
+    if (!timeSyncDecode(buffer, &lastFrame)) {
+        crcErrorCount++;
+        return false;
+    }
+    lastRxMono = mono;
+    return true;
+}
+
+TimeSyncMaster::TimeSyncMaster(WallClock &clock, SyncTransport &bus, const TimeSyncConfig &config)
+    : clock(clock), bus(bus), config(config), seq(0), nextDue(0), leapFlags(0) {
+}
+
+bool TimeSyncMaster::poll(uint64_t mono) {
+    if (!clock.isSet() || mono < nextDue) return false;
+    broadcast(mono);
+    return true;
+}
+
+void TimeSyncMaster::broadcast(uint64_t mono) {
+    TimeSyncFrame frame;
+    frame.hops = 0;
+    frame.seq = seq++;
+    frame.epochUs = clock.now(mono);
+    frame.residenceUs = 0;
+    frame.leapFlags = leapFlags;
+    uint8_t out[TIMESYNC_FRAME_SIZE];
+    timeSyncEncode(frame, out);
+    bus.send(out, sizeof(out));
+    nextDue = mono + (uint64_t)config.periodMs * 1000;
+}
+
+TimeSyncFollower::TimeSyncFollower(WallClock &clock, const TimeSyncConfig &config, SyncTransport *repeatBus,
+                                   bool disciplineClock)
+    : clock(clock), config(config), repeatBus(repeatBus), disciplineClock(disciplineClock), discipline(clock), parser(),
+      haveSeq(false), lastSeq(0), lastOffset(0), lastReference(0), lastMono(0), applied(0), dropped(0) {
+}
+
+bool TimeSyncFollower::onRxByte(uint8_t byte, uint64_t mono) {
+    if (!parser.feed(byte, mono)) return false;
+
+    const TimeSyncFrame &frame = parser.frame();
+    // Drop duplicates (the same frame heard over two repeater paths) and runaway repeater loops
+    if ((haveSeq && frame.seq == lastSeq) || frame.hops >= TIMESYNC_MAX_HOPS) {
+        dropped++;
+        return false;
+    }
+    haveSeq = true;
+    lastSeq = frame.seq;
+
+    // The master stamped the frame as its first byte left; every hop since then cost one
+    // frame time on the wire plus interrupt latency, and repeaters report how long they held it.
+    uint64_t rxMono = parser.rxMono();
+    int64_t delay = (int64_t)(frame.hops + 1) * timeSyncHopLatencyUs(config) + frame.residenceUs;
+    int64_t reference = frame.epochUs + delay;
+    lastOffset = reference - clock.now(rxMono);
+    lastReference = reference;
+    lastMono = rxMono;
+    if (disciplineClock) {
+        if (!discipline.locked()) discipline.seedFrequency(clock.frequencyPpb());
+        discipline.update(lastOffset, rxMono);
+    }
+    applied++;
+
+    if (repeatBus != nullptr) {
+        TimeSyncFrame forward = frame;
+        forward.hops++;
+        uint8_t out[TIMESYNC_FRAME_SIZE];
+        // Residence is measured right before sending so encoding time is included
+        uint64_t txMono = monotonicMicros();
+        forward.residenceUs += (uint32_t)(txMono > rxMono ? txMono - rxMono : 0);
+        timeSyncEncode(forward, out);
+        repeatBus->send(out, sizeof(out));
+    }
+    return true;
+}
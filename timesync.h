@@ -0,0 +1,146 @@
+#ifndef TIMESYNC_H
+#define TIMESYNC_H
+
+#include <cstdint>
+#include <cstddef>
+#include "wallclock.h"
+#include "clock_discipline.h"
+
+// Time distribution over a shared (RS-485 style) serial bus.
+// One master broadcasts a TIME frame per period; every follower on the bus hears the same
+// frame, so the cost of a broadcast does not depend on how many followers are attached.
+// Followers compensate for the wire time of each hop and slew their WallClock towards the master.
+//
+// Frame layout (little endian, 21 bytes):
+//   [0]      0xD5 sync byte 1
+//   [1]      0x5A sync byte 2
+//   [2]      frame type (TIMESYNC_TYPE_TIME)
+//   [3]      hop count (0 when sent by the master, incremented by each repeater)
+//   [4..5]   sequence number
+//   [6..13]  master wall-clock time in epoch microseconds (leap-free timescale), sampled as the first byte goes out
+//   [14..17] accumulated repeater residence time in microseconds
+//   [18]     leap flags (TIMESYNC_LEAP_*): a leap second is due at the end of the current UTC month
+//   [19..20] CRC-16/CCITT over bytes [2..18]
+constexpr uint8_t TIMESYNC_SYNC1 = 0xD5;
+constexpr uint8_t TIMESYNC_SYNC2 = 0x5A;
+constexpr uint8_t TIMESYNC_TYPE_TIME = 0x01;
+constexpr size_t TIMESYNC_FRAME_SIZE = 21;
+constexpr uint8_t TIMESYNC_LEAP_INSERT = 0x01;
+constexpr uint8_t TIMESYNC_LEAP_DELETE = 0x02;
+constexpr uint8_t TIMESYNC_MAX_HOPS = 8;
+constexpr int TIMESYNC_BITS_PER_BYTE = 10;  // 8N1: start bit, 8 data bits, stop bit
+
+struct TimeSyncFrame {
+    uint8_t hops;
+    uint16_t seq;
+    int64_t epochUs;
+    uint32_t residenceUs;
+    uint8_t leapFlags;
+};
+
+// Byte transport shared by all nodes on one bus segment.
+class SyncTransport {
+public:
+    virtual ~SyncTransport() {}
+    virtual void send(const uint8_t *data, size_t size) = 0;
+};
+
+// Settings describing the bus; every node on a segment must agree on the baud rate.
+struct TimeSyncConfig {
+    uint32_t baud;             // Bus bit rate
+    uint32_t fixedLatencyUs;   // Transmit + receive interrupt latency per hop, calibrated once per board type
+    uint32_t periodMs;         // Master broadcast period
+};
+
+constexpr TimeSyncConfig TIMESYNC_DEFAULT_CONFIG = {115200, 40, 1000};
+
+uint16_t timeSyncCrc16(const uint8_t *data, size_t size);
+void timeSyncEncode(const TimeSyncFrame &frame, uint8_t *out);
+bool timeSyncDecode(const uint8_t *in, TimeSyncFrame *frame);
+
+// Wire delay of one hop: time from the first bit of the frame leaving the sender
+// until the last byte has been received, plus the calibrated interrupt latency.
+uint32_t timeSyncHopLatencyUs(const TimeSyncConfig &config);
+
+// Incremental frame parser fed one byte at a time with its receive timestamp.
+class TimeSyncParser {
+public:
+    TimeSyncParser();
+    // Returns true when "byte" completed a valid frame; the frame and the monotonic
+    // receive time of its last byte are then available through frame() and rxMono().
+    bool feed(uint8_t byte, uint64_t mono);
+    const TimeSyncFrame &frame() const { return lastFrame; }
+    uint64_t rxMono() const { return lastRxMono; }
+    uint32_t crcErrors() const { return crcErrorCount; }
+    void reset() { count = 0; }
+
+private:
+    uint8_t buffer[TIMESYNC_FRAME_SIZE];
+    size_t count;
+    TimeSyncFrame lastFrame;
+    uint64_t lastRxMono;
+    uint32_t crcErrorCount;
+};
+
+// Master node: broadcasts the local WallClock once per period.
+class TimeSyncMaster {
+public:
+    TimeSyncMaster(WallClock &clock, SyncTransport &bus, const TimeSyncConfig &config = TIMESYNC_DEFAULT_CONFIG);
+    // Sends a frame if one is due at monotonic instant "mono". Returns true if a frame was sent.
+    bool poll(uint64_t mono);
+    // Sends a frame immediately (for example right after the time was set by hand).
+    void broadcast(uint64_t mono);
+    uint64_t nextDueMono() const { return nextDue; }
+    // Leap announcement carried by the following frames
+    void setLeapFlags(uint8_t flags) { leapFlags = flags; }
+
+private:
+    WallClock &clock;
+    SyncTransport &bus;
+    TimeSyncConfig config;
+    uint16_t seq;
+    uint64_t nextDue;
+    uint8_t leapFlags;
+};
+
+// Follower node: parses frames from the bus, compensates for per-hop latency and steers its clock
+// with a ClockDiscipline, which slews out each offset and learns the oscillator's frequency error
+// from what builds up between frames. The loop starts from whatever frequency the clock already runs at.
+// If a repeat transport is given the follower also re-broadcasts each frame onto the next segment,
+// adding its own residence time so followers downstream stay accurate. With "disciplineClock" false the
+// follower only measures; the owner passes lastReferenceUs() on to clock selection instead.
+class TimeSyncFollower {
+public:
+    TimeSyncFollower(WallClock &clock, const TimeSyncConfig &config = TIMESYNC_DEFAULT_CONFIG,
+                     SyncTransport *repeatBus = nullptr, bool disciplineClock = true);
+    // Feed one received byte with its monotonic receive timestamp.
+    // Returns true if it completed a frame that was applied to the clock.
+    bool onRxByte(uint8_t byte, uint64_t mono);
+
+    int64_t lastOffsetUs() const { return lastOffset; }      // Reference minus local time of the last frame
+    int64_t lastReferenceUs() const { return lastReference; } // Latency-compensated master time of the last frame
+    uint64_t lastFrameMono() const { return lastMono; }
+    uint8_t lastHops() const { return parser.frame().hops; }
+    uint8_t lastLeapFlags() const { return parser.frame().leapFlags; }
+    int32_t frequencyPpb() const { return discipline.frequencyPpb(); }  // Frequency correction learned so far
+    uint32_t framesApplied() const { return applied; }
+    uint32_t framesDropped() const { return dropped; }
+    uint32_t crcErrors() const { return parser.crcErrors(); }
+
+private:
+    WallClock &clock;
+    TimeSyncConfig config;
+    SyncTransport *repeatBus;
+    bool disciplineClock;
+    ClockDiscipline discipline;
+    TimeSyncParser parser;
+    bool haveSeq;
+    uint16_t lastSeq;
+    int64_t lastOffset;
+    int64_t lastReference;
+    uint64_t lastMono;
+    uint32_t applied;
+    uint32_t dropped;
+};
+
+#endif // TIMESYNC_H
@@ -0,0 +1,43 @@
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <cstdint>
+
+// Ring of the N most recent trace entries, overwriting the oldest when full and counting what it
+// overwrote. Not synchronised: the owner records from one context or holds its own lock. The
+// traces built on it (input_trace.h, i2c_trace.h) add only their text line formats.
+template <typename Entry, int N>
+class TraceRing {
+    static_assert(N >= 1, "TraceRing needs at least one slot");
+
+public:
+    TraceRing() { clear(); }
+
+    void record(const Entry &e) {
+        entries[next] = e;
+        next = (next + 1) % N;
+        if (stored < N) {
+            stored++;
+        } else {
+            lost++;
+        }
+    }
+
+    void clear() {
+        next = 0;
+        stored = 0;
+        lost = 0;
+    }
+
+    int count() const { return stored; }
+    const Entry &entry(int i) const { return entries[(next - stored + i + N) % N]; }   // 0 = oldest kept
+    uint32_t overwritten() const { return lost; }
+
+private:
+    Entry entries[N];
+    int next;
+    int stored;
+    uint32_t lost;
+};
+
+#endif // TRACE_RING_H
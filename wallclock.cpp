@@ -0,0 +1,68 @@
+#include "wallclock.h"
+#include "leap_seconds.h"
+
+WallClock::WallClock()
+    : baseMono(0), baseEpochUs(0), slewUs(0), freqPpb(0), freqCarry(0), set(false), leaps(nullptr) {
+}
+
+// Portion of the pending slew that has been applied "elapsed" microseconds after the base.
+// The slew advances at WALLCLOCK_MAX_SLEW_PPM and stops once the whole correction is in.
+int64_t WallClock::slewApplied(uint64_t elapsed) const {
+    int64_t budget = (int64_t)(elapsed * WALLCLOCK_MAX_SLEW_PPM / 1000000);
+    if (slewUs >= 0) {
+        return slewUs < budget ? slewUs : budget;
+    }
+    return -slewUs < budget ? slewUs : -budget;
+}
+
+int64_t WallClock::now(uint64_t mono) const {
+    // Instants before the base (a timestamp captured just before a rebase) are treated as the base itself
+    uint64_t elapsed = mono > baseMono ? mono - baseMono : 0;
+    int64_t freqAdj = ((int64_t)elapsed * freqPpb + freqCarry) / 1000000000;
+    return baseEpochUs + (int64_t)elapsed + freqAdj + slewApplied(elapsed);
+}
+
+int64_t WallClock::utc(uint64_t mono) const {
+    int64_t t = now(mono);
+    return leaps != nullptr ? leaps->toUtc(t) : t;
+}
+
+void WallClock::rebase(uint64_t mono) {
+    if (mono <= baseMono) return;
+    int64_t current = now(mono);
+    // Keep what now() cut off below 1 us, so a correction under 1 ppm still adds up over many rebases
+    freqCarry = ((int64_t)(mono - baseMono) * freqPpb + freqCarry) % 1000000000;
+    slewUs -= slewApplied(mono - baseMono);
+    baseEpochUs = current;
+    baseMono = mono;
+}
+
+void WallClock::step(int64_t epochUs, uint64_t mono) {
+    baseMono = mono;
+    baseEpochUs = epochUs;
+    slewUs = 0;
+    freqCarry = 0;
+    set = true;
+}
+
+bool WallClock::correct(int64_t offsetUs, uint64_t mono) {
+    if (!set || offsetUs > WALLCLOCK_STEP_THRESHOLD_US || offsetUs < -WALLCLOCK_STEP_THRESHOLD_US) {
+        step(now(mono) + offsetUs, mono);
+        return true;
+    }
+    // Replace (not accumulate) the pending slew: the offset was measured against the
+    // clock as it reads now, which already includes whatever part of the old slew was applied.
+    rebase(mono);
+    slewUs = offsetUs;
+    return false;
+}
+
+void WallClock::setFrequencyPpb(int32_t ppb, uint64_t mono) {
+    rebase(mono);
+    freqPpb = ppb;
+}
+
+int64_t WallClock::pendingSlewUs(uint64_t mono) const {
+    uint64_t elapsed = mono > baseMono ? mono - baseMono : 0;
+    return slewUs - slewApplied(elapsed);
+}
@@ -0,0 +1,66 @@
+#ifndef WALLCLOCK_H
+#define WALLCLOCK_H
+
+#include <cstdint>
+
+// Monotonic microsecond counter supplied by the platform layer.
+// It never steps or slews, so it is the timebase every timestamp in the firmware is taken against.
+uint64_t monotonicMicros();
+
+constexpr int64_t USEC_PER_SEC = 1000000;
+constexpr int64_t WALLCLOCK_STEP_THRESHOLD_US = 128000; // Corrections larger than this are stepped instead of slewed
+constexpr int32_t WALLCLOCK_MAX_SLEW_PPM = 500;         // Maximum rate at which a pending correction is applied
+
+class LeapTable;
+
+// Software wall clock layered on top of the monotonic counter.
+// Time is kept as microseconds since the Unix epoch on a leap-free timescale; utc() converts
+// it to the civil time shown and stored, smearing leap seconds (see leap_seconds.h). Small corrections are slewed
+// (spread out at no more than WALLCLOCK_MAX_SLEW_PPM) so the displayed seconds never
+// jump or repeat; large corrections are stepped immediately.
+class WallClock {
+public:
+    WallClock();
+
+    // Wall-clock time (epoch microseconds) at the given monotonic instant.
+    int64_t now(uint64_t mono) const;
+    int64_t now() const { return now(monotonicMicros()); }
+
+    // Civil UTC (epoch microseconds) at the given monotonic instant, with leap seconds applied by the
+    // attached table. Without a table this is the same as now().
+    int64_t utc(uint64_t mono) const;
+    int64_t utc() const { return utc(monotonicMicros()); }
+    void setLeapTable(const LeapTable *table) { leaps = table; }
+
+    // Jump directly to "epochUs" at monotonic instant "mono" and drop any pending slew.
+    void step(int64_t epochUs, uint64_t mono);
+
+    // Apply an offset correction measured at "mono" (reference time minus local time).
+    // Returns true if the correction was stepped, false if it was queued for slewing.
+    bool correct(int64_t offsetUs, uint64_t mono);
+
+    // Set the frequency correction in parts per billion (positive makes the clock run faster).
+    void setFrequencyPpb(int32_t ppb, uint64_t mono);
+    int32_t frequencyPpb() const { return freqPpb; }
+
+    // Correction still waiting to be slewed in, as of monotonic instant "mono".
+    int64_t pendingSlewUs(uint64_t mono) const;
+
+    // Fold elapsed time into the base so the arithmetic in now() stays small; call at least once per hour.
+    void rebase(uint64_t mono);
+
+    bool isSet() const { return set; }
+
+private:
+    int64_t slewApplied(uint64_t elapsed) const;
+
+    uint64_t baseMono;      // Monotonic instant the base epoch refers to
+    int64_t baseEpochUs;    // Wall-clock time at baseMono
+    int64_t slewUs;         // Correction to spread out from baseMono onwards (signed)
+    int32_t freqPpb;        // Frequency correction applied on top of the monotonic rate
+    int64_t freqCarry;      // Part of the frequency correction below 1 us, carried across rebases (us x ppb)
+    bool set;               // True once the clock has been given a time
+    const LeapTable *leaps;
+};
+
+#endif // WALLCLOCK_H